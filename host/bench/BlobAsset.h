@@ -0,0 +1,34 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Binary eye assets (../src/EyeBlob) on the host: packing the eyes built into
+// the benchmarks into them and rendering them straight from the file.
+#ifndef _BLOB_ASSET_H_
+#define _BLOB_ASSET_H_
+
+#include "EyeAsset.h"
+
+
+// Writes the tables of pAsset to pFilename as an EyeBlob, with the eyelids of
+// pSymmetrical as its SYMMETRICAL_EYELID ones if they differ.  pSymmetrical
+// can be NULL.
+bool      writeEyeBlob(const char* pFilename, const EyeAsset* pAsset, const EyeAsset* pSymmetrical);
+
+// mmap()s the EyeBlob in pFilename and returns the assets which render it
+// through ../src/EyeBlob/eyeBlobTables.h, without and then with
+// SYMMETRICAL_EYELID.  They have no count().  Returns NULL if the file isn't
+// a valid EyeBlob.
+EyeAsset* openEyeBlob(const char* pFilename);
+
+#endif // _BLOB_ASSET_H_
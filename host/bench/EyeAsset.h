@@ -0,0 +1,111 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// One eye's graphics tables with the firmware's rendering kernel compiled
+// against them.  eyeAsset.cpp is built once per eye and eyelid variant and
+// each build registers itself here at startup.
+#ifndef _EYE_ASSET_H_
+#define _EYE_ASSET_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define EYE_FRAME_WIDTH  128
+#define EYE_FRAME_HEIGHT 128
+#define EYE_FRAME_PIXELS (EYE_FRAME_WIDTH * EYE_FRAME_HEIGHT)
+
+// The graphics tables which drawEye() reads from flash.  FLASH_PALETTE is
+// scleraPalette followed by irisPalette, for eyes from assetCompiler -p, and
+// is empty for the rest.  EyeBlobs only hold the tables before it.
+enum FlashTable {
+  FLASH_SCLERA,
+  FLASH_IRIS,
+  FLASH_POLAR,
+  FLASH_UPPER,
+  FLASH_LOWER,
+  FLASH_PALETTE,
+  FLASH_TABLE_COUNT
+};
+
+// Size of the LPC1768 flash accelerator's line buffers.
+#define FLASH_LINE_SIZE 16
+
+// What drawEye() did to render some number of frames.  Every pixel takes
+// exactly one of the four paths through the kernel.
+struct RenderCounts {
+  uint64_t frames;
+  uint64_t rows;
+  uint64_t pixels;
+  uint64_t flashLoads[FLASH_TABLE_COUNT];
+  // Loads which touched a different flash line than the previous table load.
+  uint64_t flashLineFills[FLASH_TABLE_COUNT];
+  uint64_t eyelidPixels;    // Covered by an eyelid
+  uint64_t scleraPixels;    // Outside of the polar table
+  uint64_t irisPixels;      // Within the scaled iris
+  uint64_t irisEdgePixels;  // Within the polar table but outside of the scaled iris
+  uint64_t multiplies;
+  uint64_t divides;
+  uint64_t spiBytes;        // Including setAddrWindow()
+  uint64_t spiTransactions; // Chip select cycles, each one flushed before the next
+};
+
+struct EyeAsset {
+  const char* pName;
+  bool        symmetrical;  // Built with SYMMETRICAL_EYELID
+  uint8_t     scleraXMax;   // Largest scleraX/scleraY which keep the screen
+  uint8_t     scleraYMax;   // within the sclera image
+  uint16_t    irisMin;      // IRIS_MIN/IRIS_MAX for this eye
+  uint16_t    irisMax;
+  // Dimensions of each FlashTable.
+  uint16_t    tableWidth[FLASH_TABLE_COUNT];
+  uint16_t    tableHeight[FLASH_TABLE_COUNT];
+  // The tables themselves, rows packed, for packing into an EyeBlob.  NULL
+  // for FLASH_PALETTE.
+  const void* pTables[FLASH_TABLE_COUNT];
+  // Renders a frame into pFrame (EYE_FRAME_PIXELS long) just as drawEye()
+  // would send it to the display.
+  void        (*render)(uint16_t* pFrame, uint16_t iScale, uint8_t scleraX, uint8_t scleraY,
+                        uint8_t uT, uint8_t lT);
+  // Adds what rendering the same frame costs to *pCounts.  If ppHeatmaps
+  // isn't NULL, the entry for each load is also incremented in
+  // ppHeatmaps[table] (tableWidth * tableHeight long) for any table which has
+  // one.
+  void        (*count)(RenderCounts* pCounts, uint32_t** ppHeatmaps,
+                       uint16_t iScale, uint8_t scleraX, uint8_t scleraY, uint8_t uT, uint8_t lT);
+  EyeAsset*   pNext;
+};
+
+void      registerEyeAsset(EyeAsset* pAsset);
+// Registered eyes sorted by name, non-symmetrical first.
+EyeAsset* eyeAssets();
+
+
+// Eye positions (corners, edges and center of the sclera), iris scales
+// (IRIS_MIN, middle, IRIS_MAX) and eyelid thresholds (open, tracking, half
+// and fully closed) which exercise every path through the kernel.
+#define EYE_SWEEP_FRAMES (3 * 3 * 3 * 4)
+
+struct EyePose {
+  uint16_t iScale;
+  uint8_t  scleraX;
+  uint8_t  scleraY;
+  uint8_t  upper;
+  uint8_t  lower;
+};
+
+// Fills pPoses (EYE_SWEEP_FRAMES long) with the sweep for this eye.
+void      eyeSweep(const EyeAsset* pAsset, EyePose* pPoses);
+
+#endif // _EYE_ASSET_H_
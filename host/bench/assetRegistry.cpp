@@ -0,0 +1,80 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The list of eyes which the eyeAsset.cpp builds register themselves with and
+// the sweep of poses the host benchmarks render them over.
+#include "EyeAsset.h"
+#include <string.h>
+
+
+static EyeAsset* g_pAssets;
+
+void registerEyeAsset(EyeAsset* pAsset)
+{
+  EyeAsset** ppCurr = &g_pAssets;
+
+  while (*ppCurr) {
+    int order = strcmp(pAsset->pName, (*ppCurr)->pName);
+    if (order < 0 || (order == 0 && !pAsset->symmetrical)) {
+      break;
+    }
+    ppCurr = &(*ppCurr)->pNext;
+  }
+  pAsset->pNext = *ppCurr;
+  *ppCurr = pAsset;
+}
+
+EyeAsset* eyeAssets()
+{
+  return g_pAssets;
+}
+
+
+struct Eyelids {
+  uint8_t upper;
+  uint8_t lower;
+};
+
+// Fully open, tracking at the middle of its range (frame() uses 254 - upper
+// for the lower lid), half way through a blink and fully closed.
+static const Eyelids g_eyelids[] = {
+  {   0,   0 },
+  { 128, 126 },
+  { 191, 190 },
+  { 254, 254 }
+};
+
+void eyeSweep(const EyeAsset* pAsset, EyePose* pPoses)
+{
+  uint16_t iScales[] = { pAsset->irisMin,
+                         (uint16_t)((pAsset->irisMin + pAsset->irisMax) / 2),
+                         pAsset->irisMax };
+
+  for (int y = 0 ; y <= 2 ; y++) {
+    uint8_t scleraY = pAsset->scleraYMax * y / 2;
+    for (int x = 0 ; x <= 2 ; x++) {
+      uint8_t scleraX = pAsset->scleraXMax * x / 2;
+      for (size_t i = 0 ; i < sizeof(iScales) / sizeof(iScales[0]) ; i++) {
+        for (size_t l = 0 ; l < sizeof(g_eyelids) / sizeof(g_eyelids[0]) ; l++) {
+          pPoses->iScale = iScales[i];
+          pPoses->scleraX = scleraX;
+          pPoses->scleraY = scleraY;
+          pPoses->upper = g_eyelids[l].upper;
+          pPoses->lower = g_eyelids[l].lower;
+          pPoses++;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,181 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// The kernel is built here against eyeBlobTables.h, just as main.cpp is when
+// config.h sets EYE_BLOB_FILE, except that g_eyeBlob is opened at runtime.
+#include "BlobAsset.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <EyeBlob.h>
+
+
+// The blob eyeBlobTables.h renders from, swapped in from g_blobs[] by
+// whichever asset is rendering.
+static EyeBlob g_eyeBlob;
+static EyeBlob g_blobs[2];
+
+#include <eyeBlobTables.h>
+#include <eyeRender.h>
+
+
+static void putU16(uint8_t* pBuffer, uint16_t value)
+{
+  pBuffer[0] = value;
+  pBuffer[1] = value >> 8;
+}
+
+static void putU32(uint8_t* pBuffer, uint32_t value)
+{
+  putU16(pBuffer, value);
+  putU16(pBuffer + 2, value >> 16);
+}
+
+static void addSection(std::vector<uint8_t>* pBlob, EyeBlobSection section, const void* pTable,
+                       uint16_t width, uint16_t height, uint8_t entrySize)
+{
+  uint32_t offset = (pBlob->size() + EYE_BLOB_ALIGNMENT - 1) / EYE_BLOB_ALIGNMENT * EYE_BLOB_ALIGNMENT;
+  uint32_t size = width * height * entrySize;
+  uint8_t* pSection = pBlob->data() + 32 + section * 12;
+
+  putU32(pSection, offset);
+  putU16(pSection + 4, width);
+  putU16(pSection + 6, height);
+  pSection[8] = entrySize;
+
+  pBlob->resize(offset + size);
+  memcpy(pBlob->data() + offset, pTable, size);
+}
+
+bool writeEyeBlob(const char* pFilename, const EyeAsset* pAsset, const EyeAsset* pSymmetrical)
+{
+  static const uint8_t entrySize[FLASH_PALETTE] = { 2, 2, 2, 1, 1 };
+  std::vector<uint8_t> blob(EYE_BLOB_HEADER_SIZE);
+
+  if (pAsset->tableWidth[FLASH_PALETTE]) {
+    fprintf(stderr, "%s has a palette, which eye blobs can't hold.\n", pAsset->pName);
+    return false;
+  }
+
+  memcpy(blob.data(), "EYEB", 4);
+  putU16(&blob[4], EYE_BLOB_VERSION);
+  putU16(&blob[6], EYE_BLOB_HEADER_SIZE);
+  strncpy((char*)&blob[8], pAsset->pName, EYE_BLOB_NAME_SIZE);
+  putU16(&blob[24], pAsset->irisMin);
+  putU16(&blob[26], pAsset->irisMax);
+  putU16(&blob[28], EYE_BLOB_SECTION_COUNT);
+
+  // FlashTable and EyeBlobSection have the same order up to FLASH_PALETTE.
+  for (int i = 0 ; i < FLASH_PALETTE ; i++) {
+    addSection(&blob, (EyeBlobSection)i, pAsset->pTables[i],
+               pAsset->tableWidth[i], pAsset->tableHeight[i], entrySize[i]);
+  }
+  uint32_t eyelidSize = pAsset->tableWidth[FLASH_UPPER] * pAsset->tableHeight[FLASH_UPPER];
+  if (pSymmetrical &&
+      (memcmp(pSymmetrical->pTables[FLASH_UPPER], pAsset->pTables[FLASH_UPPER], eyelidSize) != 0 ||
+       memcmp(pSymmetrical->pTables[FLASH_LOWER], pAsset->pTables[FLASH_LOWER], eyelidSize) != 0)) {
+    addSection(&blob, EYE_BLOB_SYMMETRICAL_UPPER, pSymmetrical->pTables[FLASH_UPPER],
+               pSymmetrical->tableWidth[FLASH_UPPER], pSymmetrical->tableHeight[FLASH_UPPER], 1);
+    addSection(&blob, EYE_BLOB_SYMMETRICAL_LOWER, pSymmetrical->pTables[FLASH_LOWER],
+               pSymmetrical->tableWidth[FLASH_LOWER], pSymmetrical->tableHeight[FLASH_LOWER], 1);
+  }
+
+  FILE* pFile = fopen(pFilename, "wb");
+  if (!pFile) {
+    perror(pFilename);
+    return false;
+  }
+  bool ok = fwrite(blob.data(), blob.size(), 1, pFile) == 1;
+  ok = fclose(pFile) == 0 && ok;
+  if (!ok) {
+    fprintf(stderr, "Failed to write %s.\n", pFilename);
+  }
+  return ok;
+}
+
+
+namespace
+{
+  class FrameSink
+  {
+    public:
+      FrameSink(uint16_t* pFrame) : m_pCurr(pFrame) {}
+
+      void pushColor(uint16_t color) { *m_pCurr++ = color; }
+
+    protected:
+      uint16_t* m_pCurr;
+  };
+
+  template<int SYMMETRICAL>
+  void render(uint16_t* pFrame, uint16_t iScale, uint8_t scleraX, uint8_t scleraY, uint8_t uT, uint8_t lT)
+  {
+    FrameSink sink(pFrame);
+    g_eyeBlob = g_blobs[SYMMETRICAL];
+    renderEye(&sink, iScale, scleraX, scleraY, uT, lT);
+  }
+
+  EyeAsset g_assets[2];
+}
+
+EyeAsset* openEyeBlob(const char* pFilename)
+{
+  int fd = open(pFilename, O_RDONLY);
+  if (fd < 0) {
+    perror(pFilename);
+    return NULL;
+  }
+
+  struct stat info;
+  void*       pBlob = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    pBlob = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (pBlob == MAP_FAILED) {
+    perror(pFilename);
+    return NULL;
+  }
+
+  for (int symmetrical = 0 ; symmetrical < 2 ; symmetrical++) {
+    EyeBlob*  pEyeBlob = &g_blobs[symmetrical];
+    EyeAsset* pAsset = &g_assets[symmetrical];
+
+    if (!pEyeBlob->open(pBlob, info.st_size, symmetrical)) {
+      fprintf(stderr, "%s isn't a version %d eye blob.\n", pFilename, EYE_BLOB_VERSION);
+      munmap(pBlob, info.st_size);
+      return NULL;
+    }
+    memset(pAsset, 0, sizeof(*pAsset));
+    pAsset->pName = pEyeBlob->name();
+    pAsset->symmetrical = symmetrical;
+    pAsset->scleraXMax = pEyeBlob->width(EYE_BLOB_SCLERA) - pEyeBlob->width(EYE_BLOB_UPPER);
+    pAsset->scleraYMax = pEyeBlob->height(EYE_BLOB_SCLERA) - pEyeBlob->height(EYE_BLOB_UPPER);
+    pAsset->irisMin = pEyeBlob->irisMin();
+    pAsset->irisMax = pEyeBlob->irisMax();
+    for (int i = 0 ; i < FLASH_PALETTE ; i++) {
+      pAsset->tableWidth[i] = pEyeBlob->width((EyeBlobSection)i);
+      pAsset->tableHeight[i] = pEyeBlob->height((EyeBlobSection)i);
+      pAsset->pTables[i] = pEyeBlob->table((EyeBlobSection)i);
+    }
+    pAsset->render = symmetrical ? render<1> : render<0>;
+  }
+  g_assets[0].pNext = &g_assets[1];
+
+  return g_assets;
+}
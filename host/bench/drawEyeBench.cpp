@@ -0,0 +1,234 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Benchmark and golden frame check of the drawEye() rendering kernel for every
+// eye in ../src/graphics, with and without SYMMETRICAL_EYELID.  The byte
+// swapped and paletted eyes which the Makefile builds from them have to match
+// the golden CRCs of the eyes they came from, which keeps the
+// pushWireColors() and palette paths of the kernel covered too.
+//
+// Each eye is rendered over the sweep of poses from eyeSweep().  The CRC-32
+// of all the frames in the sweep is compared against drawEyeGolden.h so that
+// kernel optimizations can be shown to be bit exact as well as faster.  Only
+// the kernel is timed, not the CRC or the display transfer.
+//
+// Alternatively the frames recorded in a trace file by the firmware's
+// TRACE_RECORD (or host traceRecord) can be rendered instead of the sweep.
+// There are no golden CRCs for those but the printed CRC can be compared
+// between builds.
+//
+// An eye packed by eyePack can also be rendered from its file, through the
+// same EyeBlob tables as the firmware built with EYE_BLOB_FILE, instead of
+// the eyes built into the benchmark.  Its CRCs are checked against the golden
+// ones for the eye of the same name.
+//
+// Usage: drawEyeBench [-r repeats] [-g] [-t traceFile] [-b blobFile] [eyeName]
+//   -r repeats    Number of times to render the sweep for timing (default 10).
+//   -g            Print a new drawEyeGolden.h to stdout instead of checking.
+//   -t traceFile  Render the frames from this trace instead of the sweep.
+//   -b blobFile   Render the eye in this EyeBlob file.
+//   eyeName       Only run eyes whose name contains this string.
+//
+// Exits with a non-zero status if any CRC doesn't match its golden value.
+#include "BlobAsset.h"
+#include <EyeTrace.h>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+
+struct GoldenCrc {
+  const char* pName;
+  bool        symmetrical;
+  uint32_t    crc;
+};
+
+#include "drawEyeGolden.h"
+
+
+static uint32_t crc32(uint32_t crc, const uint16_t* pFrame)
+{
+  crc = ~crc;
+  for (uint32_t i = 0 ; i < EYE_FRAME_PIXELS ; i++) {
+    for (int shift = 0 ; shift < 16 ; shift += 8) {
+      crc ^= (pFrame[i] >> shift) & 0xFF;
+      for (int bit = 0 ; bit < 8 ; bit++) {
+        crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+      }
+    }
+  }
+  return ~crc;
+}
+
+// Poses read from the -t trace file.  Empty to use the sweep.
+static std::vector<EyePose> g_tracePoses;
+
+static bool loadTrace(const char* pFilename)
+{
+  EyeTraceReader reader;
+  EyeTraceRecord record;
+
+  if (!reader.open(pFilename)) {
+    fprintf(stderr, "%s isn't a trace file.\n", pFilename);
+    return false;
+  }
+  while (reader.read(&record)) {
+    EyePose pose = { record.iScale, record.scleraX, record.scleraY, record.uT, record.lT };
+    g_tracePoses.push_back(pose);
+  }
+  if (g_tracePoses.empty()) {
+    fprintf(stderr, "%s contains no frames.\n", pFilename);
+    return false;
+  }
+  return true;
+}
+
+// Renders the whole sweep (or trace) once, returning the time taken by the
+// kernel in nanoseconds.  Updates *pCrc if not NULL.
+static uint64_t renderSweep(const EyeAsset* pAsset, uint32_t* pFrames, uint32_t* pCrc)
+{
+  static uint16_t      frame[EYE_FRAME_PIXELS];
+  std::vector<EyePose> poses(g_tracePoses);
+  uint64_t             elapsed = 0;
+
+  if (poses.empty()) {
+    poses.resize(EYE_SWEEP_FRAMES);
+    eyeSweep(pAsset, poses.data());
+  }
+  for (size_t i = 0 ; i < poses.size() ; i++) {
+    EyePose* pPose = &poses[i];
+
+    // Traces recorded with another eye can be out of range for this one.
+    if (pPose->scleraX > pAsset->scleraXMax) {
+      pPose->scleraX = pAsset->scleraXMax;
+    }
+    if (pPose->scleraY > pAsset->scleraYMax) {
+      pPose->scleraY = pAsset->scleraYMax;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    pAsset->render(frame, pPose->iScale, pPose->scleraX, pPose->scleraY, pPose->upper, pPose->lower);
+    auto end = std::chrono::steady_clock::now();
+
+    elapsed += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    (*pFrames)++;
+    if (pCrc) {
+      *pCrc = crc32(*pCrc, frame);
+    }
+  }
+  return elapsed;
+}
+
+static const GoldenCrc* findGolden(const EyeAsset* pAsset)
+{
+  for (size_t i = 0 ; i < sizeof(g_golden) / sizeof(g_golden[0]) ; i++) {
+    if (strcmp(g_golden[i].pName, pAsset->pName) == 0 && g_golden[i].symmetrical == pAsset->symmetrical) {
+      return &g_golden[i];
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t    repeats = 10;
+  bool        generate = false;
+  const char* pFilter = NULL;
+  EyeAsset*   pAssets = eyeAssets();
+
+  for (int i = 1 ; i < argc ; i++) {
+    if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      repeats = strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-g") == 0) {
+      generate = true;
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      if (!loadTrace(argv[++i])) {
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      pAssets = openEyeBlob(argv[++i]);
+      if (!pAssets) {
+        return 1;
+      }
+    } else if (argv[i][0] != '-' && !pFilter) {
+      pFilter = argv[i];
+    } else {
+      repeats = 0;
+      break;
+    }
+  }
+  if (repeats == 0) {
+    fprintf(stderr, "Usage: drawEyeBench [-r repeats] [-g] [-t traceFile] [-b blobFile] [eyeName]\n");
+    return 1;
+  }
+
+  if (generate && !g_tracePoses.empty()) {
+    fprintf(stderr, "Golden CRCs are only for the sweep.\n");
+    return 1;
+  }
+  if (generate) {
+    printf("// Generated by \"drawEyeBench -g\".  CRC-32 of the frames rendered by the\n"
+           "// sweep in drawEyeBench.cpp for each eye.\n"
+           "static const GoldenCrc g_golden[] = {\n");
+    for (EyeAsset* pAsset = pAssets ; pAsset ; pAsset = pAsset->pNext) {
+      uint32_t frames = 0;
+      uint32_t crc = 0;
+      renderSweep(pAsset, &frames, &crc);
+      printf("  { %-16s %-6s 0x%08X },\n",
+             (std::string("\"") + pAsset->pName + "\",").c_str(),
+             pAsset->symmetrical ? "true," : "false,", crc);
+    }
+    printf("};\n");
+    return 0;
+  }
+
+  uint32_t failures = 0;
+  printf("%-14s %-5s %8s %9s %8s  %-8s\n", "eye", "sym", "frames", "ns/pixel", "frames/s", "crc");
+  for (EyeAsset* pAsset = pAssets ; pAsset ; pAsset = pAsset->pNext) {
+    if (pFilter && !strstr(pAsset->pName, pFilter)) {
+      continue;
+    }
+
+    uint32_t frames = 0;
+    uint32_t crc = 0;
+    renderSweep(pAsset, &frames, &crc);
+
+    frames = 0;
+    uint64_t elapsed = 0;
+    for (uint32_t i = 0 ; i < repeats ; i++) {
+      elapsed += renderSweep(pAsset, &frames, NULL);
+    }
+
+    const GoldenCrc* pGolden = findGolden(pAsset);
+    const char*      pResult = "ok";
+    if (!g_tracePoses.empty()) {
+      pResult = "";
+    } else if (!pGolden) {
+      pResult = "NO GOLDEN";
+      failures++;
+    } else if (pGolden->crc != crc) {
+      pResult = "MISMATCH";
+      failures++;
+    }
+    printf("%-14s %-5s %8u %9.2f %8.0f  %08X %s\n",
+           pAsset->pName, pAsset->symmetrical ? "yes" : "no", frames,
+           (double)elapsed / ((uint64_t)frames * EYE_FRAME_PIXELS),
+           frames * 1e9 / elapsed, crc, pResult);
+  }
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,26 @@
+// Generated by "drawEyeBench -g".  CRC-32 of the frames rendered by the
+// sweep in drawEyeBench.cpp for each eye.
+static const GoldenCrc g_golden[] = {
+  { "catEye",        false, 0x2970D0FF },
+  { "catEye",        true,  0x6495DC60 },
+  { "catPaletteEye", false, 0x2970D0FF },
+  { "defaultEye",    false, 0x92022A5D },
+  { "defaultEye",    true,  0x188016BA },
+  { "defaultWireEye", false, 0x92022A5D },
+  { "doeEye",        false, 0x0C05BD45 },
+  { "doeEye",        true,  0x0C05BD45 },
+  { "dragonEye",     false, 0xE9882E2E },
+  { "dragonEye",     true,  0x5675150F },
+  { "goatEye",       false, 0x2C47C3E1 },
+  { "goatEye",       true,  0x6E37F32D },
+  { "naugaEye",      false, 0xEF58D3CC },
+  { "naugaEye",      true,  0xEF58D3CC },
+  { "newtEye",       false, 0x12E37380 },
+  { "newtEye",       true,  0x394E459E },
+  { "noScleraEye",   false, 0xA33DA424 },
+  { "noScleraEye",   true,  0x02F33D1B },
+  { "owlEye",        false, 0xFE6C1996 },
+  { "owlEye",        true,  0xFE6C1996 },
+  { "terminatorEye", false, 0x0381AFDB },
+  { "terminatorEye", true,  0x0381AFDB },
+};
@@ -0,0 +1,247 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Built once per eye by the Makefile with EYE_NAME set to the name of one of
+// the ../src/graphics/*Eye.h headers and optionally SYMMETRICAL_EYELID.
+//
+// The kernel is compiled twice: once against the real tables for rendering
+// and once, in the counted namespace, against wrappers which count every
+// table load for the LPC1768 cost model in renderCost.cpp.
+//
+// EYE_NAME can also be one of the byte swapped or paletted eyes which the
+// Makefile has assetCompiler build from the eyes in ../src/graphics.
+#include "EyeAsset.h"
+#include <string.h>
+
+#define STRINGIFY(X)  STRINGIFY2(X)
+#define STRINGIFY2(X) #X
+
+#include STRINGIFY(graphics/EYE_NAME.h)
+#include <eyeRender.h>
+
+// Same defaults as config.h.
+#if !defined(IRIS_MIN)
+  #define IRIS_MIN      120
+#endif
+#if !defined(IRIS_MAX)
+  #define IRIS_MAX      720
+#endif
+
+// Entries in the palettes of eyes from assetCompiler -p.
+#ifdef SCLERA_PALETTE_SIZE
+  #define SCLERA_PALETTE_ENTRIES SCLERA_PALETTE_SIZE
+#else
+  #define SCLERA_PALETTE_ENTRIES 0
+#endif
+#ifdef IRIS_PALETTE_SIZE
+  #define IRIS_PALETTE_ENTRIES   IRIS_PALETTE_SIZE
+#else
+  #define IRIS_PALETTE_ENTRIES   0
+#endif
+
+#ifdef SYMMETRICAL_EYELID
+  #define EYE_SYMMETRICAL true
+#else
+  #define EYE_SYMMETRICAL false
+#endif
+
+
+namespace counted
+{
+  static RenderCounts* g_pCounts;
+  static uint32_t**    g_ppHeatmaps;
+  static uintptr_t     g_lastLine;
+
+  // One row of a table.  Indexing it loads the entry and counts the load.
+  template<typename T, FlashTable TABLE>
+  class CountedRow
+  {
+    public:
+      CountedRow(const T* pRow, size_t offset) : m_pRow(pRow), m_offset(offset) {}
+
+      T operator[](int index) const
+      {
+        const T*  pEntry = &m_pRow[index];
+        uintptr_t line = (uintptr_t)pEntry / FLASH_LINE_SIZE;
+
+        if (g_ppHeatmaps && g_ppHeatmaps[TABLE]) {
+          g_ppHeatmaps[TABLE][m_offset + index]++;
+        }
+        g_pCounts->flashLoads[TABLE]++;
+        if (line != g_lastLine) {
+          g_pCounts->flashLineFills[TABLE]++;
+          g_lastLine = line;
+        }
+        return *pEntry;
+      }
+
+    protected:
+      const T* m_pRow;
+      size_t   m_offset;
+  };
+
+  template<typename T, size_t WIDTH, FlashTable TABLE>
+  class CountedTable
+  {
+    public:
+      CountedTable(const T (*pTable)[WIDTH]) : m_pTable(pTable) {}
+
+      CountedRow<T, TABLE> operator[](int index) const
+      {
+        return CountedRow<T, TABLE>(m_pTable[index], index * WIDTH);
+      }
+
+    protected:
+      const T (*m_pTable)[WIDTH];
+  };
+
+  template<FlashTable TABLE, typename T, size_t HEIGHT, size_t WIDTH>
+  CountedTable<T, WIDTH, TABLE> countedTable(const T (&table)[HEIGHT][WIDTH])
+  {
+    return CountedTable<T, WIDTH, TABLE>(table);
+  }
+
+  // Counts what the kernel sends, each pushColor() and pushWireColors() being
+  // one SPI transaction as it is on the SSD1351.
+  class SpiCount
+  {
+    public:
+      SpiCount() : m_pixels(0), m_transactions(0) {}
+
+      void     pushColor(uint16_t color) { m_pixels++; m_transactions++; }
+      void     pushWireColors(const uint16_t colors[], uint32_t count) { m_pixels += count; m_transactions++; }
+      uint32_t pixels() const { return m_pixels; }
+      uint32_t bytes() const { return m_pixels * 2; }
+      uint32_t transactions() const { return m_transactions; }
+
+    protected:
+      uint32_t m_pixels;
+      uint32_t m_transactions;
+  };
+
+  // These hide the real tables from the second copy of the kernel below.
+  const auto sclera = countedTable<FLASH_SCLERA>(::sclera);
+  const auto iris   = countedTable<FLASH_IRIS>(::iris);
+  const auto polar  = countedTable<FLASH_POLAR>(::polar);
+  const auto upper  = countedTable<FLASH_UPPER>(::upper);
+  const auto lower  = countedTable<FLASH_LOWER>(::lower);
+#ifdef SCLERA_PALETTE_SIZE
+  const CountedRow<uint16_t, FLASH_PALETTE> scleraPalette(::scleraPalette, 0);
+#endif
+#ifdef IRIS_PALETTE_SIZE
+  const CountedRow<uint16_t, FLASH_PALETTE> irisPalette(::irisPalette, SCLERA_PALETTE_ENTRIES);
+#endif
+
+  #undef _EYE_RENDER_H_
+  #include <eyeRender.h>
+}
+
+
+namespace
+{
+  // Collects the pixels in the order the display receives them, with those
+  // sent in wire order swapped back to RGB565 values.
+  class FrameSink
+  {
+    public:
+      FrameSink(uint16_t* pFrame) : m_pCurr(pFrame) {}
+
+      void pushColor(uint16_t color) { *m_pCurr++ = color; }
+      void pushWireColors(const uint16_t colors[], uint32_t count)
+      {
+        while (count--) {
+          uint16_t color = *colors++;
+          *m_pCurr++ = (color >> 8) | (color << 8);
+        }
+      }
+
+    protected:
+      uint16_t* m_pCurr;
+  };
+
+  void render(uint16_t* pFrame, uint16_t iScale, uint8_t scleraX, uint8_t scleraY, uint8_t uT, uint8_t lT)
+  {
+    FrameSink sink(pFrame);
+    renderEye(&sink, iScale, scleraX, scleraY, uT, lT);
+  }
+
+  // The path each pixel took can be worked out from which tables were read
+  // for it.  The remaining counts are taken from the kernel source:
+  //  - Each frame divides once to calculate irisScale.
+  //  - Each row has the row offsets into sclera and polar, which only need
+  //    multiplies if the tables aren't a power of 2 wide.
+  //  - Each iris pixel multiplies d by irisScale and, if IRIS_MAP_WIDTH isn't
+  //    a power of 2, multiplies for the angle and the row offset into iris.
+  #define IS_POWER_OF_2(X)    (((X) & ((X) - 1)) == 0)
+  #define TABLE_WIDTH(TABLE)  (sizeof(::TABLE[0]) / sizeof(::TABLE[0][0]))
+  #define TABLE_HEIGHT(TABLE) (sizeof(::TABLE) / sizeof(::TABLE[0]))
+  #define POLAR_WIDTH         TABLE_WIDTH(polar)
+
+  const uint32_t g_rowMultiplies  = (IS_POWER_OF_2(SCLERA_WIDTH) ? 0 : 1) + (IS_POWER_OF_2(POLAR_WIDTH) ? 0 : 1);
+  const uint32_t g_irisMultiplies = 1 + (IS_POWER_OF_2(IRIS_MAP_WIDTH) ? 0 : 2);
+
+  void count(RenderCounts* pCounts, uint32_t** ppHeatmaps,
+             uint16_t iScale, uint8_t scleraX, uint8_t scleraY, uint8_t uT, uint8_t lT)
+  {
+    RenderCounts      frame;
+    counted::SpiCount sink;
+
+    memset(&frame, 0, sizeof(frame));
+    counted::g_pCounts = &frame;
+    counted::g_ppHeatmaps = ppHeatmaps;
+    counted::g_lastLine = 0;
+    counted::renderEye(&sink, iScale, scleraX, scleraY, uT, lT);
+
+    frame.frames = 1;
+    frame.rows = SCREEN_Y_END - SCREEN_Y_START;
+    frame.pixels = sink.pixels();
+    frame.irisPixels = frame.flashLoads[FLASH_IRIS];
+    frame.irisEdgePixels = frame.flashLoads[FLASH_POLAR] - frame.irisPixels;
+    frame.scleraPixels = frame.flashLoads[FLASH_SCLERA] - frame.irisEdgePixels;
+    frame.eyelidPixels = frame.pixels - frame.flashLoads[FLASH_POLAR] - frame.scleraPixels;
+    frame.multiplies = frame.rows * g_rowMultiplies + frame.irisPixels * g_irisMultiplies;
+    frame.divides = 1;
+    // drawEye() sends setAddrWindow()'s 3 commands and 4 data bytes one at a
+    // time and then the pixels as the kernel handed them over.
+    frame.spiBytes = 7 + sink.bytes();
+    frame.spiTransactions = 7 + sink.transactions();
+
+    uint64_t* pDest = (uint64_t*)pCounts;
+    uint64_t* pSrc = (uint64_t*)&frame;
+    for (size_t i = 0 ; i < sizeof(frame) / sizeof(*pSrc) ; i++) {
+      pDest[i] += pSrc[i];
+    }
+  }
+
+  EyeAsset g_asset = {
+    STRINGIFY(EYE_NAME),
+    EYE_SYMMETRICAL,
+    SCLERA_WIDTH - SCREEN_WIDTH,
+    SCLERA_HEIGHT - SCREEN_HEIGHT,
+    IRIS_MIN,
+    IRIS_MAX,
+    { TABLE_WIDTH(sclera), TABLE_WIDTH(iris), TABLE_WIDTH(polar), TABLE_WIDTH(upper), TABLE_WIDTH(lower),
+      SCLERA_PALETTE_ENTRIES + IRIS_PALETTE_ENTRIES },
+    { TABLE_HEIGHT(sclera), TABLE_HEIGHT(iris), TABLE_HEIGHT(polar), TABLE_HEIGHT(upper), TABLE_HEIGHT(lower),
+      (SCLERA_PALETTE_ENTRIES + IRIS_PALETTE_ENTRIES) ? 1 : 0 },
+    { ::sclera, ::iris, ::polar, ::upper, ::lower, NULL },
+    render,
+    count,
+    NULL
+  };
+
+  struct Registration {
+    Registration() { registerEyeAsset(&g_asset); }
+  } g_registration;
+}
@@ -0,0 +1,253 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// LPC1768 cost model of drawEye() for every eye in ../src/graphics, and for
+// the byte swapped and paletted eyes which the Makefile builds from them.
+//
+// Each eye is rendered over the eyeSweep() poses by the counted build of the
+// kernel in eyeAsset.cpp, which counts the loads from each flash table and
+// which path every pixel took.  The per frame averages of those counts are
+// turned into cycles with the instruction timings of the Cortex-M3 and the
+// per path instruction mix of the kernel as built by arm-none-eabi-gcc -O2.
+// The SPI time is added on top of the CPU time since pushColor() and
+// pushWireColors() flush their pixels before returning, so none of it
+// overlaps with rendering.
+//
+// The model can be calibrated against the average PROFILE_DRAW_EYE time that
+// the firmware reports (with PROFILE enabled in config.h) for the eye in
+// config.h.  That prints a CPU_SCALE to paste in below, which then corrects
+// the CPU side of the estimates for every eye.
+//
+// Usage: renderCost [-c drawEyeUs] [eyeName]
+//   -c drawEyeUs  Measured drawEye() time to calibrate against.  eyeName
+//                 must then pick out a single eye.
+//   eyeName       Only model eyes whose name contains this string.
+#include "EyeAsset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// 96MHz core with the SSP clocked at CPU_HZ / 5 by SSD1351::commonInit().
+#define CPU_HZ                  96000000
+#define SPI_CYCLES_PER_BYTE     (8 * 5)
+
+// Cortex-M3 / LPC1768 instruction timings in cycles.
+#define CYCLES_ALU              1   // Data processing, compares and untaken branches
+#define CYCLES_LOAD             2   // LDR from SRAM or a hit in the flash accelerator
+#define CYCLES_LINE_FILL        5   // Extra for a flash line fill, FLASHTIM of 5 clocks for 96MHz
+#define CYCLES_MULTIPLY         1   // MUL/MLA
+#define CYCLES_DIVIDE           7   // UDIV takes 2 - 12 cycles depending on the operands
+#define CYCLES_TAKEN_BRANCH     3   // 1 + pipeline refill
+#define CYCLES_PERIPHERAL       3   // GPIO/SSP register access, averaged over AHB and APB
+
+// Correction applied to the CPU side of the estimates, from renderCost -c.
+// 1.0 until measured on hardware.
+#define CPU_SCALE               1.0
+
+// Instructions per pixel for each path through the kernel, other than the
+// table loads, multiplies and divides which are counted separately.  Includes
+// the loop increments and compare plus the branch back to the top.
+struct PathCost {
+  uint32_t alu;
+  uint32_t takenBranches;
+};
+
+static const PathCost g_eyelidPath    = {  7, 2 };
+static const PathCost g_scleraPath    = { 14, 2 };
+static const PathCost g_irisPath      = { 25, 2 };
+static const PathCost g_irisEdgePath  = { 18, 2 };
+// Resetting scleraX/irisX at the end of each row.
+static const PathCost g_rowCost       = {  6, 1 };
+// irisThreshold/irisScale setup plus setAddrWindow()'s own code per frame.
+static const PathCost g_frameCost     = { 40, 4 };
+
+// Each SPI transaction (pushColor(), pushWireColors() or the
+// writeCmd()/writeData() calls of setAddrWindow()) loads m_pSpi, the SSP base
+// and the mask and set/clear registers of the DC and CS DigitalOuts from SRAM,
+// accesses GPIO 3 times, waits once for the SSP to go idle, and
+// calls/returns.  Each byte sent in it then reads the SSP status and writes
+// the data register, so that a pushColor() comes to 8 peripheral accesses.
+#define TRANSACTION_SRAM_LOADS      10
+#define TRANSACTION_PERIPHERAL      4
+#define TRANSACTION_ALU             14
+#define TRANSACTION_TAKEN_BRANCHES  2
+#define BYTE_PERIPHERAL             2
+
+
+struct FrameCost {
+  double sramLoads;
+  double takenBranches;
+  double kernelCycles;   // drawEye()'s own code
+  double displayCycles;  // SSD1351 driver code
+  double spiCycles;      // Waiting for the bytes to be shifted out
+
+  double cpuCycles() const { return kernelCycles + displayCycles; }
+  double totalCycles(double cpuScale) const { return cpuCycles() * cpuScale + spiCycles; }
+};
+
+static double pathCycles(const PathCost& path, double count)
+{
+  return count * (path.alu * CYCLES_ALU + path.takenBranches * CYCLES_TAKEN_BRANCH);
+}
+
+static FrameCost frameCost(const RenderCounts& counts)
+{
+  double    frames = counts.frames;
+  double    loads = 0.0;
+  double    fills = 0.0;
+  FrameCost cost;
+
+  for (int i = 0 ; i < FLASH_TABLE_COUNT ; i++) {
+    loads += counts.flashLoads[i];
+    fills += counts.flashLineFills[i];
+  }
+
+  cost.kernelCycles = (loads * CYCLES_LOAD + fills * CYCLES_LINE_FILL +
+                       counts.multiplies * CYCLES_MULTIPLY + counts.divides * CYCLES_DIVIDE +
+                       pathCycles(g_eyelidPath, counts.eyelidPixels) +
+                       pathCycles(g_scleraPath, counts.scleraPixels) +
+                       pathCycles(g_irisPath, counts.irisPixels) +
+                       pathCycles(g_irisEdgePath, counts.irisEdgePixels) +
+                       pathCycles(g_rowCost, counts.rows) +
+                       pathCycles(g_frameCost, counts.frames)) / frames;
+  cost.displayCycles = (double)counts.spiTransactions / frames *
+                       (TRANSACTION_SRAM_LOADS * CYCLES_LOAD +
+                        TRANSACTION_PERIPHERAL * CYCLES_PERIPHERAL +
+                        TRANSACTION_ALU * CYCLES_ALU +
+                        TRANSACTION_TAKEN_BRANCHES * CYCLES_TAKEN_BRANCH) +
+                       (double)counts.spiBytes / frames * BYTE_PERIPHERAL * CYCLES_PERIPHERAL;
+  cost.spiCycles = (double)counts.spiBytes / frames * SPI_CYCLES_PER_BYTE;
+
+  cost.sramLoads = (double)counts.spiTransactions / frames * TRANSACTION_SRAM_LOADS;
+  cost.takenBranches = (counts.eyelidPixels * g_eyelidPath.takenBranches +
+                        counts.scleraPixels * g_scleraPath.takenBranches +
+                        counts.irisPixels * g_irisPath.takenBranches +
+                        counts.irisEdgePixels * g_irisEdgePath.takenBranches +
+                        counts.rows * g_rowCost.takenBranches +
+                        counts.frames * g_frameCost.takenBranches +
+                        counts.spiTransactions * TRANSACTION_TAKEN_BRANCHES) / frames;
+
+  return cost;
+}
+
+static RenderCounts countSweep(const EyeAsset* pAsset)
+{
+  EyePose      poses[EYE_SWEEP_FRAMES];
+  RenderCounts counts;
+
+  memset(&counts, 0, sizeof(counts));
+  eyeSweep(pAsset, poses);
+  for (size_t i = 0 ; i < EYE_SWEEP_FRAMES ; i++) {
+    const EyePose* pPose = &poses[i];
+    pAsset->count(&counts, NULL, pPose->iScale, pPose->scleraX, pPose->scleraY, pPose->upper, pPose->lower);
+  }
+  return counts;
+}
+
+static double perFrame(const RenderCounts& counts, uint64_t value)
+{
+  return (double)value / counts.frames;
+}
+
+int main(int argc, char** argv)
+{
+  double      measuredUs = 0.0;
+  double      cpuScale = CPU_SCALE;
+  const char* pFilter = NULL;
+  bool        usage = false;
+
+  for (int i = 1 ; i < argc ; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      measuredUs = strtod(argv[++i], NULL);
+      usage = measuredUs <= 0.0;
+    } else if (argv[i][0] != '-' && !pFilter) {
+      pFilter = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || (measuredUs > 0.0 && !pFilter)) {
+    fprintf(stderr, "Usage: renderCost [-c drawEyeUs] [eyeName]\n");
+    return 1;
+  }
+
+  uint32_t matches = 0;
+  for (EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    matches += (!pFilter || strstr(pAsset->pName, pFilter)) && !pAsset->symmetrical;
+  }
+  if (measuredUs > 0.0) {
+    if (matches != 1) {
+      fprintf(stderr, "%s must match a single eye to calibrate against.\n", pFilter);
+      return 1;
+    }
+    for (EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+      if (strstr(pAsset->pName, pFilter) && !pAsset->symmetrical) {
+        FrameCost cost = frameCost(countSweep(pAsset));
+        double    measuredCycles = measuredUs * (CPU_HZ / 1e6);
+        cpuScale = (measuredCycles - cost.spiCycles) / cost.cpuCycles();
+        printf("%s: modelled %.0f CPU + %.0f SPI cycles, measured %.0f cycles.\n",
+               pAsset->pName, cost.cpuCycles(), cost.spiCycles, measuredCycles);
+        printf("#define CPU_SCALE               %.3f\n\n", cpuScale);
+      }
+    }
+  }
+
+  printf("Per frame %-14s %37s %7s %7s %5s %3s %8s %8s\n",
+         "", "flash loads", "line", "SRAM", "", "", "taken", "SPI");
+  printf("%-14s %-5s %7s %7s %7s %7s %7s %7s %7s %7s %5s %3s %8s %8s\n",
+         "eye", "sym", "sclera", "iris", "polar", "upper", "lower", "palette", "fills", "loads", "mul",
+         "div", "branches", "bytes");
+  for (EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    if (pFilter && !strstr(pAsset->pName, pFilter)) {
+      continue;
+    }
+
+    RenderCounts counts = countSweep(pAsset);
+    FrameCost    cost = frameCost(counts);
+    uint64_t     fills = 0;
+    for (int i = 0 ; i < FLASH_TABLE_COUNT ; i++) {
+      fills += counts.flashLineFills[i];
+    }
+    printf("%-14s %-5s %7.0f %7.0f %7.0f %7.0f %7.0f %7.0f %7.0f %7.0f %5.0f %3.0f %8.0f %8.0f\n",
+           pAsset->pName, pAsset->symmetrical ? "yes" : "no",
+           perFrame(counts, counts.flashLoads[FLASH_SCLERA]),
+           perFrame(counts, counts.flashLoads[FLASH_IRIS]),
+           perFrame(counts, counts.flashLoads[FLASH_POLAR]),
+           perFrame(counts, counts.flashLoads[FLASH_UPPER]),
+           perFrame(counts, counts.flashLoads[FLASH_LOWER]),
+           perFrame(counts, counts.flashLoads[FLASH_PALETTE]),
+           perFrame(counts, fills), cost.sramLoads,
+           perFrame(counts, counts.multiplies), perFrame(counts, counts.divides),
+           cost.takenBranches, perFrame(counts, counts.spiBytes));
+  }
+
+  printf("\nEstimated LPC1768 cycles per frame (CPU_SCALE %.3f)\n", cpuScale);
+  printf("%-14s %-5s %9s %9s %9s %9s %8s %8s\n",
+         "eye", "sym", "kernel", "display", "SPI", "total", "us", "frames/s");
+  for (EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    if (pFilter && !strstr(pAsset->pName, pFilter)) {
+      continue;
+    }
+
+    FrameCost cost = frameCost(countSweep(pAsset));
+    double    total = cost.totalCycles(cpuScale);
+    printf("%-14s %-5s %9.0f %9.0f %9.0f %9.0f %8.0f %8.1f\n",
+           pAsset->pName, pAsset->symmetrical ? "yes" : "no",
+           cost.kernelCycles * cpuScale, cost.displayCycles * cpuScale, cost.spiCycles, total,
+           total * 1e6 / CPU_HZ, CPU_HZ / total);
+  }
+
+  return 0;
+}
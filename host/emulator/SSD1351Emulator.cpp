@@ -0,0 +1,272 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "SSD1351Emulator.h"
+#include <SSD1351.h>
+
+
+// SETREMAP bits.
+#define REMAP_VERTICAL_INCREMENT (1 << 0)
+#define REMAP_COLUMN_REVERSE     (1 << 1)
+#define REMAP_COLOR_CBA          (1 << 2)
+#define REMAP_SCAN_REVERSE       (1 << 4)
+#define REMAP_COLOR_DEPTH_SHIFT  6
+#define REMAP_COLOR_DEPTH_262K   2
+
+
+SSD1351Emulator::SSD1351Emulator(PinName dcPin, PinName csPin)
+{
+  m_dcPin = dcPin;
+  m_csPin = csPin;
+  m_dc = false;
+  m_selected = false;
+  m_command = 0;
+  m_argIndex = 0;
+  m_windowChanged = false;
+  m_pixelIndex = 0;
+  m_columnStart = 0;
+  m_columnEnd = SSD1351_RAM_WIDTH - 1;
+  m_rowStart = 0;
+  m_rowEnd = SSD1351_RAM_HEIGHT - 1;
+  m_column = 0;
+  m_row = 0;
+  // Power on reset values.
+  m_remap = 0x40;
+  m_startLine = 0;
+  m_frameValid = false;
+  memset(m_ram, 0, sizeof(m_ram));
+  memset(m_frame, 0, sizeof(m_frame));
+  resetTraffic();
+
+  mbedHost::addListener(this);
+}
+
+SSD1351Emulator::~SSD1351Emulator()
+{
+  mbedHost::removeListener(this);
+}
+
+void SSD1351Emulator::resetTraffic()
+{
+  memset(&m_traffic, 0, sizeof(m_traffic));
+}
+
+void SSD1351Emulator::pinWrite(PinName pin, int value)
+{
+  if (pin == m_dcPin) {
+    m_dc = value != 0;
+  }
+  if (pin == m_csPin) {
+    bool selected = value == 0;
+    if (selected && !m_selected) {
+      m_traffic.transactions++;
+    }
+    m_selected = selected;
+  }
+}
+
+void SSD1351Emulator::spiWrite(int value)
+{
+  if (!m_selected) {
+    return;
+  }
+  if (m_dc) {
+    m_traffic.dataBytes++;
+    argument((uint8_t)value);
+  } else {
+    m_traffic.commandBytes++;
+    command((uint8_t)value);
+  }
+}
+
+void SSD1351Emulator::command(uint8_t command)
+{
+  m_command = command;
+  m_argIndex = 0;
+  m_pixelIndex = 0;
+  if (command == SSD1351_CMD_WRITERAM && m_windowChanged) {
+    m_traffic.windowResets++;
+    m_windowChanged = false;
+  }
+}
+
+void SSD1351Emulator::argument(uint8_t value)
+{
+  uint8_t index = m_argIndex++;
+
+  switch (m_command) {
+  case SSD1351_CMD_SETCOLUMN:
+    value &= SSD1351_RAM_WIDTH - 1;
+    if (index == 0) {
+      m_columnStart = value;
+    } else if (index == 1) {
+      m_columnEnd = value;
+      m_column = m_columnStart;
+      m_windowChanged = true;
+    }
+    break;
+  case SSD1351_CMD_SETROW:
+    value &= SSD1351_RAM_HEIGHT - 1;
+    if (index == 0) {
+      m_rowStart = value;
+    } else if (index == 1) {
+      m_rowEnd = value;
+      m_row = m_rowStart;
+      m_windowChanged = true;
+    }
+    break;
+  case SSD1351_CMD_WRITERAM:
+    m_traffic.pixelBytes++;
+    pixelByte(value);
+    break;
+  case SSD1351_CMD_SETREMAP:
+    if (index == 0) {
+      m_remap = value;
+    }
+    break;
+  case SSD1351_CMD_STARTLINE:
+    if (index == 0) {
+      m_startLine = value & (SSD1351_RAM_HEIGHT - 1);
+    }
+    break;
+  }
+}
+
+void SSD1351Emulator::pixelByte(uint8_t value)
+{
+  bool is262k = (m_remap >> REMAP_COLOR_DEPTH_SHIFT) >= REMAP_COLOR_DEPTH_262K;
+
+  m_pixelBytes[m_pixelIndex++] = value;
+  if (is262k) {
+    // Three bytes with the 6 bits of each color in the lower bits.
+    if (m_pixelIndex < 3) {
+      return;
+    }
+    storePixel(((m_pixelBytes[0] & 0x3F) << 12) | ((m_pixelBytes[1] & 0x3F) << 6) | (m_pixelBytes[2] & 0x3F));
+  } else {
+    // 5-6-5 high byte first, expanded to 6-6-6.
+    if (m_pixelIndex < 2) {
+      return;
+    }
+    uint16_t pixel = (m_pixelBytes[0] << 8) | m_pixelBytes[1];
+    uint32_t c = (pixel >> 11) & 0x1F;
+    uint32_t b = (pixel >> 5) & 0x3F;
+    uint32_t a = pixel & 0x1F;
+    storePixel((((c << 1) | (c >> 4)) << 12) | (b << 6) | ((a << 1) | (a >> 4)));
+  }
+  m_pixelIndex = 0;
+}
+
+void SSD1351Emulator::storePixel(uint32_t rgb666)
+{
+  // Data is always stored with the first color received in the upper bits.
+  // The color remap bit selects whether that drives the red or blue subpixel.
+  if (!(m_remap & REMAP_COLOR_CBA)) {
+    rgb666 = ((rgb666 & 0x3F) << 12) | (rgb666 & 0xFC0) | (rgb666 >> 12);
+  }
+  m_ram[m_row][m_column] = rgb666;
+  advancePointer();
+}
+
+void SSD1351Emulator::advancePointer()
+{
+  bool wrapped = false;
+
+  if (m_remap & REMAP_VERTICAL_INCREMENT) {
+    if (m_row++ >= m_rowEnd) {
+      m_row = m_rowStart;
+      if (m_column++ >= m_columnEnd) {
+        m_column = m_columnStart;
+        wrapped = true;
+      }
+    }
+  } else {
+    if (m_column++ >= m_columnEnd) {
+      m_column = m_columnStart;
+      if (m_row++ >= m_rowEnd) {
+        m_row = m_rowStart;
+        wrapped = true;
+      }
+    }
+  }
+
+  bool fullScreen = m_columnStart == 0 && m_columnEnd == SSD1351_RAM_WIDTH - 1 &&
+                    m_rowStart == 0 && m_rowEnd == SSD1351_RAM_HEIGHT - 1;
+  if (wrapped && fullScreen) {
+    m_traffic.frames++;
+    memcpy(m_frame, m_ram, sizeof(m_frame));
+    m_frameValid = true;
+  }
+}
+
+uint32_t SSD1351Emulator::viewPixel(const Ram& ram, uint8_t x, uint8_t y) const
+{
+  // Adafruit's modules are mounted with COM127 at the top so a reversed COM
+  // scan is what shows RAM row 0 at the top of the panel.
+  uint8_t line = (m_remap & REMAP_SCAN_REVERSE) ? y : SSD1351_RAM_HEIGHT - 1 - y;
+  uint8_t row = (line + m_startLine) & (SSD1351_RAM_HEIGHT - 1);
+  uint8_t column = (m_remap & REMAP_COLUMN_REVERSE) ? SSD1351_RAM_WIDTH - 1 - x : x;
+  uint32_t rgb666 = ram[row][column];
+
+  uint32_t r = (rgb666 >> 12) & 0x3F;
+  uint32_t g = (rgb666 >> 6) & 0x3F;
+  uint32_t b = rgb666 & 0x3F;
+  return (((r << 2) | (r >> 4)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 2) | (b >> 4));
+}
+
+uint32_t SSD1351Emulator::viewPixel(uint8_t x, uint8_t y) const
+{
+  return viewPixel(m_ram, x, y);
+}
+
+uint32_t SSD1351Emulator::viewCrc(bool lastFrame) const
+{
+  const Ram& ram = viewRam(lastFrame);
+  uint32_t   crc = ~0U;
+
+  for (int y = 0 ; y < SSD1351_RAM_HEIGHT ; y++) {
+    for (int x = 0 ; x < SSD1351_RAM_WIDTH ; x++) {
+      uint32_t rgb = viewPixel(ram, x, y);
+      for (int i = 16 ; i >= 0 ; i -= 8) {
+        crc ^= (rgb >> i) & 0xFF;
+        for (int bit = 0 ; bit < 8 ; bit++) {
+          crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+      }
+    }
+  }
+  return ~crc;
+}
+
+bool SSD1351Emulator::writePpm(const char* pFilename, bool lastFrame) const
+{
+  FILE* pFile = fopen(pFilename, "wb");
+  if (!pFile) {
+    return false;
+  }
+
+  const Ram& ram = viewRam(lastFrame);
+  fprintf(pFile, "P6\n%d %d\n255\n", SSD1351_RAM_WIDTH, SSD1351_RAM_HEIGHT);
+  for (int y = 0 ; y < SSD1351_RAM_HEIGHT ; y++) {
+    for (int x = 0 ; x < SSD1351_RAM_WIDTH ; x++) {
+      uint32_t rgb = viewPixel(ram, x, y);
+      fputc(rgb >> 16, pFile);
+      fputc(rgb >> 8, pFile);
+      fputc(rgb, pFile);
+    }
+  }
+
+  bool result = !ferror(pFile);
+  fclose(pFile);
+  return result;
+}
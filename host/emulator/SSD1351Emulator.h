@@ -0,0 +1,119 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Software SSD1351 which listens to the SPI bytes and DC/CS pin writes made
+// through the mbed HAL shim and decodes them the way the controller would.
+//
+// Supported commands:
+//   SETCOLUMN/SETROW  Address window.  Each resets the address pointer to the
+//                     start of the window.
+//   WRITERAM          Following data bytes are pixels, written into GDDRAM at
+//                     the address pointer which then advances and wraps
+//                     within the window.
+//   SETREMAP          Address increment direction, column remap, color
+//                     (A-B-C vs C-B-A) remap, COM scan direction and color
+//                     depth (65k: 2 bytes/pixel or 262k: 3 bytes/pixel).  The
+//                     odd/even COM split is assumed to be enabled, as it is on
+//                     Adafruit's 128x128 modules.
+//   STARTLINE         Vertical scroll of GDDRAM onto the panel.
+// Everything else is counted but otherwise ignored.
+//
+// The image written by writePpm() is the panel as viewed, oriented such that
+// the driver's setRotation(0) shows GFX coordinate (0,0) in the top left.
+#ifndef _SSD1351_EMULATOR_H_
+#define _SSD1351_EMULATOR_H_
+
+#include <mbed.h>
+
+
+#define SSD1351_RAM_WIDTH  128
+#define SSD1351_RAM_HEIGHT 128
+
+
+// Wire traffic seen by one display.
+struct SSD1351Traffic {
+  uint64_t commandBytes;  // Bytes sent with DC low
+  uint64_t dataBytes;     // Bytes sent with DC high (arguments and pixels)
+  uint64_t pixelBytes;    // The subset of dataBytes written to GDDRAM
+  uint64_t transactions;  // Number of times CS was asserted
+  uint64_t windowResets;  // WRITERAM commands issued after a new SETCOLUMN/SETROW
+  uint64_t frames;        // Times a full screen window was completely written
+};
+
+class SSD1351Emulator : public mbedHost::Listener
+{
+  public:
+    // Registers itself with the shim to watch the given DC and CS pins.
+    SSD1351Emulator(PinName dcPin, PinName csPin);
+    ~SSD1351Emulator();
+
+    const SSD1351Traffic& traffic() const { return m_traffic; }
+    void                  resetTraffic();
+
+    // GDDRAM contents as 18-bit (6-6-6) RGB, indexed by RAM row and column.
+    uint32_t ramPixel(uint8_t column, uint8_t row) const { return m_ram[row][column]; }
+    // Pixel as seen on the panel at (x,y), as 8-8-8 RGB.
+    uint32_t viewPixel(uint8_t x, uint8_t y) const;
+
+    // If lastFrame is set these use the most recent completed full screen
+    // frame instead of the current GDDRAM contents, which may be partway
+    // through an update.
+    // CRC-32 of the panel view, for comparing frames without image files.
+    uint32_t viewCrc(bool lastFrame = false) const;
+    // Writes the panel view as a binary PPM.
+    bool     writePpm(const char* pFilename, bool lastFrame = false) const;
+
+    // mbedHost::Listener
+    virtual void spiWrite(int value);
+    virtual void pinWrite(PinName pin, int value);
+
+  protected:
+    void command(uint8_t command);
+    void argument(uint8_t value);
+    void pixelByte(uint8_t value);
+    void storePixel(uint32_t rgb666);
+    void advancePointer();
+    typedef uint32_t Ram[SSD1351_RAM_HEIGHT][SSD1351_RAM_WIDTH];
+    const Ram& viewRam(bool lastFrame) const { return (lastFrame && m_frameValid) ? m_frame : m_ram; }
+    uint32_t   viewPixel(const Ram& ram, uint8_t x, uint8_t y) const;
+
+    SSD1351Traffic m_traffic;
+    PinName        m_dcPin;
+    PinName        m_csPin;
+    bool           m_dc;
+    bool           m_selected;
+
+    // Command decoding state.
+    uint8_t        m_command;
+    uint8_t        m_argIndex;
+    bool           m_windowChanged;
+    uint8_t        m_pixelBytes[3];
+    uint8_t        m_pixelIndex;
+
+    // Controller registers.
+    uint8_t        m_columnStart;
+    uint8_t        m_columnEnd;
+    uint8_t        m_rowStart;
+    uint8_t        m_rowEnd;
+    uint8_t        m_column;
+    uint8_t        m_row;
+    uint8_t        m_remap;
+    uint8_t        m_startLine;
+
+    Ram            m_ram;
+    Ram            m_frame;
+    bool           m_frameValid;
+};
+
+#endif // _SSD1351_EMULATOR_H_
@@ -0,0 +1,39 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// mbed-1768 pin names for the host build of the firmware.
+#ifndef MBED_PINNAMES_H
+#define MBED_PINNAMES_H
+
+typedef enum {
+  p5 = 5, p6, p7, p8, p9, p10, p11, p12, p13, p14, p15, p16, p17, p18, p19, p20,
+  p21, p22, p23, p24, p25, p26, p27, p28, p29, p30,
+  LED1, LED2, LED3, LED4,
+  USBTX, USBRX,
+
+  PIN_COUNT,
+
+  // Not connected
+  NC = -1
+} PinName;
+
+typedef enum {
+  PullUp,
+  PullDown,
+  PullNone,
+  OpenDrain,
+  PullDefault = PullDown
+} PinMode;
+
+#endif // MBED_PINNAMES_H
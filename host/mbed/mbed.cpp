@@ -0,0 +1,478 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "mbed.h"
+#include <algorithm>
+#include <stdarg.h>
+#include <string>
+#include <vector>
+
+
+// The virtual clock and SSP timing are kept in picoseconds internally.
+#define PS_PER_NS 1000ULL
+
+
+static uint64_t            g_nowPs;
+static uint64_t            g_limitPs;
+static uint64_t            g_spiWriteCount;
+static int                 g_pinLevels[PIN_COUNT];
+static float               g_analogValues[PIN_COUNT];
+
+
+// Function level statics so that they are constructed before any of the
+// firmware's global objects register themselves.
+static std::vector<InterruptIn*>& interrupts()
+{
+  static std::vector<InterruptIn*> s_interrupts;
+  return s_interrupts;
+}
+
+static std::vector<mbedHost::Listener*>& listeners()
+{
+  static std::vector<mbedHost::Listener*> s_listeners;
+  return s_listeners;
+}
+
+static std::vector<const char*>& localFileSystems()
+{
+  static std::vector<const char*> g_localFileSystems;
+  return g_localFileSystems;
+}
+
+static std::vector<Serial*>& serials()
+{
+  static std::vector<Serial*> s_serials;
+  return s_serials;
+}
+
+static bool isValidPin(PinName pin)
+{
+  return pin >= 0 && pin < PIN_COUNT;
+}
+
+static void advanceTo(uint64_t timePs)
+{
+  if (timePs <= g_nowPs) {
+    return;
+  }
+  g_nowPs = timePs;
+  if (g_limitPs && g_nowPs >= g_limitPs) {
+    throw mbedHost::TimeLimit();
+  }
+}
+
+
+// mbedHost ----------------------------------------------------------------
+uint64_t mbedHost::now()
+{
+  return g_nowPs / PS_PER_NS;
+}
+
+void mbedHost::advance(uint64_t ns)
+{
+  advanceTo(g_nowPs + ns * PS_PER_NS);
+}
+
+void mbedHost::setTimeLimit(uint64_t ns)
+{
+  g_limitPs = ns * PS_PER_NS;
+}
+
+void mbedHost::addListener(Listener* pListener)
+{
+  listeners().push_back(pListener);
+}
+
+void mbedHost::removeListener(Listener* pListener)
+{
+  std::vector<Listener*>& list = listeners();
+  list.erase(std::remove(list.begin(), list.end(), pListener), list.end());
+}
+
+uint64_t mbedHost::spiWriteCount()
+{
+  return g_spiWriteCount;
+}
+
+void mbedHost::setAnalog(PinName pin, float value)
+{
+  if (isValidPin(pin)) {
+    g_analogValues[pin] = value;
+  }
+}
+
+void mbedHost::setPin(PinName pin, int value)
+{
+  if (!isValidPin(pin)) {
+    return;
+  }
+  value = value ? 1 : 0;
+  if (g_pinLevels[pin] == value) {
+    return;
+  }
+  g_pinLevels[pin] = value;
+
+  // Copy in case a handler creates or destroys an InterruptIn.
+  std::vector<InterruptIn*> handlers = interrupts();
+  for (size_t i = 0 ; i < handlers.size() ; i++) {
+    handlers[i]->edge(pin, value);
+  }
+}
+
+int mbedHost::getPin(PinName pin)
+{
+  return isValidPin(pin) ? g_pinLevels[pin] : 0;
+}
+
+void mbedHost::serialReceive(const uint8_t* pData, size_t length)
+{
+  std::vector<Serial*> ports = serials();
+  for (size_t i = 0 ; i < ports.size() ; i++) {
+    ports[i]->receive(pData, length);
+  }
+}
+
+
+// SSP ---------------------------------------------------------------------
+static uint32_t sspStatus(const mbedHost::SspState* pState)
+{
+  uint32_t status = 0;
+
+  if (pState->busyUntil > g_nowPs) {
+    uint64_t queued = (pState->busyUntil - g_nowPs + pState->frameTime - 1) / pState->frameTime;
+    status |= SSP_SR_BSY;
+    if (queued < SSP_FIFO_DEPTH) {
+      status |= SSP_SR_TNF;
+    }
+  } else {
+    status |= SSP_SR_TNF;
+  }
+  return status;
+}
+
+mbedHost::SspDataRegister& mbedHost::SspDataRegister::operator=(int value)
+{
+  uint64_t start = std::max(g_nowPs, m_pState->busyUntil);
+
+  m_pState->busyUntil = start + m_pState->frameTime;
+  g_spiWriteCount++;
+  std::vector<Listener*>& list = listeners();
+  for (size_t i = 0 ; i < list.size() ; i++) {
+    list[i]->spiWrite(value);
+  }
+  return *this;
+}
+
+uint32_t mbedHost::SspStatusRegister::operator&(int mask)
+{
+  uint32_t status = sspStatus(m_pState);
+
+  // The caller is polling for a state change so skip ahead to it.  The value
+  // read is still the one from before the skip, just like real hardware where
+  // the state changes between two reads.
+  if ((mask & SSP_SR_TNF) && !(status & SSP_SR_TNF)) {
+    advanceTo(m_pState->busyUntil - (SSP_FIFO_DEPTH - 1) * m_pState->frameTime);
+  } else if ((mask & SSP_SR_BSY) && (status & SSP_SR_BSY)) {
+    advanceTo(m_pState->busyUntil);
+  }
+  return status & mask;
+}
+
+mbedHost::SspStatusRegister::operator uint32_t()
+{
+  return sspStatus(m_pState);
+}
+
+SPI::SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel)
+{
+  (void)mosi;
+  (void)miso;
+  (void)sclk;
+  (void)ssel;
+
+  m_registers.DR.m_pState = &m_state;
+  m_registers.SR.m_pState = &m_state;
+  m_state.busyUntil = 0;
+  _spi.spi = &m_registers;
+  m_bits = 8;
+  m_hz = 1000000;
+  updateFrameTime();
+}
+
+void SPI::format(int bits, int mode)
+{
+  (void)mode;
+  m_bits = bits;
+  updateFrameTime();
+}
+
+void SPI::frequency(int hz)
+{
+  m_hz = hz;
+  updateFrameTime();
+}
+
+int SPI::write(int value)
+{
+  while (!(m_registers.SR & SSP_SR_TNF)) {
+  }
+  m_registers.DR = value;
+  while (m_registers.SR & SSP_SR_BSY) {
+  }
+  return 0;
+}
+
+void SPI::updateFrameTime()
+{
+  m_state.frameTime = (uint64_t)m_bits * 1000000000000ULL / m_hz;
+}
+
+
+// GPIO --------------------------------------------------------------------
+DigitalOut::DigitalOut(PinName pin) : m_pin(pin)
+{
+  write(0);
+}
+
+DigitalOut::DigitalOut(PinName pin, int value) : m_pin(pin)
+{
+  write(value);
+}
+
+void DigitalOut::write(int value)
+{
+  if (m_pin == NC) {
+    return;
+  }
+  value = value ? 1 : 0;
+  if (isValidPin(m_pin)) {
+    g_pinLevels[m_pin] = value;
+  }
+  std::vector<mbedHost::Listener*>& list = listeners();
+  for (size_t i = 0 ; i < list.size() ; i++) {
+    list[i]->pinWrite(m_pin, value);
+  }
+}
+
+int DigitalOut::read()
+{
+  return mbedHost::getPin(m_pin);
+}
+
+InterruptIn::InterruptIn(PinName pin) : m_pin(pin)
+{
+  interrupts().push_back(this);
+}
+
+InterruptIn::~InterruptIn()
+{
+  std::vector<InterruptIn*>& list = interrupts();
+  list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+void InterruptIn::mode(PinMode mode)
+{
+  // Pulled up inputs idle high.  Doesn't count as an edge.
+  if (isValidPin(m_pin) && mode == PullUp) {
+    g_pinLevels[m_pin] = 1;
+  }
+}
+
+void InterruptIn::edge(PinName pin, int value)
+{
+  if (pin != m_pin) {
+    return;
+  }
+  if (value && m_rise) {
+    m_rise();
+  } else if (!value && m_fall) {
+    m_fall();
+  }
+}
+
+float AnalogIn::read()
+{
+  return isValidPin(m_pin) ? g_analogValues[m_pin] : 0.0f;
+}
+
+
+// Serial ------------------------------------------------------------------
+Serial::Serial(PinName tx, PinName rx, const char* pName)
+{
+  (void)tx;
+  (void)rx;
+  (void)pName;
+  serials().push_back(this);
+}
+
+Serial::~Serial()
+{
+  std::vector<Serial*>& list = serials();
+  list.erase(std::remove(list.begin(), list.end(), this), list.end());
+}
+
+int Serial::readable()
+{
+  return !m_rxQueue.empty();
+}
+
+int Serial::getc()
+{
+  if (m_rxQueue.empty()) {
+    return -1;
+  }
+  uint8_t byte = m_rxQueue.front();
+  m_rxQueue.pop_front();
+  return byte;
+}
+
+int Serial::putc(int c)
+{
+  return fputc(c, stdout);
+}
+
+int Serial::puts(const char* pString)
+{
+  return fputs(pString, stdout);
+}
+
+int Serial::printf(const char* pFormat, ...)
+{
+  va_list args;
+  va_start(args, pFormat);
+  int result = vprintf(pFormat, args);
+  va_end(args);
+  return result;
+}
+
+void Serial::attach(void (*pFunction)(void), IrqType type)
+{
+  if (type == RxIrq) {
+    m_rxIrq = pFunction;
+  }
+}
+
+void Serial::receive(const uint8_t* pData, size_t length)
+{
+  for (size_t i = 0 ; i < length ; i++) {
+    m_rxQueue.push_back(pData[i]);
+    if (m_rxIrq) {
+      m_rxIrq();
+    }
+  }
+}
+
+
+// LocalFileSystem ---------------------------------------------------------
+static std::string g_localDirectory(".");
+
+void mbedHost::setLocalDirectory(const char* pPath)
+{
+  g_localDirectory = pPath;
+}
+
+const char* mbedHost::localDirectory()
+{
+  return g_localDirectory.c_str();
+}
+
+LocalFileSystem::LocalFileSystem(const char* pName) : m_pName(pName)
+{
+  localFileSystems().push_back(pName);
+}
+
+LocalFileSystem::~LocalFileSystem()
+{
+  std::vector<const char*>& names = localFileSystems();
+  names.erase(std::remove(names.begin(), names.end(), m_pName), names.end());
+}
+
+extern "C" FILE* __real_fopen(const char* pFilename, const char* pMode);
+
+extern "C" FILE* __wrap_fopen(const char* pFilename, const char* pMode)
+{
+  std::vector<const char*>& names = localFileSystems();
+
+  for (size_t i = 0 ; i < names.size() ; i++) {
+    size_t length = strlen(names[i]);
+    if (pFilename[0] == '/' && strncmp(pFilename + 1, names[i], length) == 0 && pFilename[length + 1] == '/') {
+      std::string path = g_localDirectory + (pFilename + length + 1);
+      return __real_fopen(path.c_str(), pMode);
+    }
+  }
+  return __real_fopen(pFilename, pMode);
+}
+
+
+// Time --------------------------------------------------------------------
+Timer::Timer()
+{
+  m_startTime = 0;
+  m_accumulated = 0;
+  m_running = false;
+}
+
+void Timer::start()
+{
+  if (!m_running) {
+    m_startTime = g_nowPs;
+    m_running = true;
+  }
+}
+
+void Timer::stop()
+{
+  m_accumulated = elapsed();
+  m_running = false;
+}
+
+void Timer::reset()
+{
+  m_startTime = g_nowPs;
+  m_accumulated = 0;
+}
+
+float Timer::read()
+{
+  return elapsed() / 1000000000000.0f;
+}
+
+int Timer::read_ms()
+{
+  return (int)(uint32_t)(elapsed() / (1000 * 1000 * PS_PER_NS));
+}
+
+int Timer::read_us()
+{
+  return (int)(uint32_t)(elapsed() / (1000 * PS_PER_NS));
+}
+
+uint64_t Timer::elapsed()
+{
+  return m_accumulated + (m_running ? g_nowPs - m_startTime : 0);
+}
+
+void wait(float s)
+{
+  mbedHost::advance((uint64_t)(s * 1000000000.0f));
+}
+
+void wait_ms(int ms)
+{
+  mbedHost::advance((uint64_t)ms * 1000000);
+}
+
+void wait_us(int us)
+{
+  mbedHost::advance((uint64_t)us * 1000);
+}
@@ -0,0 +1,275 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Shim for the parts of the mbed 2 HAL used by the firmware so that the
+// sources in ../src can be built unchanged for Linux.  Time is virtual, see
+// mbedHost.h for how it advances and how host tools drive the shim.
+//
+// The SPI class models the LPC1768 SSP peripheral closely enough for
+// FastSpiWriter: writes to DR go into an 8 frame transmit FIFO which drains at
+// the rate set by frequency()/format(), and SR reports TNF/BSY based on the
+// virtual clock.  Polling SR for a FIFO slot or for the port to go idle moves
+// the clock forward to when that happens.
+#ifndef MBED_H
+#define MBED_H
+
+#include <deque>
+#include <functional>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PinNames.h"
+#include "mbedHost.h"
+
+
+// SSP ---------------------------------------------------------------------
+#define SSP_FIFO_DEPTH 8
+#define SSP_SR_TNF     (1 << 1)
+#define SSP_SR_BSY     (1 << 4)
+
+namespace mbedHost
+{
+  // Times are in picoseconds so that frame times at typical SPI rates don't
+  // get rounded off.
+  struct SspState {
+    uint64_t frameTime;   // Time to shift out one frame
+    uint64_t busyUntil;   // Time at which the last queued frame has been sent
+  };
+
+  class SspDataRegister
+  {
+    public:
+      SspDataRegister& operator=(int value);
+
+      SspState* m_pState;
+  };
+
+  class SspStatusRegister
+  {
+    public:
+      uint32_t operator&(int mask);
+      operator uint32_t();
+
+      SspState* m_pState;
+  };
+
+  struct SspRegisters {
+    SspDataRegister   DR;
+    SspStatusRegister SR;
+  };
+}
+
+typedef struct spi_s {
+  mbedHost::SspRegisters* spi;
+} spi_t;
+
+class SPI
+{
+  public:
+    SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel = NC);
+
+    void format(int bits, int mode = 0);
+    void frequency(int hz = 1000000);
+    // Blocking write.  Nothing is ever received so it always returns 0.
+    int  write(int value);
+
+  protected:
+    void updateFrameTime();
+
+    spi_t                  _spi;
+    mbedHost::SspRegisters m_registers;
+    mbedHost::SspState     m_state;
+    int                    m_bits;
+    int                    m_hz;
+
+  private:
+    SPI(const SPI&);
+    SPI& operator=(const SPI&);
+};
+
+
+// GPIO --------------------------------------------------------------------
+class DigitalOut
+{
+  public:
+    DigitalOut(PinName pin);
+    DigitalOut(PinName pin, int value);
+
+    void write(int value);
+    int  read();
+    int  is_connected() { return m_pin != NC; }
+
+    DigitalOut& operator=(int value) { write(value); return *this; }
+    operator int() { return read(); }
+
+  protected:
+    PinName m_pin;
+};
+
+class DigitalIn
+{
+  public:
+    DigitalIn(PinName pin) : m_pin(pin) {}
+    DigitalIn(PinName pin, PinMode mode) : m_pin(pin) { (void)mode; }
+
+    int  read() { return mbedHost::getPin(m_pin); }
+    void mode(PinMode mode) { (void)mode; }
+    int  is_connected() { return m_pin != NC; }
+
+    operator int() { return read(); }
+
+  protected:
+    PinName m_pin;
+};
+
+class InterruptIn
+{
+  public:
+    InterruptIn(PinName pin);
+    ~InterruptIn();
+
+    int  read() { return mbedHost::getPin(m_pin); }
+    void mode(PinMode mode);
+
+    void rise(void (*pFunction)(void)) { m_rise = pFunction; }
+    void fall(void (*pFunction)(void)) { m_fall = pFunction; }
+    template<typename T>
+    void rise(T* pObject, void (T::*pMethod)(void)) { m_rise = [=]() { (pObject->*pMethod)(); }; }
+    template<typename T>
+    void fall(T* pObject, void (T::*pMethod)(void)) { m_fall = [=]() { (pObject->*pMethod)(); }; }
+
+    operator int() { return read(); }
+
+    // Called by mbedHost::setPin() for every pin change.
+    void edge(PinName pin, int value);
+
+  protected:
+    PinName               m_pin;
+    std::function<void()> m_rise;
+    std::function<void()> m_fall;
+
+  private:
+    InterruptIn(const InterruptIn&);
+    InterruptIn& operator=(const InterruptIn&);
+};
+
+class AnalogIn
+{
+  public:
+    AnalogIn(PinName pin) : m_pin(pin) {}
+
+    float          read();
+    unsigned short read_u16() { return (unsigned short)(read() * 65535.0f); }
+
+    operator float() { return read(); }
+
+  protected:
+    PinName m_pin;
+};
+
+
+// Serial ------------------------------------------------------------------
+class Serial
+{
+  public:
+    enum IrqType {
+      RxIrq = 0,
+      TxIrq
+    };
+
+    Serial(PinName tx, PinName rx, const char* pName = NULL);
+    ~Serial();
+
+    void baud(int baudRate) { (void)baudRate; }
+    int  readable();
+    int  writeable() { return 1; }
+    int  getc();
+    int  putc(int c);
+    int  puts(const char* pString);
+    int  printf(const char* pFormat, ...);
+
+    void attach(void (*pFunction)(void), IrqType type = RxIrq);
+    template<typename T>
+    void attach(T* pObject, void (T::*pMethod)(void), IrqType type = RxIrq)
+    {
+      if (type == RxIrq) {
+        m_rxIrq = [=]() { (pObject->*pMethod)(); };
+      }
+    }
+
+    // Called by mbedHost::serialReceive().
+    void receive(const uint8_t* pData, size_t length);
+
+  protected:
+    std::function<void()> m_rxIrq;
+    std::deque<uint8_t>   m_rxQueue;
+
+  private:
+    Serial(const Serial&);
+    Serial& operator=(const Serial&);
+};
+
+
+// LocalFileSystem ---------------------------------------------------------
+// Stand-in for the mbed's USB drive.  Programs linked with -Wl,--wrap=fopen
+// have fopen("/<name>/<file>") redirected to <file> in
+// mbedHost::localDirectory().
+class LocalFileSystem
+{
+  public:
+    LocalFileSystem(const char* pName);
+    ~LocalFileSystem();
+
+  protected:
+    const char* m_pName;
+};
+
+
+// Time --------------------------------------------------------------------
+class Timer
+{
+  public:
+    Timer();
+
+    void  start();
+    void  stop();
+    void  reset();
+    float read();
+    int   read_ms();
+    int   read_us();
+
+    operator float() { return read(); }
+
+  protected:
+    uint64_t elapsed();
+
+    uint64_t m_startTime;
+    uint64_t m_accumulated;
+    bool     m_running;
+};
+
+void wait(float s);
+void wait_ms(int ms);
+void wait_us(int us);
+
+
+// Interrupts --------------------------------------------------------------
+// Interrupt handlers only ever run synchronously from mbedHost calls so there
+// is nothing to mask.
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+
+#endif // MBED_H
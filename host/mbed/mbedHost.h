@@ -0,0 +1,73 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Host side control of the mbed HAL shim.  Host tools use these to drive the
+// inputs seen by the firmware, watch its outputs and control virtual time.
+//
+// The virtual clock only moves when the firmware waits on hardware: shifting
+// bytes out of the SPI port, wait_ms()/wait_us() and explicit calls to
+// mbedHost::advance().  Code in between takes no virtual time at all, so runs
+// are deterministic and much faster than real time, and the frame times seen
+// by the firmware are its SPI transfer times.
+#ifndef MBED_HOST_H
+#define MBED_HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "PinNames.h"
+
+
+namespace mbedHost
+{
+  // Thrown out of the firmware once the virtual clock passes the time limit.
+  struct TimeLimit {};
+
+  // Virtual time in nanoseconds since startup.
+  uint64_t now();
+  void     advance(uint64_t ns);
+  // 0 disables the limit.
+  void     setTimeLimit(uint64_t ns);
+
+  // Notified of everything the firmware sends to the outside world.
+  class Listener
+  {
+    public:
+      virtual ~Listener() {}
+
+      // A byte (or frame of SPI format() bits) written to an SPI data register.
+      virtual void spiWrite(int value) { (void)value; }
+      // A DigitalOut being written.  Writes of an unchanged level are reported
+      // too.
+      virtual void pinWrite(PinName pin, int value) { (void)pin; (void)value; }
+  };
+  void addListener(Listener* pListener);
+  void removeListener(Listener* pListener);
+
+  // Number of SPI frames written since startup.
+  uint64_t spiWriteCount();
+
+  // Inputs.  setPin() runs the InterruptIn handlers for the pin if its level
+  // changes.  serialReceive() queues bytes for every Serial object and runs its
+  // RX interrupt handler.  Analog inputs read as 0.0 until set.
+  void setAnalog(PinName pin, float value);
+  void setPin(PinName pin, int value);
+  int  getPin(PinName pin);
+  void serialReceive(const uint8_t* pData, size_t length);
+
+  // Directory which LocalFileSystem files live in ("." until set).
+  void        setLocalDirectory(const char* pPath);
+  const char* localDirectory();
+}
+
+#endif // MBED_HOST_H
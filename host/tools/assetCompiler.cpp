@@ -0,0 +1,574 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compiles sclera, iris and eyelid images into a ../src/graphics/*Eye.h
+// header in the same layout as the existing ones, and reports how many bytes
+// of flash each of its tables takes.
+//
+// Images are read as netpbm files (P2/P3/P5/P6, up to 16-bits per sample).
+// PNG sources can be converted with pngtopnm or ImageMagick's convert first.
+// The sclera and iris are converted to RGB565, the eyelid maps are used as is
+// and the polar table is generated for a round pupil of the given diameter.
+// Eyes with a slit pupil (catEye, dragonEye, goatEye) had their polar table
+// drawn by hand so it can be passed in as a 16-bit PGM instead.
+//
+// By default the output can be dropped straight into config.h.  The other
+// layouts are opt-in:
+//   -b  Swaps the bytes of each RGB565 pixel so that the tables hold them in
+//       the order they are sent to the SSD1351, which eyeRender.h then sends
+//       a row at a time through pushWireColors() straight from memory.
+//       Defines RGB565_BYTE_SWAPPED.
+//   -p  Replaces the sclera and/or iris with 8-bit indices into a palette of
+//       RGB565 colours when they have no more than 256 colours.  Defines
+//       SCLERA_PALETTE_SIZE / IRIS_PALETTE_SIZE, which eyeRender.h handles.
+//   -e  Adds run length encodings of each eyelid map's rows as
+//       <name>Spans[] (length, threshold) pairs and <name>SpanRows[] offsets
+//       of the first span of each row, for span based renderers.
+//   -a  Pads each row of every table out to a multiple of the given number of
+//       bytes and aligns the tables to it, so that rows start on a flash
+//       accelerator line.  Defines <TABLE>_STRIDE.
+//
+// Usage: assetCompiler -s sclera.ppm -i iris.ppm -u upper.pgm -l lower.pgm
+//                      [-U upper.pgm -L lower.pgm] (-d irisDiameter | -P polar.pgm)
+//                      [-m irisMin -M irisMax] [-b] [-p] [-e] [-a alignment]
+//                      [-o output.h]
+//   -U/-L  Eyelid maps for SYMMETRICAL_EYELID.
+//   -d     Diameter in pixels of the round iris to generate the polar table for.
+//   -P     16-bit PGM of a polar table from an existing eye.
+//   -m/-M  IRIS_MIN and IRIS_MAX overrides.
+//   -o     Header to write (default is stdout).
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+
+struct Image {
+  uint32_t              width;
+  uint32_t              height;
+  uint32_t              channels;
+  uint32_t              maxValue;
+  std::vector<uint32_t> samples;
+};
+
+// One of the arrays written to the header.  1-dimensional arrays have an
+// empty heightName.
+struct Table {
+  const char*           pName;
+  std::string           heightName;
+  std::string           widthName;
+  uint32_t              width;
+  uint32_t              height;
+  uint32_t              stride;
+  uint32_t              entrySize;
+  uint32_t              alignment;
+  std::vector<uint32_t> values;
+
+  uint32_t bytes() const { return stride * height * entrySize; }
+};
+
+
+static uint32_t    g_alignment = 0;
+static bool        g_byteSwap = false;
+static uint32_t    g_totalBytes = 0;
+
+
+static int readChar(FILE* pFile)
+{
+  int c = fgetc(pFile);
+  if (c == '#') {
+    while (c != '\n' && c != EOF) {
+      c = fgetc(pFile);
+    }
+  }
+  return c;
+}
+
+static bool readNumber(FILE* pFile, uint32_t* pValue)
+{
+  int c;
+
+  do {
+    c = readChar(pFile);
+  } while (isspace(c));
+  if (!isdigit(c)) {
+    return false;
+  }
+  *pValue = 0;
+  while (isdigit(c)) {
+    *pValue = *pValue * 10 + (c - '0');
+    c = readChar(pFile);
+  }
+  return true;
+}
+
+static bool readImage(const char* pFilename, Image* pImage)
+{
+  FILE* pFile = fopen(pFilename, "rb");
+  char  magic[2];
+
+  if (!pFile) {
+    perror(pFilename);
+    return false;
+  }
+
+  bool ok = fread(magic, sizeof(magic), 1, pFile) == 1 && magic[0] == 'P' &&
+            magic[1] >= '2' && magic[1] <= '6' && magic[1] != '4';
+  ok = ok && readNumber(pFile, &pImage->width) && readNumber(pFile, &pImage->height) &&
+       readNumber(pFile, &pImage->maxValue) && pImage->maxValue > 0 && pImage->maxValue <= 65535;
+  if (!ok) {
+    fprintf(stderr, "%s isn't a PGM or PPM image.\n", pFilename);
+    fclose(pFile);
+    return false;
+  }
+
+  // The single whitespace character after maxValue has already been read.
+  bool     binary = magic[1] >= '5';
+  uint32_t sampleSize = pImage->maxValue > 255 ? 2 : 1;
+  pImage->channels = (magic[1] == '3' || magic[1] == '6') ? 3 : 1;
+  pImage->samples.resize(pImage->width * pImage->height * pImage->channels);
+  for (size_t i = 0 ; ok && i < pImage->samples.size() ; i++) {
+    uint8_t bytes[2];
+    if (!binary) {
+      ok = readNumber(pFile, &pImage->samples[i]);
+    } else if ((ok = fread(bytes, sampleSize, 1, pFile) == 1)) {
+      pImage->samples[i] = sampleSize == 2 ? (bytes[0] << 8) | bytes[1] : bytes[0];
+    }
+    ok = ok && pImage->samples[i] <= pImage->maxValue;
+  }
+  fclose(pFile);
+  if (!ok) {
+    fprintf(stderr, "%s is truncated or corrupt.\n", pFilename);
+  }
+  return ok;
+}
+
+static uint32_t sample8(const Image& image, uint32_t i)
+{
+  return (image.samples[i] * 255 + image.maxValue / 2) / image.maxValue;
+}
+
+static uint32_t rgb565(const Image& image, uint32_t pixel)
+{
+  uint32_t i = pixel * image.channels;
+  uint32_t r = sample8(image, i);
+  uint32_t g = sample8(image, i + (image.channels == 3 ? 1 : 0));
+  uint32_t b = sample8(image, i + (image.channels == 3 ? 2 : 0));
+  uint32_t p = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+
+  return g_byteSwap ? ((p >> 8) | (p << 8)) & 0xFFFF : p;
+}
+
+
+static Table makeTable(const char* pName, const std::string& heightName, const std::string& widthName,
+                       uint32_t width, uint32_t height, uint32_t entrySize)
+{
+  Table table;
+
+  table.pName = pName;
+  table.heightName = heightName;
+  table.widthName = widthName;
+  table.width = width;
+  table.height = height;
+  table.stride = width;
+  table.entrySize = entrySize;
+  table.alignment = 0;
+  if (g_alignment && !heightName.empty()) {
+    uint32_t rowBytes = (width * entrySize + g_alignment - 1) / g_alignment * g_alignment;
+    table.stride = rowBytes / entrySize;
+    table.alignment = g_alignment;
+  }
+  return table;
+}
+
+static Table colourTable(const char* pName, const char* pHeightName, const char* pWidthName,
+                         const Image& image)
+{
+  Table table = makeTable(pName, pHeightName, pWidthName, image.width, image.height, 2);
+  for (uint32_t i = 0 ; i < image.width * image.height ; i++) {
+    table.values.push_back(rgb565(image, i));
+  }
+  return table;
+}
+
+static Table eyelidTable(const char* pName, const Image& image)
+{
+  Table table = makeTable(pName, "SCREEN_HEIGHT", "SCREEN_WIDTH", image.width, image.height, 1);
+  for (uint32_t i = 0 ; i < image.width * image.height ; i++) {
+    table.values.push_back(sample8(image, i));
+  }
+  return table;
+}
+
+// Angle (0 - 511, clockwise from the left) in the upper 9 bits and distance
+// from the outer edge of the iris (0 - 126) in the lower 7 bits of each pixel
+// of a round iris, with 0x7F outside of it.  Same as the Adafruit
+// tablegen.py which generated the round pupil eyes.
+static Table polarTable(uint32_t diameter)
+{
+  char size[16];
+  snprintf(size, sizeof(size), "%u", diameter);
+  Table  table = makeTable("polar", size, size, diameter, diameter, 2);
+  double radius = diameter / 2.0;
+
+  for (uint32_t y = 0 ; y < diameter ; y++) {
+    double dy = y - radius + 0.5;
+    for (uint32_t x = 0 ; x < diameter ; x++) {
+      double dx = x - radius + 0.5;
+      double distance = sqrt(dx * dx + dy * dy);
+      if (distance >= radius) {
+        table.values.push_back(0x7F);
+        continue;
+      }
+      uint32_t angle = (uint32_t)((atan2(dy, dx) + M_PI) / (2.0 * M_PI) * 512.0) & 511;
+      uint32_t d = 127 - (uint32_t)(distance / radius * 128.0);
+      table.values.push_back((angle << 7) | d);
+    }
+  }
+  return table;
+}
+
+// Replaces a colour table's pixels with indices into a palette of its
+// colours if it has no more than 256 of them.
+static bool paletteTable(Table* pTable, Table* pPalette, const char* pPaletteName,
+                         const char* pSizeName)
+{
+  std::map<uint32_t, uint32_t> indices;
+
+  for (size_t i = 0 ; i < pTable->values.size() ; i++) {
+    indices.insert(std::make_pair(pTable->values[i], 0));
+    if (indices.size() > 256) {
+      return false;
+    }
+  }
+
+  *pPalette = makeTable(pPaletteName, "", pSizeName, indices.size(), 1, 2);
+  for (std::map<uint32_t, uint32_t>::iterator it = indices.begin() ; it != indices.end() ; ++it) {
+    it->second = pPalette->values.size();
+    pPalette->values.push_back(it->first);
+  }
+
+  Table indexed = makeTable(pTable->pName, pTable->heightName, pTable->widthName,
+                            pTable->width, pTable->height, 1);
+  for (size_t i = 0 ; i < pTable->values.size() ; i++) {
+    indexed.values.push_back(indices[pTable->values[i]]);
+  }
+  *pTable = indexed;
+  return true;
+}
+
+// (length, threshold) runs of each row of an eyelid map, with runs split at
+// 255 pixels, and the index of each row's first run plus one past the last.
+static void spanTables(const Table& eyelid, Table* pSpans, Table* pRows,
+                       const char* pSpansName, const char* pRowsName)
+{
+  std::vector<uint32_t> spans;
+  std::vector<uint32_t> rows;
+
+  for (uint32_t y = 0 ; y < eyelid.height ; y++) {
+    const uint32_t* pRow = &eyelid.values[y * eyelid.width];
+    rows.push_back(spans.size() / 2);
+    for (uint32_t x = 0 ; x < eyelid.width ; ) {
+      uint32_t length = 1;
+      while (x + length < eyelid.width && length < 255 && pRow[x + length] == pRow[x]) {
+        length++;
+      }
+      spans.push_back(length);
+      spans.push_back(pRow[x]);
+      x += length;
+    }
+  }
+  rows.push_back(spans.size() / 2);
+
+  char count[16];
+  snprintf(count, sizeof(count), "%u", (uint32_t)spans.size());
+  *pSpans = makeTable(pSpansName, "", count, spans.size(), 1, 1);
+  pSpans->values = spans;
+  *pRows = makeTable(pRowsName, "", "SCREEN_HEIGHT + 1", rows.size(), 1, 2);
+  pRows->values = rows;
+}
+
+
+static void writeDefine(FILE* pOut, const char* pName, const char* pPad, uint32_t value)
+{
+  fprintf(pOut, "#define %s%s%u\n", pName, pPad, value);
+}
+
+static void writeTable(FILE* pOut, const Table& table)
+{
+  const char* pType = table.entrySize == 2 ? "uint16_t" : "uint8_t";
+  const char* pFormat = table.entrySize == 2 ? "0X%04X" : "0X%02X";
+  uint32_t    perLine = table.entrySize == 2 ? 8 : 12;
+  uint32_t    count = table.stride * table.height;
+  std::string dimensions;
+  std::string alignment;
+
+  if (!table.heightName.empty()) {
+    dimensions = "[" + table.heightName + "]";
+  }
+  if (table.stride != table.width) {
+    std::string strideName = table.pName;
+    for (size_t i = 0 ; i < strideName.size() ; i++) {
+      strideName[i] = toupper(strideName[i]);
+    }
+    strideName += "_STRIDE";
+    writeDefine(pOut, strideName.c_str(), " ", table.stride);
+    fprintf(pOut, "\n");
+    dimensions += "[" + strideName + "]";
+  } else {
+    dimensions += "[" + table.widthName + "]";
+  }
+  if (table.alignment) {
+    char attribute[48];
+    snprintf(attribute, sizeof(attribute), " __attribute__((aligned(%u)))", table.alignment);
+    alignment = attribute;
+  }
+
+  fprintf(pOut, "const %s %s%s%s = {\n", pType, table.pName, dimensions.c_str(), alignment.c_str());
+  for (uint32_t i = 0 ; i < count ; i++) {
+    uint32_t x = i % table.stride;
+    uint32_t y = i / table.stride;
+    uint32_t value = x < table.width ? table.values[y * table.width + x] : 0;
+
+    fprintf(pOut, i % perLine == 0 ? "  " : " ");
+    fprintf(pOut, pFormat, value);
+    fprintf(pOut, i == count - 1 ? " };\n" : (i % perLine == perLine - 1 ? ",\n" : ","));
+  }
+}
+
+// The total only includes the tables which eyeRender.h uses when
+// SYMMETRICAL_EYELID isn't defined.
+static void reportTable(const Table& table, const char* pSection = "", bool total = true)
+{
+  char size[16];
+
+  if (total) {
+    g_totalBytes += table.bytes();
+  }
+  snprintf(size, sizeof(size), "%ux%u", table.width, table.height);
+  fprintf(stderr, "%-16s %-9s %9s %5u %7u %8u\n", table.pName, pSection, size, table.entrySize,
+          (table.stride - table.width) * table.height * table.entrySize, table.bytes());
+}
+
+static void writeEyelids(FILE* pOut, const Table& upper, const Table& lower, bool spans,
+                         const char* pSection)
+{
+  const Table* pEyelids[2] = { &upper, &lower };
+  static const char* pSpanNames[2][2] = { { "upperSpans", "upperSpanRows" },
+                                          { "lowerSpans", "lowerSpanRows" } };
+
+  for (int i = 0 ; i < 2 ; i++) {
+    fprintf(pOut, "\n");
+    writeTable(pOut, *pEyelids[i]);
+    reportTable(*pEyelids[i], pSection, !pSection[0]);
+    if (spans) {
+      Table spanTable;
+      Table rowTable;
+      spanTables(*pEyelids[i], &spanTable, &rowTable, pSpanNames[i][0], pSpanNames[i][1]);
+      fprintf(pOut, "\n");
+      writeTable(pOut, spanTable);
+      reportTable(spanTable, pSection, false);
+      fprintf(pOut, "\n");
+      writeTable(pOut, rowTable);
+      reportTable(rowTable, pSection, false);
+    }
+  }
+}
+
+static bool sameSize(const Image& a, const Image& b)
+{
+  return a.width == b.width && a.height == b.height;
+}
+
+static int usage()
+{
+  fprintf(stderr, "Usage: assetCompiler -s sclera.ppm -i iris.ppm -u upper.pgm -l lower.pgm\n"
+                  "                     [-U upper.pgm -L lower.pgm] (-d irisDiameter | -P polar.pgm)\n"
+                  "                     [-m irisMin -M irisMax] [-b] [-p] [-e] [-a alignment]\n"
+                  "                     [-o output.h]\n");
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  const char* pFilenames[128] = { NULL };
+  uint32_t    diameter = 0;
+  uint32_t    irisMin = 0;
+  uint32_t    irisMax = 0;
+  bool        palette = false;
+  bool        spans = false;
+
+  for (int i = 1 ; i < argc ; i++) {
+    if (argv[i][0] != '-' || strlen(argv[i]) != 2) {
+      return usage();
+    }
+    char option = argv[i][1];
+    if (option == 'b') {
+      g_byteSwap = true;
+    } else if (option == 'p') {
+      palette = true;
+    } else if (option == 'e') {
+      spans = true;
+    } else if (i + 1 >= argc) {
+      return usage();
+    } else if (option == 'd') {
+      diameter = strtoul(argv[++i], NULL, 0);
+    } else if (option == 'm') {
+      irisMin = strtoul(argv[++i], NULL, 0);
+    } else if (option == 'M') {
+      irisMax = strtoul(argv[++i], NULL, 0);
+    } else if (option == 'a') {
+      g_alignment = strtoul(argv[++i], NULL, 0);
+    } else if (strchr("siulULPo", option)) {
+      pFilenames[(int)option] = argv[++i];
+    } else {
+      return usage();
+    }
+  }
+  bool symmetrical = pFilenames['U'] || pFilenames['L'];
+  if (!pFilenames['s'] || !pFilenames['i'] || !pFilenames['u'] || !pFilenames['l'] ||
+      (symmetrical && (!pFilenames['U'] || !pFilenames['L'])) ||
+      (diameter == 0) == (pFilenames['P'] == NULL) || (irisMin == 0) != (irisMax == 0) ||
+      irisMin > irisMax || irisMax > 1023 || (g_alignment & 1)) {
+    return usage();
+  }
+
+  Image sclera;
+  Image iris;
+  Image eyelids[4];
+  Image polar;
+  const char* pEyelidOptions = "ulUL";
+  if (!readImage(pFilenames['s'], &sclera) || !readImage(pFilenames['i'], &iris)) {
+    return 1;
+  }
+  for (int i = 0 ; i < (symmetrical ? 4 : 2) ; i++) {
+    const char* pFilename = pFilenames[(int)pEyelidOptions[i]];
+    if (!readImage(pFilename, &eyelids[i])) {
+      return 1;
+    }
+    if (eyelids[i].channels != 1 || !sameSize(eyelids[i], eyelids[0])) {
+      fprintf(stderr, "%s must be a PGM the same size as %s.\n", pFilename, pFilenames['u']);
+      return 1;
+    }
+  }
+  if (pFilenames['P']) {
+    if (!readImage(pFilenames['P'], &polar)) {
+      return 1;
+    }
+    if (polar.channels != 1 || polar.maxValue != 65535 || polar.width != polar.height) {
+      fprintf(stderr, "%s must be a square 16-bit PGM.\n", pFilenames['P']);
+      return 1;
+    }
+    diameter = polar.width;
+  }
+  if (sclera.width < eyelids[0].width || sclera.height < eyelids[0].height || diameter > sclera.width ||
+      diameter > sclera.height) {
+    fprintf(stderr, "%s must be at least as big as the eyelids and the iris.\n", pFilenames['s']);
+    return 1;
+  }
+
+  FILE* pOut = stdout;
+  if (pFilenames['o'] && !(pOut = fopen(pFilenames['o'], "w"))) {
+    perror(pFilenames['o']);
+    return 1;
+  }
+
+  Table scleraTable = colourTable("sclera", "SCLERA_HEIGHT", "SCLERA_WIDTH", sclera);
+  Table irisTable = colourTable("iris", "IRIS_MAP_HEIGHT", "IRIS_MAP_WIDTH", iris);
+  Table scleraPalette;
+  Table irisPalette;
+  bool  scleraIndexed = palette && paletteTable(&scleraTable, &scleraPalette, "scleraPalette",
+                                                "SCLERA_PALETTE_SIZE");
+  bool  irisIndexed = palette && paletteTable(&irisTable, &irisPalette, "irisPalette",
+                                              "IRIS_PALETTE_SIZE");
+  if (palette && !scleraIndexed) {
+    fprintf(stderr, "%s has more than 256 colours so is left as RGB565.\n", pFilenames['s']);
+  }
+  if (palette && !irisIndexed) {
+    fprintf(stderr, "%s has more than 256 colours so is left as RGB565.\n", pFilenames['i']);
+  }
+
+  fprintf(stderr, "%-16s %-9s %9s %5s %7s %8s\n", "table", "", "size", "entry", "padding", "bytes");
+  if (irisMin) {
+    writeDefine(pOut, "IRIS_MIN", irisMin < 100 ? "  " : " ", irisMin);
+    writeDefine(pOut, "IRIS_MAX", " ", irisMax);
+    fprintf(pOut, "\n");
+  }
+  if (g_byteSwap) {
+    fprintf(pOut, "#define RGB565_BYTE_SWAPPED\n\n");
+  }
+
+  writeDefine(pOut, "SCLERA_WIDTH", "  ", sclera.width);
+  writeDefine(pOut, "SCLERA_HEIGHT", " ", sclera.height);
+  fprintf(pOut, "\n");
+  if (scleraIndexed) {
+    writeDefine(pOut, "SCLERA_PALETTE_SIZE", " ", scleraPalette.width);
+    fprintf(pOut, "\n");
+    writeTable(pOut, scleraPalette);
+    reportTable(scleraPalette);
+    fprintf(pOut, "\n");
+  }
+  writeTable(pOut, scleraTable);
+  reportTable(scleraTable);
+
+  fprintf(pOut, "\n");
+  writeDefine(pOut, "IRIS_MAP_WIDTH", "  ", iris.width);
+  writeDefine(pOut, "IRIS_MAP_HEIGHT", " ", iris.height);
+  fprintf(pOut, "\n");
+  if (irisIndexed) {
+    writeDefine(pOut, "IRIS_PALETTE_SIZE", " ", irisPalette.width);
+    fprintf(pOut, "\n");
+    writeTable(pOut, irisPalette);
+    reportTable(irisPalette);
+    fprintf(pOut, "\n");
+  }
+  writeTable(pOut, irisTable);
+  reportTable(irisTable);
+
+  fprintf(pOut, "\n");
+  writeDefine(pOut, "SCREEN_WIDTH", "  ", eyelids[0].width);
+  writeDefine(pOut, "SCREEN_HEIGHT", " ", eyelids[0].height);
+  if (symmetrical) {
+    fprintf(pOut, "\n#ifdef SYMMETRICAL_EYELID\n");
+    writeEyelids(pOut, eyelidTable("upper", eyelids[2]), eyelidTable("lower", eyelids[3]), spans,
+                 "symmetric");
+    fprintf(pOut, "\n#else\n");
+  }
+  writeEyelids(pOut, eyelidTable("upper", eyelids[0]), eyelidTable("lower", eyelids[1]), spans, "");
+  if (symmetrical) {
+    fprintf(pOut, "\n#endif // SYMMETRICAL_EYELID\n");
+  }
+
+  fprintf(pOut, "\n");
+  writeDefine(pOut, "IRIS_WIDTH", "  ", diameter);
+  writeDefine(pOut, "IRIS_HEIGHT", " ", diameter);
+  fprintf(pOut, "\n");
+  Table polarOut = polarTable(diameter);
+  if (pFilenames['P']) {
+    polarOut.values = polar.samples;
+  }
+  writeTable(pOut, polarOut);
+  reportTable(polarOut);
+
+  fprintf(stderr, "%-16s %-9s %9s %5s %7s %8u\n", "total", "", "", "", "", g_totalBytes);
+  if (pOut != stdout) {
+    fclose(pOut);
+  }
+  return 0;
+}
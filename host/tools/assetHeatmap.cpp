@@ -0,0 +1,279 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Profiles which entries of the sclera, iris, polar, upper and lower tables
+// (and the palettes of eyes from assetCompiler -p) are read, and how often,
+// while the firmware animates the eyes.
+//
+// The firmware is run against the mbed HAL shim as in dragonEyes.cpp, with
+// DRAW_EYE_HOOK reporting the inputs of every drawEye() call.  Each frame is
+// then rendered again by the counted kernel of the same eye from the
+// drawEyeBench objects, which counts the loads of every table entry.  Iris
+// loads are also split by iScale into quarters of the IRIS_MIN - IRIS_MAX
+// range.
+//
+// A summary of each table is printed: how much of it was never read (and so
+// never needs to be in flash or SRAM at all) and how much of it takes 90% of
+// the loads.  Heatmaps of the load counts can also be written as PPM images,
+// log scaled from black through red and yellow to white with never read
+// entries in blue.
+//
+// Usage: assetHeatmap [-e eyeName] [-s] [hours] [outputDir]
+//   -e eyeName  Eye to profile (default is the one enabled in config.h).
+//   -s          Use its SYMMETRICAL_EYELID tables.
+//   hours       Virtual time to run for (default 1).
+//   outputDir   If given, writes <eyeName>-<table>.ppm and
+//               <eyeName>-iris<quarter>.ppm heatmaps to this directory.
+#include <mbed.h>
+#include <EyeAsset.h>
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+
+#define IRIS_RANGES 4
+
+// Size of each FlashTable's entries in the graphics headers.
+static const uint32_t g_entrySize[FLASH_TABLE_COUNT] = { 2, 2, 2, 1, 1, 2 };
+static const char*    g_tableNames[FLASH_TABLE_COUNT] = { "sclera", "iris", "polar", "upper", "lower", "palette" };
+
+
+// main() from ../src/main.cpp, renamed by the Makefile.
+int dragonEyesMain();
+
+
+static const EyeAsset*       g_pAsset;
+static RenderCounts          g_counts;
+static std::vector<uint32_t> g_heatmaps[FLASH_TABLE_COUNT];
+static std::vector<uint32_t> g_irisHeatmaps[IRIS_RANGES];
+static uint64_t              g_irisFrames[IRIS_RANGES];
+
+static uint32_t irisRange(uint16_t iScale)
+{
+  if (iScale <= g_pAsset->irisMin) {
+    return 0;
+  }
+  uint32_t range = (iScale - g_pAsset->irisMin) * IRIS_RANGES / (g_pAsset->irisMax - g_pAsset->irisMin + 1);
+  return range < IRIS_RANGES ? range : IRIS_RANGES - 1;
+}
+
+void drawEyeHook(uint8_t e, uint16_t iScale, uint8_t scleraX, uint8_t scleraY, uint8_t uT, uint8_t lT)
+{
+  uint32_t* ppHeatmaps[FLASH_TABLE_COUNT];
+  uint32_t  range = irisRange(iScale);
+
+  for (int i = 0 ; i < FLASH_TABLE_COUNT ; i++) {
+    ppHeatmaps[i] = g_heatmaps[i].data();
+  }
+  ppHeatmaps[FLASH_IRIS] = g_irisHeatmaps[range].data();
+  g_irisFrames[range]++;
+
+  g_pAsset->count(&g_counts, ppHeatmaps, iScale, scleraX, scleraY, uT, lT);
+}
+
+
+static const EyeAsset* findAsset(const char* pName, bool symmetrical)
+{
+  for (const EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    if (strcmp(pAsset->pName, pName) == 0 && pAsset->symmetrical == symmetrical) {
+      return pAsset;
+    }
+  }
+  return NULL;
+}
+
+// Smallest number of entries which account for percent of the loads.
+static uint32_t hotEntries(const std::vector<uint32_t>& heatmap, uint32_t percent)
+{
+  std::vector<uint32_t> sorted(heatmap);
+  uint64_t              total = 0;
+  uint64_t              sum = 0;
+  uint32_t              count = 0;
+
+  std::sort(sorted.begin(), sorted.end(), std::greater<uint32_t>());
+  for (size_t i = 0 ; i < sorted.size() ; i++) {
+    total += sorted[i];
+  }
+  while (count < sorted.size() && sum * 100 < total * percent) {
+    sum += sorted[count++];
+  }
+  return count;
+}
+
+static uint32_t unreadEntries(const std::vector<uint32_t>& heatmap)
+{
+  return std::count(heatmap.begin(), heatmap.end(), 0);
+}
+
+static bool writeHeatmap(const char* pDir, const char* pName, const std::vector<uint32_t>& heatmap,
+                         uint32_t width, uint32_t height)
+{
+  char  filename[256];
+  FILE* pFile;
+
+  snprintf(filename, sizeof(filename), "%s/%s-%s.ppm", pDir, g_pAsset->pName, pName);
+  pFile = fopen(filename, "wb");
+  if (!pFile) {
+    perror(filename);
+    return false;
+  }
+
+  uint32_t maxCount = *std::max_element(heatmap.begin(), heatmap.end());
+  double   scale = maxCount > 1 ? 3.0 / log((double)maxCount) : 0.0;
+  fprintf(pFile, "P6\n%u %u\n255\n", width, height);
+  for (size_t i = 0 ; i < heatmap.size() ; i++) {
+    uint8_t rgb[3] = { 0, 0, 160 };
+    if (heatmap[i]) {
+      // 0.0 - 3.0 for black -> red -> yellow -> white.
+      double level = log((double)heatmap[i]) * scale;
+      for (int c = 0 ; c < 3 ; c++) {
+        double channel = level - c;
+        rgb[c] = channel <= 0.0 ? 0 : channel >= 1.0 ? 255 : (uint8_t)(channel * 255.0);
+      }
+    }
+    fwrite(rgb, sizeof(rgb), 1, pFile);
+  }
+  fclose(pFile);
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  const char* pName = CONFIG_EYE;
+  bool        symmetrical = CONFIG_SYMMETRICAL;
+  double      hours = 1.0;
+  const char* pDir = NULL;
+  int         positional = 0;
+
+  for (int i = 1 ; i < argc ; i++) {
+    if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      pName = argv[++i];
+    } else if (strcmp(argv[i], "-s") == 0) {
+      symmetrical = true;
+    } else if (argv[i][0] != '-' && positional == 0) {
+      hours = strtod(argv[i], NULL);
+      positional++;
+    } else if (argv[i][0] != '-' && positional == 1) {
+      pDir = argv[i];
+      positional++;
+    } else {
+      hours = 0.0;
+      break;
+    }
+  }
+  if (hours <= 0.0) {
+    fprintf(stderr, "Usage: assetHeatmap [-e eyeName] [-s] [hours] [outputDir]\n");
+    return 1;
+  }
+
+  g_pAsset = findAsset(pName, symmetrical);
+  if (!g_pAsset) {
+    fprintf(stderr, "%s isn't one of the eyes in ../src/graphics.\n", pName);
+    return 1;
+  }
+  for (int i = 0 ; i < FLASH_TABLE_COUNT ; i++) {
+    g_heatmaps[i].resize(g_pAsset->tableWidth[i] * g_pAsset->tableHeight[i]);
+  }
+  for (int r = 0 ; r < IRIS_RANGES ; r++) {
+    g_irisHeatmaps[r].resize(g_heatmaps[FLASH_IRIS].size());
+  }
+
+  mbedHost::setTimeLimit((uint64_t)(hours * 3600.0 * 1000000000.0));
+  try {
+    dragonEyesMain();
+  } catch (mbedHost::TimeLimit&) {
+  }
+
+  for (int r = 0 ; r < IRIS_RANGES ; r++) {
+    for (size_t i = 0 ; i < g_heatmaps[FLASH_IRIS].size() ; i++) {
+      g_heatmaps[FLASH_IRIS][i] += g_irisHeatmaps[r][i];
+    }
+  }
+
+  printf("\n%s%s: %llu frames in %.2f hours of virtual time.\n",
+         g_pAsset->pName, g_pAsset->symmetrical ? " (SYMMETRICAL_EYELID)" : "",
+         (unsigned long long)g_counts.frames, mbedHost::now() / 3600000000000.0);
+  printf("%-7s %9s %7s %11s %7s %12s %9s\n",
+         "table", "size", "bytes", "loads/frame", "unread", "unread bytes", "90% loads");
+  for (int t = 0 ; t < FLASH_TABLE_COUNT ; t++) {
+    const std::vector<uint32_t>& heatmap = g_heatmaps[t];
+    uint32_t                     entries = heatmap.size();
+    uint32_t                     unread = unreadEntries(heatmap);
+    char                         size[16];
+
+    if (entries == 0) {
+      continue;
+    }
+    snprintf(size, sizeof(size), "%ux%u", g_pAsset->tableWidth[t], g_pAsset->tableHeight[t]);
+    printf("%-7s %9s %7u %11.0f %6.1f%% %12u %8.1f%%\n",
+           g_tableNames[t], size, entries * g_entrySize[t],
+           g_counts.frames ? (double)g_counts.flashLoads[t] / g_counts.frames : 0.0,
+           100.0 * unread / entries, unread * g_entrySize[t],
+           100.0 * hotEntries(heatmap, 90) / entries);
+  }
+
+  // Iris rows are distances from the edge of the iris, so which rows are
+  // read depends on how far the iris is scaled.
+  printf("\n%-13s %9s %13s %15s\n", "iScale", "frames", "rows read", "90% loads rows");
+  for (int r = 0 ; r < IRIS_RANGES ; r++) {
+    uint32_t              width = g_pAsset->tableWidth[FLASH_IRIS];
+    uint32_t              height = g_pAsset->tableHeight[FLASH_IRIS];
+    std::vector<uint32_t> rowLoads(height);
+    int                   first = -1;
+    int                   last = -1;
+
+    for (uint32_t y = 0 ; y < height ; y++) {
+      for (uint32_t x = 0 ; x < width ; x++) {
+        rowLoads[y] += g_irisHeatmaps[r][y * width + x];
+      }
+      if (rowLoads[y]) {
+        first = first < 0 ? y : first;
+        last = y;
+      }
+    }
+
+    uint32_t rangeSize = g_pAsset->irisMax - g_pAsset->irisMin + 1;
+    char     rows[32] = "none";
+    char     range[32];
+    snprintf(range, sizeof(range), "%u-%u", g_pAsset->irisMin + rangeSize * r / IRIS_RANGES,
+             g_pAsset->irisMin + rangeSize * (r + 1) / IRIS_RANGES - 1);
+    if (first >= 0) {
+      snprintf(rows, sizeof(rows), "%d-%d", first, last);
+    }
+    printf("%-13s %9llu %13s %15u\n", range, (unsigned long long)g_irisFrames[r], rows,
+           hotEntries(rowLoads, 90));
+  }
+
+  if (pDir) {
+    for (int t = 0 ; t < FLASH_TABLE_COUNT ; t++) {
+      if (!g_heatmaps[t].empty() &&
+          !writeHeatmap(pDir, g_tableNames[t], g_heatmaps[t],
+                        g_pAsset->tableWidth[t], g_pAsset->tableHeight[t])) {
+        return 1;
+      }
+    }
+    for (int r = 0 ; r < IRIS_RANGES ; r++) {
+      char name[16];
+      snprintf(name, sizeof(name), "iris%d", r);
+      if (!writeHeatmap(pDir, name, g_irisHeatmaps[r],
+                        g_pAsset->tableWidth[FLASH_IRIS], g_pAsset->tableHeight[FLASH_IRIS])) {
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
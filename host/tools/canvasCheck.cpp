@@ -0,0 +1,640 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Checks the span fills, dirty row tracking, blits and clipping which the
+// GFXcanvas classes and the SSD1351 driver add to Adafruit_GFX against
+// reference images drawn a pixel at a time.
+//
+// Each check draws the same pseudo random primitives, many of them partly
+// off screen, into the code under test and into a RefDisplay.  That is an
+// Adafruit_GFX with nothing but drawPixel(), so every primitive falls back to
+// Adafruit's per pixel code.  What reaches the SSD1351 is read back through
+// an SSD1351Emulator.  One line is printed per check.
+//
+// Usage: canvasCheck
+//
+// Exits with a non-zero status if any check fails.
+#include <mbed.h>
+#include <SSD1351.h>
+#include <SSD1351Emulator.h>
+#include <GlyphCache.h>
+#include <EyeRandom.h>
+#include <vector>
+
+
+// Same as the pins in config.h.
+#define OLED_MOSI_PIN     p5
+#define OLED_SCK_PIN      p7
+#define OLED_DC_PIN       p6
+#define OLED_RST_PIN      p8
+#define OLED_LEFT_CS_PIN  p9
+#define OLED_WIDTH        128
+#define OLED_HEIGHT       128
+
+// Primitive sequences drawn in each rotation by the fill checks.
+#define SEEDS             100
+
+
+// Pixels set only through drawPixel(), kept unrotated like a GFXcanvas16's
+// buffer.
+class RefDisplay : public Adafruit_GFX
+{
+  public:
+    RefDisplay(int16_t w, int16_t h) : Adafruit_GFX(w, h), m_pixels(w * h, 0) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color)
+    {
+      if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        return;
+      }
+      int16_t t;
+      switch (rotation) {
+      case 1:
+        t = x;
+        x = WIDTH - 1 - y;
+        y = t;
+        break;
+      case 2:
+        x = WIDTH - 1 - x;
+        y = HEIGHT - 1 - y;
+        break;
+      case 3:
+        t = x;
+        x = y;
+        y = HEIGHT - 1 - t;
+        break;
+      }
+      m_pixels[y * WIDTH + x] = color;
+    }
+
+    const uint16_t* pixels() const { return &m_pixels[0]; }
+
+  protected:
+    std::vector<uint16_t> m_pixels;
+};
+
+
+// Draws count random primitives, in colors with only the bits of colorMask
+// (the depth of the canvas being checked).
+template<class Display>
+static void drawPrimitives(Display* pDisplay, uint32_t seed, int count, uint16_t colorMask)
+{
+  EyeRandom random(seed);
+  uint8_t   bitmap[8 * 20];
+
+  for (int i = 0 ; i < count ; i++) {
+    uint16_t color = random.next() & colorMask;
+    uint16_t bg = random.next() & colorMask;
+    int      w = pDisplay->width() + 40;
+    int      h = pDisplay->height() + 40;
+    int16_t  x0 = random.below(w) - 20, y0 = random.below(h) - 20;
+    int16_t  x1 = random.below(w) - 20, y1 = random.below(h) - 20;
+    int16_t  x2 = random.below(w) - 20, y2 = random.below(h) - 20;
+
+    switch (random.below(12)) {
+    case 0:
+      pDisplay->drawPixel(x0, y0, color);
+      break;
+    case 1:
+      pDisplay->drawFastHLine(x0, y0, random.below(w) - 10, color);
+      break;
+    case 2:
+      pDisplay->drawFastVLine(x0, y0, random.below(h) - 10, color);
+      break;
+    case 3:
+      pDisplay->fillRect(x0, y0, random.below(w) - 10, random.below(h) - 10, color);
+      break;
+    case 4:
+      pDisplay->drawLine(x0, y0, x1, y1, color);
+      break;
+    case 5:
+      pDisplay->fillCircle(x0, y0, random.below(40), color);
+      break;
+    case 6:
+      pDisplay->drawCircle(x0, y0, random.below(40), color);
+      break;
+    case 7:
+      pDisplay->fillTriangle(x0, y0, x1, y1, x2, y2, color);
+      break;
+    case 8:
+      pDisplay->fillRoundRect(x0, y0, random.below(w), random.below(h), random.below(10), color);
+      break;
+    case 9:
+      pDisplay->setCursor(x0, y0);
+      pDisplay->setTextColor(color, bg);
+      pDisplay->setTextSize(1 + random.below(3));
+      pDisplay->print("Hi!");
+      break;
+    case 10:
+      for (size_t j = 0 ; j < sizeof(bitmap) ; j++) {
+        bitmap[j] = random.next();
+      }
+      if (random.below(2)) {
+        pDisplay->drawBitmap(x0, y0, bitmap, 60, 20, color, bg);
+      } else {
+        pDisplay->drawBitmap(x0, y0, bitmap, 60, 20, color);
+      }
+      break;
+    case 11:
+      if (random.below(8) == 0) {
+        pDisplay->fillScreen(color);
+      }
+      break;
+    }
+  }
+}
+
+// Prints a line of random text through a GlyphCache, as the overlay does.
+template<class Display>
+static void drawCachedText(Display* pDisplay, uint32_t seed, uint16_t colorMask)
+{
+  static GlyphCache glyphCache;
+  EyeRandom         random(seed + 1);
+
+  pDisplay->setCursor(random.below(pDisplay->width()) - 20, random.below(pDisplay->height()) - 5);
+  glyphCache.setTextColor(random.next() & colorMask, random.next() & colorMask);
+  glyphCache.setTextSize(1 + random.below(2));
+  glyphCache.print(pDisplay, "Cached 123");
+}
+
+static bool report(const char* pName, int cases, int failures)
+{
+  printf("%-32s %5d cases  %s\n", pName, cases, failures ? "FAILED" : "ok");
+  return failures == 0;
+}
+
+
+// GFXcanvas16 of random sizes in every rotation against a RefDisplay.
+static bool checkCanvas16Fills()
+{
+  int failures = 0;
+
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    for (uint32_t seed = 1 ; seed <= SEEDS ; seed++) {
+      EyeRandom   random(seed);
+      int16_t     w = 1 + random.below(130);
+      int16_t     h = 1 + random.below(130);
+      GFXcanvas16 canvas(w, h);
+      RefDisplay  ref(w, h);
+
+      canvas.setRotation(rotation);
+      ref.setRotation(rotation);
+      drawPrimitives(&canvas, seed, 60, 0xFFFF);
+      drawPrimitives(&ref, seed, 60, 0xFFFF);
+      if (memcmp(canvas.getBuffer(), ref.pixels(), w * h * sizeof(uint16_t)) != 0) {
+        printf("GFXcanvas16 %dx%d rotation %u seed %u differs.\n", w, h, rotation, seed);
+        failures++;
+      }
+    }
+  }
+  return report("GFXcanvas16 span fills", 4 * SEEDS, failures);
+}
+
+// A few primitives are drawn into a GFXcanvas16 each frame and flush()ed to
+// the SSD1351, which must then match a full drawRGBBitmap() of the canvas.
+// That only holds if markDirty() covered every pixel which changed.  Every so
+// often the screen is cleared and the canvas moved, so that invalidate() has
+// to resend all of it.
+static bool checkCanvas16Flush(SSD1351* pDisplay, SSD1351Emulator* pEmulator)
+{
+  GFXcanvas16 canvas(96, 80);
+  int16_t     x = 0, y = 0;
+  uint64_t    flushBytes = 0, fullBytes = 0;
+  int         frames = 200, failures = 0;
+
+  for (int frame = 0 ; frame < frames ; frame++) {
+    EyeRandom random(frame);
+    canvas.setRotation(random.below(4));
+    drawPrimitives(&canvas, 1000 + frame, frame % 10 == 0 ? 20 : 2, 0xFFFF);
+    if (frame % 16 == 0) {
+      x = random.below(60) - 10;
+      y = random.below(70) - 10;
+      pDisplay->fillScreen(random.next());
+      canvas.invalidate();
+    }
+
+    uint64_t start = mbedHost::spiWriteCount();
+    canvas.flush(pDisplay, x, y);
+    flushBytes += mbedHost::spiWriteCount() - start;
+    uint32_t crc = pEmulator->viewCrc();
+
+    start = mbedHost::spiWriteCount();
+    pDisplay->drawRGBBitmap(x, y, canvas.getBuffer(), 96, 80);
+    fullBytes += mbedHost::spiWriteCount() - start;
+    if (crc != pEmulator->viewCrc()) {
+      printf("GFXcanvas16 flush() of frame %d left the screen wrong.\n", frame);
+      failures++;
+    }
+
+    // Nothing has changed since, so this shouldn't send anything.
+    start = mbedHost::spiWriteCount();
+    canvas.flush(pDisplay, x, y);
+    if (mbedHost::spiWriteCount() != start) {
+      printf("GFXcanvas16 flush() of frame %d repeated itself.\n", frame);
+      failures++;
+    }
+  }
+  bool ok = report("GFXcanvas16 flush()/invalidate()", frames, failures);
+  printf("  %llu SPI bytes flushed vs %llu for full redraws.\n",
+         (unsigned long long)flushBytes, (unsigned long long)fullBytes);
+  return ok;
+}
+
+
+// Whether pixel (x, y) of a GFXcanvas1's unrotated buffer is set.
+static bool canvas1Bit(const GFXcanvas1* pCanvas, int16_t w, int16_t x, int16_t y)
+{
+  return pCanvas->getBuffer()[y * ((w + 7) / 8) + x / 8] & (0x80 >> (x & 7));
+}
+
+// GFXcanvas1 of random sizes in every rotation against a RefDisplay drawn in
+// colors 0 and 1.
+static bool checkCanvas1Fills()
+{
+  int failures = 0;
+
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    for (uint32_t seed = 1 ; seed <= SEEDS ; seed++) {
+      EyeRandom  random(seed);
+      int16_t    w = 1 + random.below(130);
+      int16_t    h = 1 + random.below(130);
+      GFXcanvas1 canvas(w, h);
+      RefDisplay ref(w, h);
+
+      canvas.setRotation(rotation);
+      ref.setRotation(rotation);
+      drawPrimitives(&canvas, seed, 60, 0x0001);
+      drawPrimitives(&ref, seed, 60, 0x0001);
+      for (int32_t i = 0 ; i < w * h ; i++) {
+        if (canvas1Bit(&canvas, w, i % w, i / w) != (ref.pixels()[i] != 0)) {
+          printf("GFXcanvas1 %dx%d rotation %u seed %u differs.\n", w, h, rotation, seed);
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+  return report("GFXcanvas1 span fills", 4 * SEEDS, failures);
+}
+
+// Both blit()s of a GFXcanvas1, at places partly off the SSD1351 in each of
+// its rotations, against drawPixel() for each pixel of the canvas.
+static bool checkCanvas1Blit(SSD1351* pDisplay, SSD1351Emulator* pEmulator)
+{
+  static const int16_t places[][2] = { { 10, 10 }, { -7, 20 }, { 100, 90 }, { -20, -9 }, { 60, -30 } };
+  const int16_t        w = 70, h = 50;
+  GFXcanvas1           canvas(w, h);
+  int                  cases = 0, failures = 0;
+
+  drawPrimitives(&canvas, 1, 40, 0x0001);
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    pDisplay->setRotation(rotation);
+    for (size_t i = 0 ; i < sizeof(places) / sizeof(places[0]) ; i++, cases++) {
+      int16_t x = places[i][0], y = places[i][1];
+
+      pDisplay->fillScreen(0x1234);
+      canvas.blit(pDisplay, x, y, 0xF800, 0x001F);
+      canvas.blit(pDisplay, y, x, 0x07E0);
+      uint32_t crc = pEmulator->viewCrc();
+
+      pDisplay->fillScreen(0x1234);
+      for (int16_t j = 0 ; j < h ; j++) {
+        for (int16_t k = 0 ; k < w ; k++) {
+          pDisplay->drawPixel(x + k, y + j, canvas1Bit(&canvas, w, k, j) ? 0xF800 : 0x001F);
+        }
+      }
+      for (int16_t j = 0 ; j < h ; j++) {
+        for (int16_t k = 0 ; k < w ; k++) {
+          if (canvas1Bit(&canvas, w, k, j)) {
+            pDisplay->drawPixel(y + k, x + j, 0x07E0);
+          }
+        }
+      }
+      if (crc != pEmulator->viewCrc()) {
+        printf("GFXcanvas1 blit() to (%d,%d) in rotation %u differs.\n", x, y, rotation);
+        failures++;
+      }
+    }
+  }
+  pDisplay->setRotation(0);
+  return report("GFXcanvas1 blit()", cases, failures);
+}
+
+// GFXcanvas8 of random sizes in every rotation against a RefDisplay drawn in
+// 8-bit colors.
+static bool checkCanvas8Fills()
+{
+  int failures = 0;
+
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    for (uint32_t seed = 1 ; seed <= SEEDS ; seed++) {
+      EyeRandom  random(seed);
+      int16_t    w = 1 + random.below(130);
+      int16_t    h = 1 + random.below(130);
+      GFXcanvas8 canvas(w, h);
+      RefDisplay ref(w, h);
+
+      canvas.setRotation(rotation);
+      ref.setRotation(rotation);
+      drawPrimitives(&canvas, seed, 60, 0x00FF);
+      drawPrimitives(&ref, seed, 60, 0x00FF);
+      for (int32_t i = 0 ; i < w * h ; i++) {
+        if (canvas.getBuffer()[i] != ref.pixels()[i]) {
+          printf("GFXcanvas8 %dx%d rotation %u seed %u differs.\n", w, h, rotation, seed);
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+  return report("GFXcanvas8 span fills", 4 * SEEDS, failures);
+}
+
+// SSD1351::drawCanvas() of a GFXcanvas8 in each of its rotations, at places
+// partly off the SSD1351 in each of its rotations, against drawPixel() of the
+// palette color for each pixel of the canvas.
+static bool checkDrawCanvas(SSD1351* pDisplay, SSD1351Emulator* pEmulator)
+{
+  static const int16_t places[][2] = { { 10, 10 }, { -7, 20 }, { 100, 90 }, { -20, -9 } };
+  const int16_t        w = 70, h = 50;
+  GFXcanvas8           canvas(w, h);
+  uint16_t             palette[256];
+  EyeRandom            random(8);
+  int                  cases = 0, failures = 0;
+
+  for (int i = 0 ; i < 256 ; i++) {
+    palette[i] = random.next();
+  }
+  for (uint8_t canvasRotation = 0 ; canvasRotation < 4 ; canvasRotation++) {
+    canvas.setRotation(canvasRotation);
+    drawPrimitives(&canvas, 1 + canvasRotation, 20, 0x00FF);
+    for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+      pDisplay->setRotation(rotation);
+      for (size_t i = 0 ; i < sizeof(places) / sizeof(places[0]) ; i++, cases++) {
+        int16_t x = places[i][0], y = places[i][1];
+
+        pDisplay->fillScreen(0x1234);
+        pDisplay->drawCanvas(x, y, &canvas, palette);
+        uint32_t crc = pEmulator->viewCrc();
+
+        // The buffer is drawn as it is, whatever the canvas's rotation.
+        pDisplay->fillScreen(0x1234);
+        for (int16_t j = 0 ; j < h ; j++) {
+          for (int16_t k = 0 ; k < w ; k++) {
+            pDisplay->drawPixel(x + k, y + j, palette[canvas.getBuffer()[j * w + k]]);
+          }
+        }
+        if (crc != pEmulator->viewCrc()) {
+          printf("drawCanvas() of rotation %u to (%d,%d) in rotation %u differs.\n",
+                 canvasRotation, x, y, rotation);
+          failures++;
+        }
+      }
+    }
+  }
+  pDisplay->setRotation(0);
+  return report("SSD1351 drawCanvas()", cases, failures);
+}
+
+// SSD1351::drawWireBitmap() of a byte swapped GFXcanvas16, at places partly
+// off the SSD1351 in each of its rotations, against drawRGBBitmap() of the
+// canvas before it was swapped.  Both have to send the same number of bytes.
+// Then pushWireColors() against pushColor() into a window from
+// setAddrWindow().
+static bool checkWirePixels(SSD1351* pDisplay, SSD1351Emulator* pEmulator)
+{
+  static const int16_t places[][2] = { { 10, 10 }, { -7, 20 }, { 100, 90 }, { -20, -9 }, { 0, 90 } };
+  const int16_t        w = 60, h = 45;
+  GFXcanvas16          canvas(w, h);
+  std::vector<uint16_t> native(w * h);
+  int                  cases = 0, failures = 0;
+
+  drawPrimitives(&canvas, 49, 30, 0xFFFF);
+  memcpy(&native[0], canvas.getBuffer(), w * h * sizeof(uint16_t));
+  canvas.byteSwap();
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    pDisplay->setRotation(rotation);
+    for (size_t i = 0 ; i < sizeof(places) / sizeof(places[0]) ; i++, cases++) {
+      int16_t x = places[i][0], y = places[i][1];
+
+      pDisplay->fillScreen(0x1111);
+      uint64_t start = mbedHost::spiWriteCount();
+      pDisplay->drawWireBitmap(x, y, canvas.getBuffer(), w, h);
+      uint64_t wireBytes = mbedHost::spiWriteCount() - start;
+      uint32_t crc = pEmulator->viewCrc();
+
+      pDisplay->fillScreen(0x1111);
+      start = mbedHost::spiWriteCount();
+      pDisplay->drawRGBBitmap(x, y, &native[0], w, h);
+      if (crc != pEmulator->viewCrc() || wireBytes != mbedHost::spiWriteCount() - start) {
+        printf("drawWireBitmap() to (%d,%d) in rotation %u differs.\n", x, y, rotation);
+        failures++;
+      }
+    }
+
+    pDisplay->fillScreen(0x1111);
+    pDisplay->setAddrWindow(20, 30, 20 + w - 1, 30 + h - 1);
+    pDisplay->pushWireColors(canvas.getBuffer(), w * h);
+    uint32_t crc = pEmulator->viewCrc();
+    pDisplay->fillScreen(0x1111);
+    pDisplay->setAddrWindow(20, 30, 20 + w - 1, 30 + h - 1);
+    for (int32_t j = 0 ; j < w * h ; j++) {
+      pDisplay->pushColor(native[j]);
+    }
+    if (crc != pEmulator->viewCrc()) {
+      printf("pushWireColors() in rotation %u differs.\n", rotation);
+      failures++;
+    }
+    cases++;
+  }
+  pDisplay->setRotation(0);
+  return report("SSD1351 wire order pixels", cases, failures);
+}
+
+
+// Pixel (x, y) of a canvas's unrotated buffer, as RefDisplay would hold it.
+static uint16_t canvasPixel(const GFXcanvas16* pCanvas, int16_t w, int16_t x, int16_t y)
+{
+  return pCanvas->getBuffer()[y * w + x];
+}
+
+static uint16_t canvasPixel(const GFXcanvas8* pCanvas, int16_t w, int16_t x, int16_t y)
+{
+  return pCanvas->getBuffer()[y * w + x];
+}
+
+static uint16_t canvasPixel(const GFXcanvas1* pCanvas, int16_t w, int16_t x, int16_t y)
+{
+  return canvas1Bit(pCanvas, w, x, y);
+}
+
+// What a display of w x h in rotation should hold after drawing pRef's
+// primitives over bg with its clip rectangle set to (clipX, clipY, clipW,
+// clipH): pRef's pixels inside the part of that rectangle on the display and
+// bg everywhere else.  Unrotated, like RefDisplay::pixels().
+static std::vector<uint16_t> clippedPixels(const RefDisplay* pRef, int16_t w, int16_t h, uint8_t rotation,
+                                           int16_t clipX, int16_t clipY, int16_t clipW, int16_t clipH,
+                                           uint16_t bg)
+{
+  RefDisplay            mask(w, h);
+  std::vector<uint16_t> pixels(pRef->pixels(), pRef->pixels() + w * h);
+
+  mask.setRotation(rotation);
+  mask.fillRect(clipX, clipY, clipW, clipH, 1);
+  for (int32_t i = 0 ; i < w * h ; i++) {
+    if (!mask.pixels()[i]) {
+      pixels[i] = bg;
+    }
+  }
+  return pixels;
+}
+
+// Draws seed's primitives, and a line through a GlyphCache, within a viewport
+// nested inside a larger one.
+template<class Display>
+static void drawClipped(Display* pDisplay, uint32_t seed, uint16_t colorMask,
+                        int16_t clipX, int16_t clipY, int16_t clipW, int16_t clipH)
+{
+  GFXviewport outer(pDisplay, clipX - 5, clipY - 5, clipW + 10, clipH + 10);
+  GFXviewport inner(pDisplay, clipX, clipY, clipW, clipH);
+  drawPrimitives(pDisplay, seed, 30, colorMask);
+  drawCachedText(pDisplay, seed, colorMask);
+}
+
+// Draws seed's primitives unclipped into pRef, the same as drawClipped().
+static void drawUnclipped(RefDisplay* pRef, uint32_t seed, uint16_t colorMask)
+{
+  drawPrimitives(pRef, seed, 30, colorMask);
+  drawCachedText(pRef, seed, colorMask);
+}
+
+// The clip rectangle of pDisplay has to be the whole display once the
+// viewports are out of scope.
+static bool isClipReset(const Adafruit_GFX* pDisplay)
+{
+  int16_t x, y, w, h;
+
+  pDisplay->getClipRect(&x, &y, &w, &h);
+  return x == 0 && y == 0 && w == pDisplay->width() && h == pDisplay->height();
+}
+
+// Canvases of random sizes in every rotation, drawn inside GFXviewports
+// partly off the canvas, against a RefDisplay drawn without a clip.
+template<class Canvas>
+static bool checkCanvasClip(const char* pName, uint16_t colorMask)
+{
+  int failures = 0;
+
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    for (uint32_t seed = 1 ; seed <= SEEDS ; seed++) {
+      EyeRandom  random(seed);
+      int16_t    w = 1 + random.below(130);
+      int16_t    h = 1 + random.below(130);
+      Canvas     canvas(w, h);
+      RefDisplay ref(w, h);
+      uint16_t   bg = random.next() & colorMask;
+
+      canvas.setRotation(rotation);
+      ref.setRotation(rotation);
+      int16_t clipX = random.below(canvas.width() + 20) - 10;
+      int16_t clipY = random.below(canvas.height() + 20) - 10;
+      int16_t clipW = random.below(canvas.width());
+      int16_t clipH = random.below(canvas.height());
+
+      canvas.fillScreen(bg);
+      ref.fillScreen(bg);
+      drawClipped(&canvas, seed, colorMask, clipX, clipY, clipW, clipH);
+      drawUnclipped(&ref, seed, colorMask);
+      if (!isClipReset(&canvas)) {
+        printf("%s rotation %u seed %u kept its viewport.\n", pName, rotation, seed);
+        failures++;
+      }
+
+      std::vector<uint16_t> expected = clippedPixels(&ref, w, h, rotation, clipX, clipY, clipW, clipH, bg);
+      for (int32_t i = 0 ; i < w * h ; i++) {
+        if (canvasPixel(&canvas, w, i % w, i / w) != expected[i]) {
+          printf("%s %dx%d rotation %u seed %u differs.\n", pName, w, h, rotation, seed);
+          failures++;
+          break;
+        }
+      }
+    }
+  }
+  return report(pName, 4 * SEEDS, failures);
+}
+
+// The same on the SSD1351 in each of its rotations, where the expected image
+// is sent with drawRGBBitmap() and compared through the emulator.
+static bool checkDisplayClip(SSD1351* pDisplay, SSD1351Emulator* pEmulator)
+{
+  int cases = 0, failures = 0;
+
+  for (uint8_t rotation = 0 ; rotation < 4 ; rotation++) {
+    pDisplay->setRotation(rotation);
+    for (uint32_t seed = 1 ; seed <= SEEDS / 4 ; seed++, cases++) {
+      EyeRandom  random(seed);
+      RefDisplay ref(OLED_WIDTH, OLED_HEIGHT);
+      uint16_t   bg = random.next();
+      int16_t    clipX = random.below(OLED_WIDTH + 20) - 10;
+      int16_t    clipY = random.below(OLED_HEIGHT + 20) - 10;
+      int16_t    clipW = random.below(OLED_WIDTH);
+      int16_t    clipH = random.below(OLED_HEIGHT);
+
+      pDisplay->fillScreen(bg);
+      ref.fillScreen(bg);
+      drawClipped(pDisplay, seed, 0xFFFF, clipX, clipY, clipW, clipH);
+      drawUnclipped(&ref, seed, 0xFFFF);
+      uint32_t crc = pEmulator->viewCrc();
+      if (!isClipReset(pDisplay)) {
+        printf("SSD1351 rotation %u seed %u kept its viewport.\n", rotation, seed);
+        failures++;
+      }
+
+      // ref is in rotation 0, so its pixels are in the display's coordinates.
+      std::vector<uint16_t> expected = clippedPixels(&ref, OLED_WIDTH, OLED_HEIGHT, 0,
+                                                     clipX, clipY, clipW, clipH, bg);
+      pDisplay->drawRGBBitmap(0, 0, &expected[0], OLED_WIDTH, OLED_HEIGHT);
+      if (crc != pEmulator->viewCrc()) {
+        printf("SSD1351 viewport in rotation %u seed %u differs.\n", rotation, seed);
+        failures++;
+      }
+    }
+  }
+  pDisplay->setRotation(0);
+  return report("SSD1351 GFXviewport", cases, failures);
+}
+
+
+int main()
+{
+  FastSpiWriter   spi(OLED_MOSI_PIN, NC, OLED_SCK_PIN, NC);
+  SSD1351         display(OLED_WIDTH, OLED_HEIGHT, &spi, OLED_DC_PIN, OLED_RST_PIN, OLED_LEFT_CS_PIN);
+  SSD1351Emulator emulator(OLED_DC_PIN, OLED_LEFT_CS_PIN);
+  bool            ok = true;
+
+  display.init();
+  ok = checkCanvas16Fills() && ok;
+  ok = checkCanvas16Flush(&display, &emulator) && ok;
+  ok = checkCanvas1Fills() && ok;
+  ok = checkCanvas1Blit(&display, &emulator) && ok;
+  ok = checkCanvas8Fills() && ok;
+  ok = checkDrawCanvas(&display, &emulator) && ok;
+  ok = checkWirePixels(&display, &emulator) && ok;
+  ok = checkCanvasClip<GFXcanvas16>("GFXcanvas16 GFXviewport", 0xFFFF) && ok;
+  ok = checkCanvasClip<GFXcanvas8>("GFXcanvas8 GFXviewport", 0x00FF) && ok;
+  ok = checkCanvasClip<GFXcanvas1>("GFXcanvas1 GFXviewport", 0x0001) && ok;
+  ok = checkDisplayClip(&display, &emulator) && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Pseudo-terminal loopback measurement of the control protocol's latency.
+//
+// Gaze commands are written to the master side of a pty.  A receive thread
+// stands in for the UART RX interrupt: it reads the slave side, runs the bytes
+// through ControlParser and posts completed commands into a ControlMailbox.
+// A frame thread stands in for frame(): it drains the mailbox at the start of
+// each simulated frame and, once that frame's render time has elapsed, records
+// how long it took from the command being written until the last pixel of the
+// first frame affected by it.
+//
+// Usage: controlLatency [commandCount] [frameTimeUs] [baudRate]
+//   commandCount  Number of gaze commands to send (1 - 1024, default 500).
+//   frameTimeUs   Simulated render+transmit time of each frame (default 20000).
+//   baudRate      Used to report the UART wire time of a command, which a pty
+//                 doesn't model (default 115200).
+//
+// Exits with a non-zero status if any command is lost, duplicated or
+// corrupted along the way.
+#include <ControlProtocol.h>
+#include <FrameStats.h>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+
+#define MAX_COMMANDS 1024
+
+
+static std::atomic<uint32_t> g_sendTime[MAX_COMMANDS];
+static std::atomic<bool>     g_received[MAX_COMMANDS];
+static std::atomic<uint32_t> g_receivedCount(0);
+static std::atomic<uint32_t> g_duplicateCount(0);
+static std::atomic<uint32_t> g_droppedCount(0);
+static std::atomic<bool>     g_stop(false);
+static ControlMailbox        g_mailbox;
+static Histogram             g_mailboxLatency;
+static Histogram             g_frameLatency;
+
+
+static uint32_t nowUs()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void rxThread(int fd, ControlParser* pParser)
+{
+  ControlCommand command;
+  uint8_t        buffer[64];
+
+  while (!g_stop) {
+    ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count <= 0) {
+      continue;
+    }
+    for (ssize_t i = 0 ; i < count ; i++) {
+      if (pParser->parse(buffer[i], &command) == ControlParser::CONTROL_COMMAND) {
+        command.timestamp = nowUs();
+        if (!g_mailbox.post(command)) {
+          g_droppedCount++;
+        }
+      }
+    }
+  }
+}
+
+static void frameThread(uint32_t frameTime)
+{
+  uint16_t pending[CONTROL_MAILBOX_SIZE * 4];
+
+  while (!g_stop) {
+    uint32_t       frameStart = nowUs();
+    uint32_t       pendingCount = 0;
+    ControlCommand command;
+
+    // Same as processControl() at the start of frame().
+    while (g_mailbox.fetch(&command)) {
+      uint16_t seq = controlPayloadU16(&command, 0);
+      if (command.id != CONTROL_CMD_GAZE || seq >= MAX_COMMANDS) {
+        continue;
+      }
+      if (g_received[seq].exchange(true)) {
+        g_duplicateCount++;
+        continue;
+      }
+      g_mailboxLatency.add(command.timestamp - g_sendTime[seq]);
+      if (pendingCount < sizeof(pending) / sizeof(pending[0])) {
+        pending[pendingCount++] = seq;
+      }
+    }
+
+    // Render and transmit the frame.
+    while ((uint32_t)(nowUs() - frameStart) < frameTime) {
+      std::this_thread::yield();
+    }
+
+    uint32_t frameEnd = nowUs();
+    for (uint32_t i = 0 ; i < pendingCount ; i++) {
+      g_frameLatency.add(frameEnd - g_sendTime[pending[i]]);
+      g_receivedCount++;
+    }
+  }
+}
+
+static int openLoopback(int* pSlaveFd)
+{
+  int masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (masterFd < 0 || grantpt(masterFd) || unlockpt(masterFd)) {
+    perror("posix_openpt");
+    return -1;
+  }
+
+  int slaveFd = open(ptsname(masterFd), O_RDWR | O_NOCTTY);
+  if (slaveFd < 0) {
+    perror("open(ptsname)");
+    return -1;
+  }
+
+  // Raw binary mode with reads returning as soon as any data is available.
+  struct termios settings;
+  tcgetattr(slaveFd, &settings);
+  cfmakeraw(&settings);
+  settings.c_cc[VMIN] = 0;
+  settings.c_cc[VTIME] = 1;
+  tcsetattr(slaveFd, TCSANOW, &settings);
+
+  *pSlaveFd = slaveFd;
+  return masterFd;
+}
+
+static void printHistogram(const char* pName, const Histogram& histogram)
+{
+  printf("%-28s %7lu %7lu %7lu %7lu\n", pName,
+         (unsigned long)histogram.count(),
+         (unsigned long)histogram.percentile(50),
+         (unsigned long)histogram.percentile(99),
+         (unsigned long)histogram.max());
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t      commandCount = (argc > 1) ? strtoul(argv[1], NULL, 0) : 500;
+  uint32_t      frameTime = (argc > 2) ? strtoul(argv[2], NULL, 0) : 20000;
+  uint32_t      baudRate = (argc > 3) ? strtoul(argv[3], NULL, 0) : 115200;
+  ControlParser parser;
+  int           slaveFd = -1;
+
+  if (commandCount < 1 || commandCount > MAX_COMMANDS || frameTime == 0 || baudRate == 0) {
+    fprintf(stderr, "Usage: controlLatency [commandCount] [frameTimeUs] [baudRate]\n");
+    return 1;
+  }
+
+  int masterFd = openLoopback(&slaveFd);
+  if (masterFd < 0) {
+    return 1;
+  }
+
+  std::thread rx(rxThread, slaveFd, &parser);
+  std::thread frames(frameThread, frameTime);
+
+  // Send the gaze commands at random intervals of up to 2 frames, with the
+  // sequence number carried in the X coordinate.
+  srand(1);
+  uint32_t frameBytes = 0;
+  for (uint32_t seq = 0 ; seq < commandCount ; seq++) {
+    uint8_t payload[6] = { (uint8_t)seq, (uint8_t)(seq >> 8), 0x00, 0x02, 0x00, 0x00 };
+    uint8_t buffer[CONTROL_MAX_FRAME];
+
+    // Throw a stray console key in every so often to make sure the parser
+    // resyncs around it.
+    if (seq % 17 == 0) {
+      uint8_t key = 'x';
+      if (write(masterFd, &key, 1) != 1) {
+        perror("write");
+      }
+    }
+
+    frameBytes = controlEncode(CONTROL_CMD_GAZE, payload, sizeof(payload), buffer);
+    g_sendTime[seq] = nowUs();
+    if (write(masterFd, buffer, frameBytes) != (ssize_t)frameBytes) {
+      perror("write");
+    }
+    usleep(rand() % (2 * frameTime));
+  }
+
+  // Give the last commands time to make it through a frame.
+  for (int i = 0 ; i < 100 && g_receivedCount < commandCount ; i++) {
+    usleep(frameTime);
+  }
+  g_stop = true;
+  frames.join();
+  rx.join();
+  close(slaveFd);
+  close(masterFd);
+
+  uint32_t wireTime = (frameBytes * 10 * 1000000ULL) / baudRate;
+  printf("%lu gaze commands, %lu us frames\n", (unsigned long)commandCount, (unsigned long)frameTime);
+  printf("%-28s %7s %7s %7s %7s\n", "latency (us)", "count", "p50", "p99", "max");
+  printHistogram("write to mailbox", g_mailboxLatency);
+  printHistogram("write to first frame done", g_frameLatency);
+  printf("UART wire time for a %lu byte command at %lu baud adds %lu us.\n",
+         (unsigned long)frameBytes, (unsigned long)baudRate, (unsigned long)wireTime);
+
+  uint32_t lost = commandCount - g_receivedCount;
+  printf("lost: %lu  duplicated: %lu  dropped (mailbox full): %lu  bad frames: %lu\n",
+         (unsigned long)lost, (unsigned long)g_duplicateCount.load(),
+         (unsigned long)g_droppedCount.load(), (unsigned long)parser.errorCount());
+
+  return (lost || g_duplicateCount || g_droppedCount || parser.errorCount()) ? 1 : 0;
+}
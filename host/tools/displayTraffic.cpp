@@ -0,0 +1,88 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Runs the firmware in the host build with an SSD1351Emulator on each eye and
+// reports how many bytes and transactions each frame costs on the wire.  The
+// last complete frame of each eye can be saved as a PPM image and its CRC is
+// printed so that driver changes can be checked for pixel exact output.
+//
+// Usage: displayTraffic [seconds] [ppmPrefix]
+//   seconds    Virtual time to run for (default 10).
+//   ppmPrefix  If given, writes <ppmPrefix>0.ppm, <ppmPrefix>1.ppm, etc.
+#include <mbed.h>
+#include <SSD1351Emulator.h>
+
+
+// Same as the pins in config.h.
+#define OLED_DC_PIN       p6
+#define OLED_LEFT_CS_PIN  p9
+#define OLED_RIGHT_CS_PIN p10
+
+
+// main() from ../src/main.cpp, renamed by the Makefile.
+int dragonEyesMain();
+
+
+static double perFrame(uint64_t count, uint64_t frames)
+{
+  return frames ? (double)count / frames : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+  double          seconds = (argc > 1) ? strtod(argv[1], NULL) : 10.0;
+  const char*     pPrefix = (argc > 2) ? argv[2] : NULL;
+  SSD1351Emulator left(OLED_DC_PIN, OLED_LEFT_CS_PIN);
+  SSD1351Emulator right(OLED_DC_PIN, OLED_RIGHT_CS_PIN);
+  SSD1351Emulator* displays[] = { &left, &right };
+
+  if (seconds <= 0.0) {
+    fprintf(stderr, "Usage: displayTraffic [seconds] [ppmPrefix]\n");
+    return 1;
+  }
+
+  mbedHost::setTimeLimit((uint64_t)(seconds * 1000000000.0));
+  try {
+    dragonEyesMain();
+  } catch (mbedHost::TimeLimit&) {
+  }
+
+  printf("\n%.1f s of virtual time, averages are per full screen frame.\n", mbedHost::now() / 1000000000.0);
+  printf("eye  frames  cmd bytes  data bytes  pixel bytes  wire bytes  transactions  windows  last frame CRC\n");
+  for (size_t i = 0 ; i < sizeof(displays) / sizeof(displays[0]) ; i++) {
+    const SSD1351Traffic& traffic = displays[i]->traffic();
+    uint64_t              frames = traffic.frames;
+
+    printf("%3u %7llu %10.1f %11.1f %12.1f %11.1f %13.1f %8.1f       %08X\n",
+           (unsigned)i, (unsigned long long)frames,
+           perFrame(traffic.commandBytes, frames),
+           perFrame(traffic.dataBytes, frames),
+           perFrame(traffic.pixelBytes, frames),
+           perFrame(traffic.commandBytes + traffic.dataBytes, frames),
+           perFrame(traffic.transactions, frames),
+           perFrame(traffic.windowResets, frames),
+           displays[i]->viewCrc(true));
+
+    if (pPrefix) {
+      char filename[256];
+      snprintf(filename, sizeof(filename), "%s%u.ppm", pPrefix, (unsigned)i);
+      if (!displays[i]->writePpm(filename, true)) {
+        perror(filename);
+        return 1;
+      }
+    }
+  }
+
+  return 0;
+}
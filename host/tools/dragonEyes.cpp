@@ -0,0 +1,61 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Runs the unmodified firmware (../src/main.cpp and its libraries) on Linux
+// against the mbed HAL shim in ../mbed for a given amount of virtual time.
+// The firmware's own output (FPS, console command dumps) goes to stdout.
+//
+// The Makefile also builds this as traceRecord, traceReplay and moviePlay,
+// with the firmware's TRACE_RECORD, TRACE_REPLAY or MOVIE_FILE defined.
+//
+// Usage: dragonEyes [seconds] [localDir]
+//   seconds   Virtual time to run for (default 60).
+//   localDir  Directory standing in for the mbed's USB drive, /local, where
+//             TRACE_FILE is written or read and MOVIE_FILE is read (default
+//             is the current one).
+#include <mbed.h>
+#include <chrono>
+
+
+// main() from ../src/main.cpp, renamed by the Makefile.
+int dragonEyesMain();
+
+
+int main(int argc, char** argv)
+{
+  double seconds = (argc > 1) ? strtod(argv[1], NULL) : 60.0;
+
+  if (seconds <= 0.0) {
+    fprintf(stderr, "Usage: %s [seconds] [localDir]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 2) {
+    mbedHost::setLocalDirectory(argv[2]);
+  }
+
+  mbedHost::setTimeLimit((uint64_t)(seconds * 1000000000.0));
+  auto start = std::chrono::steady_clock::now();
+  try {
+    dragonEyesMain();
+  } catch (mbedHost::TimeLimit&) {
+  }
+  double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double virtualTime = mbedHost::now() / 1000000000.0;
+  printf("Simulated %.1f s in %.2f s (%.0fx real time), %llu SPI bytes.\n",
+         virtualTime, wallTime, virtualTime / wallTime,
+         (unsigned long long)mbedHost::spiWriteCount());
+
+  return 0;
+}
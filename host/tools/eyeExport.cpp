@@ -0,0 +1,123 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Writes the tables of one of the eyes in ../src/graphics back out as the
+// netpbm images which assetCompiler reads, so that the eye can be compiled
+// again in one of assetCompiler's other layouts.  The Makefile uses this to
+// build the byte swapped and paletted eyes which drawEyeBench checks against
+// the golden CRCs of the eyes they came from.
+//
+// The images are written to outputDir as sclera.ppm, iris.ppm, upper.pgm,
+// lower.pgm and polar.pgm (16-bit), plus upperSymmetrical.pgm and
+// lowerSymmetrical.pgm if the eye has a SYMMETRICAL_EYELID set.  The
+// assetCompiler arguments which compile them back into the same eye are
+// printed to stdout.
+//
+// Usage: eyeExport outputDir eyeName
+#include "EyeAsset.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+
+static const EyeAsset* findAsset(const char* pName, bool symmetrical)
+{
+  for (const EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    if (strcmp(pAsset->pName, pName) == 0 && pAsset->symmetrical == symmetrical) {
+      return pAsset;
+    }
+  }
+  return NULL;
+}
+
+// Writes table of pAsset as a PGM, or as a PPM of its RGB565 pixels widened
+// back to 8-bits per channel the same way that assetCompiler narrows them.
+static bool writeImage(const std::string& filename, const EyeAsset* pAsset, FlashTable table)
+{
+  uint32_t width = pAsset->tableWidth[table];
+  uint32_t height = pAsset->tableHeight[table];
+  bool     colour = table == FLASH_SCLERA || table == FLASH_IRIS;
+  bool     wide = table == FLASH_POLAR;
+  FILE*    pFile = fopen(filename.c_str(), "wb");
+
+  if (!pFile) {
+    perror(filename.c_str());
+    return false;
+  }
+  fprintf(pFile, "%s\n%u %u\n%u\n", colour ? "P6" : "P5", width, height, wide ? 65535 : 255);
+  for (uint32_t i = 0 ; i < width * height ; i++) {
+    if (colour || wide) {
+      uint16_t p = ((const uint16_t*)pAsset->pTables[table])[i];
+      if (colour) {
+        uint8_t r = p >> 11, g = (p >> 5) & 0x3F, b = p & 0x1F;
+        fputc((r << 3) | (r >> 2), pFile);
+        fputc((g << 2) | (g >> 4), pFile);
+        fputc((b << 3) | (b >> 2), pFile);
+      } else {
+        fputc(p >> 8, pFile);
+        fputc(p, pFile);
+      }
+    } else {
+      fputc(((const uint8_t*)pAsset->pTables[table])[i], pFile);
+    }
+  }
+  bool ok = !ferror(pFile);
+  ok = fclose(pFile) == 0 && ok;
+  if (!ok) {
+    fprintf(stderr, "Failed to write %s.\n", filename.c_str());
+  }
+  return ok;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 3 || argv[1][0] == '-') {
+    fprintf(stderr, "Usage: eyeExport outputDir eyeName\n");
+    return 1;
+  }
+  std::string     dir = std::string(argv[1]) + "/";
+  const EyeAsset* pAsset = findAsset(argv[2], false);
+  const EyeAsset* pSymmetrical = findAsset(argv[2], true);
+  if (!pAsset) {
+    fprintf(stderr, "%s isn't one of the eyes in ../src/graphics.\n", argv[2]);
+    return 1;
+  }
+
+  // naugaEye and owlEye are registered twice with the same eyelids.
+  uint32_t eyelidSize = pAsset->tableWidth[FLASH_UPPER] * pAsset->tableHeight[FLASH_UPPER];
+  if (pSymmetrical &&
+      memcmp(pSymmetrical->pTables[FLASH_UPPER], pAsset->pTables[FLASH_UPPER], eyelidSize) == 0 &&
+      memcmp(pSymmetrical->pTables[FLASH_LOWER], pAsset->pTables[FLASH_LOWER], eyelidSize) == 0) {
+    pSymmetrical = NULL;
+  }
+
+  if (!writeImage(dir + "sclera.ppm", pAsset, FLASH_SCLERA) ||
+      !writeImage(dir + "iris.ppm", pAsset, FLASH_IRIS) ||
+      !writeImage(dir + "upper.pgm", pAsset, FLASH_UPPER) ||
+      !writeImage(dir + "lower.pgm", pAsset, FLASH_LOWER) ||
+      !writeImage(dir + "polar.pgm", pAsset, FLASH_POLAR) ||
+      (pSymmetrical && (!writeImage(dir + "upperSymmetrical.pgm", pSymmetrical, FLASH_UPPER) ||
+                        !writeImage(dir + "lowerSymmetrical.pgm", pSymmetrical, FLASH_LOWER)))) {
+    return 1;
+  }
+
+  printf("-s %ssclera.ppm -i %siris.ppm -u %supper.pgm -l %slower.pgm -P %spolar.pgm -m %u -M %u",
+         dir.c_str(), dir.c_str(), dir.c_str(), dir.c_str(), dir.c_str(), pAsset->irisMin, pAsset->irisMax);
+  if (pSymmetrical) {
+    printf(" -U %supperSymmetrical.pgm -L %slowerSymmetrical.pgm", dir.c_str(), dir.c_str());
+  }
+  printf("\n");
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Packs the eyes in ../src/graphics into binary eye assets (EyeBlob) which
+// the firmware can link in with EYE_BLOB_FILE in config.h, and which
+// drawEyeBench -b can render without being rebuilt.  Each blob holds both
+// sets of eyelids for eyes which have a SYMMETRICAL_EYELID set.
+//
+// Usage: eyePack [outputDir] [eyeName]
+//   outputDir  Where to write <eyeName>.eyb (default is the current directory).
+//   eyeName    Only pack eyes whose name contains this string.
+#include "BlobAsset.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+
+static const EyeAsset* findSymmetrical(const EyeAsset* pAsset)
+{
+  for (const EyeAsset* pOther = eyeAssets() ; pOther ; pOther = pOther->pNext) {
+    if (strcmp(pOther->pName, pAsset->pName) == 0 && pOther->symmetrical) {
+      return pOther;
+    }
+  }
+  return NULL;
+}
+
+int main(int argc, char** argv)
+{
+  const char* pDir = (argc > 1) ? argv[1] : ".";
+  const char* pFilter = (argc > 2) ? argv[2] : NULL;
+
+  if (argc > 3 || pDir[0] == '-') {
+    fprintf(stderr, "Usage: eyePack [outputDir] [eyeName]\n");
+    return 1;
+  }
+
+  printf("%-14s %-28s %8s %5s\n", "eye", "file", "bytes", "sym");
+  for (const EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    if (pAsset->symmetrical || (pFilter && !strstr(pAsset->pName, pFilter))) {
+      continue;
+    }
+
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%s/%s.eyb", pDir, pAsset->pName);
+    if (!writeEyeBlob(filename, pAsset, findSymmetrical(pAsset))) {
+      return 1;
+    }
+
+    // Read it back to make sure that it is valid.
+    EyeAsset*   pBlobAssets = openEyeBlob(filename);
+    struct stat info;
+    if (!pBlobAssets || stat(filename, &info) != 0) {
+      return 1;
+    }
+    printf("%-14s %-28s %8lu %5s\n", pAsset->pName, filename, (unsigned long)info.st_size,
+           pBlobAssets->pNext->tableWidth[FLASH_UPPER] &&
+           pBlobAssets->pNext->pTables[FLASH_UPPER] != pBlobAssets->pTables[FLASH_UPPER] ? "yes" : "no");
+  }
+
+  return 0;
+}
@@ -0,0 +1,195 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Runs the Adafruit_GFX primitive benchmark (src/GfxBenchmark) against the
+// SSD1351 driver in the host build.  Times are virtual, so they show how long
+// the SPI transfers would take on the wire with free CPU, and the byte counts
+// are exact.
+//
+// The benchmark is run twice: through the virtual calls of Adafruit_GFX and
+// then through StaticGfx<SSD1351>.  ticks/prim is the host CPU time in
+// nanoseconds, which is where the two differ, since they must send exactly
+// the same bytes.  An SSD1351Emulator checks that both leave the same image
+// on the screen.  Before that, the charset test is drawn through print() and
+// through a GlyphCache, with cp437() off and on, to check that the cache
+// draws every character as print() does.  -m runs them against a host mock display instead, a frame
+// buffer with no SPI port, so that the CPU time is only that of the drawing
+// front end.
+//
+// Usage: gfxBenchmark [-m] [rotation]
+//   -m        Draw into the host mock display rather than the SSD1351.
+//   rotation  Display rotation (0 - 3, default 0).
+#include <mbed.h>
+#include <SSD1351.h>
+#include <SSD1351Emulator.h>
+#include <GfxBenchmark.h>
+#include <StaticGfx.h>
+
+
+// Same as the pins in config.h.
+#define OLED_MOSI_PIN     p5
+#define OLED_SCK_PIN      p7
+#define OLED_DC_PIN       p6
+#define OLED_RST_PIN      p8
+#define OLED_LEFT_CS_PIN  p9
+#define OLED_WIDTH        128
+#define OLED_HEIGHT       128
+
+
+// Frame buffer behind the same batched write*() calls as SSD1351, defined
+// inline like the driver's.
+class MockDisplay : public Adafruit_GFX
+{
+  public:
+    MockDisplay() : Adafruit_GFX(OLED_WIDTH, OLED_HEIGHT)
+    {
+      memset(m_frame, 0, sizeof(m_frame));
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) { MockDisplay::writePixel(x, y, color); }
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { MockDisplay::writeFillRect(x, y, 1, h, color); }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { MockDisplay::writeFillRect(x, y, w, 1, color); }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) { MockDisplay::writeFillRect(x, y, w, h, color); }
+
+    void startWrite() {}
+    void writePixel(int16_t x, int16_t y, uint16_t color)
+    {
+      if (clipContains(x, y)) {
+        m_frame[y][x] = color;
+      }
+    }
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { MockDisplay::writeFillRect(x, y, 1, h, color); }
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { MockDisplay::writeFillRect(x, y, w, 1, color); }
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+      if (!clipRect(x, y, w, h)) {
+        return;
+      }
+      for (int16_t row = y ; row < y + h ; row++) {
+        for (int16_t column = x ; column < x + w ; column++) {
+          m_frame[row][column] = color;
+        }
+      }
+    }
+    void endWrite() {}
+
+    uint32_t crc() const
+    {
+      uint32_t crc = ~0U;
+      for (int y = 0 ; y < OLED_HEIGHT ; y++) {
+        for (int x = 0 ; x < OLED_WIDTH ; x++) {
+          for (int shift = 0 ; shift < 16 ; shift += 8) {
+            crc ^= (m_frame[y][x] >> shift) & 0xFF;
+            for (int bit = 0 ; bit < 8 ; bit++) {
+              crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+            }
+          }
+        }
+      }
+      return ~crc;
+    }
+
+  protected:
+    uint16_t m_frame[OLED_HEIGHT][OLED_WIDTH];
+};
+
+
+static uint32_t spiBytes()
+{
+  return (uint32_t)mbedHost::spiWriteCount();
+}
+
+// Runs the benchmark through Adafruit_GFX and then StaticGfx<Device>,
+// returning false if they don't leave the same CRC.
+template<class Device, class Crc>
+static bool compare(Device* pDisplay, GfxByteCounter pByteCounter, Crc crc, const char* pName)
+{
+  Timer             timer;
+  GfxBenchmark      benchmark(pDisplay, &timer, pByteCounter, Profiler::now);
+  StaticGfx<Device> staticGfx(pDisplay);
+
+  printf("Adafruit_GFX virtual calls to %s:\n", pName);
+  uint32_t startBytes = spiBytes();
+  benchmark.run();
+  uint32_t virtualBytes = spiBytes() - startBytes;
+  uint32_t virtualCrc = crc();
+
+  printf("\nStaticGfx<%s>:\n", pName);
+  startBytes = spiBytes();
+  benchmark.run(&staticGfx);
+  uint32_t staticBytes = spiBytes() - startBytes;
+  uint32_t staticCrc = crc();
+
+  if (virtualBytes != staticBytes || virtualCrc != staticCrc) {
+    printf("\nStaticGfx differs: %u vs %u SPI bytes, screen CRC %08X vs %08X.\n",
+           staticBytes, virtualBytes, staticCrc, virtualCrc);
+    return false;
+  }
+  printf("\nBoth sent %u SPI bytes and left screen CRC %08X.\n", staticBytes, staticCrc);
+  return true;
+}
+
+// Prints every character through Adafruit_GFX's print() and then through a
+// GlyphCache, with cp437() off and on, returning false if they don't leave
+// the same CRC.
+template<class Device, class Crc>
+static bool compareCharset(Device* pDisplay, Crc crc)
+{
+  static GlyphCache cache;
+  Timer             timer;
+  GfxBenchmark      benchmark(pDisplay, &timer);
+  GfxCachedText     cachedText(pDisplay, &cache);
+  bool              match = true;
+
+  for (int cp437 = 0 ; cp437 < 2 ; cp437++) {
+    benchmark.testCharset(pDisplay, cp437);
+    uint32_t printCrc = crc();
+    benchmark.testCharset(&cachedText, cp437);
+    uint32_t cacheCrc = crc();
+
+    printf("Charset with cp437() %-3s: print() screen CRC %08X, GlyphCache %08X.\n",
+           cp437 ? "on" : "off", printCrc, cacheCrc);
+    match = match && printCrc == cacheCrc;
+  }
+  printf("\n");
+  return match;
+}
+
+int main(int argc, char** argv)
+{
+  bool          mock = argc > 1 && strcmp(argv[1], "-m") == 0;
+  int           rotation = (argc > 1 + mock) ? atoi(argv[1 + mock]) : 0;
+  FastSpiWriter spi(OLED_MOSI_PIN, NC, OLED_SCK_PIN, NC);
+  SSD1351       display(OLED_WIDTH, OLED_HEIGHT, &spi, OLED_DC_PIN, OLED_RST_PIN, OLED_LEFT_CS_PIN);
+  MockDisplay   mockDisplay;
+
+  if (rotation < 0 || rotation > 3) {
+    fprintf(stderr, "Usage: gfxBenchmark [-m] [rotation]\n");
+    return 1;
+  }
+
+  if (mock) {
+    mockDisplay.setRotation(rotation);
+    auto crc = [&]() { return mockDisplay.crc(); };
+    bool charsetMatches = compareCharset(&mockDisplay, crc);
+    return compare(&mockDisplay, NULL, crc, "MockDisplay") && charsetMatches ? 0 : 1;
+  }
+
+  SSD1351Emulator emulator(OLED_DC_PIN, OLED_LEFT_CS_PIN);
+  display.init();
+  display.setRotation(rotation);
+  auto crc = [&]() { return emulator.viewCrc(); };
+  bool charsetMatches = compareCharset(&display, crc);
+  return compare(&display, spiBytes, crc, "SSD1351") && charsetMatches ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Renders the frames of a trace from traceRecord offline and encodes them
+// into an EyeMovie which the firmware can play back with MOVIE_FILE or
+// MOVIE_FLASH in config.h, sending only the pixels which changed from each
+// display's previous frame.
+//
+// Each frame is rendered by the kernel of the same eye from the drawEyeBench
+// objects.  By default there is one frame per trace record, at the time the
+// firmware animated it.  -f instead resamples the animation of each eye at a
+// fixed frame rate, interpolating between the trace records around each
+// frame, since the offline renderer isn't limited to the frame rate the
+// firmware managed while recording.
+//
+// The movie is read back and decoded to make sure that every frame matches
+// what was rendered, then a summary of how much of each frame changed and
+// the SPI traffic needed to send it is printed.
+//
+// Usage: movieEncode [-e eyeName] [-s] [-f fps] traceFile movieFile
+//   -e eyeName  Eye to render (default is the one enabled in config.h).
+//   -s          Use its SYMMETRICAL_EYELID tables.
+//   -f fps      Frames per second for each eye (default is the trace's).
+#include <EyeAsset.h>
+#include <EyeMovie.h>
+#include <EyeTrace.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+
+// SPI bytes for the SSD1351 setAddrWindow() that starts each span.
+#define SPI_BYTES_PER_WINDOW  7
+// SSP clocked at 96MHz / 5 by SSD1351::commonInit().
+#define SPI_BYTES_PER_SECOND  (96000000 / 5 / 8)
+// Eyes which a trace can have frames for.
+#define MAX_EYES              8
+
+// Decodes spans back into a frame like the display's frame buffer would.
+class FrameSink
+{
+  public:
+    FrameSink() { memset(m_frame, 0, sizeof(m_frame)); }
+
+    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t* pBitmap, int16_t w, int16_t h)
+    {
+      for (int16_t j = 0 ; j < h ; j++) {
+        memcpy(&m_frame[(y + j) * EYE_FRAME_WIDTH + x], &pBitmap[j * w], w * sizeof(*pBitmap));
+      }
+    }
+    const uint16_t* frame() const { return m_frame; }
+
+  protected:
+    uint16_t m_frame[EYE_FRAME_PIXELS];
+};
+
+
+static const EyeAsset* findAsset(const char* pName, bool symmetrical)
+{
+  for (const EyeAsset* pAsset = eyeAssets() ; pAsset ; pAsset = pAsset->pNext) {
+    if (strcmp(pAsset->pName, pName) == 0 && pAsset->symmetrical == symmetrical) {
+      return pAsset;
+    }
+  }
+  return NULL;
+}
+
+static uint8_t lerp(uint8_t a, uint8_t b, uint64_t num, uint64_t den)
+{
+  return a + (int32_t)((int64_t)((int32_t)b - a) * num / den);
+}
+
+// Poses of every eye at each multiple of 1000000 / fps micros between the
+// first and last records of the trace.
+static std::vector<EyeTraceRecord> resample(const std::vector<EyeTraceRecord>& records, double fps)
+{
+  std::vector<EyeTraceRecord> eyes[MAX_EYES];
+  std::vector<EyeTraceRecord> frames;
+  uint32_t                    first = records.front().t;
+  uint32_t                    last = records.back().t;
+
+  for (size_t i = 0 ; i < records.size() ; i++) {
+    eyes[records[i].eye].push_back(records[i]);
+  }
+
+  for (uint64_t frame = 0 ; ; frame++) {
+    uint32_t t = first + (uint32_t)(frame * 1000000.0 / fps);
+    if (t > last) {
+      break;
+    }
+    for (uint8_t e = 0 ; e < MAX_EYES ; e++) {
+      const std::vector<EyeTraceRecord>& eye = eyes[e];
+      size_t                             next = 0;
+
+      if (eye.empty()) {
+        continue;
+      }
+      while (next < eye.size() && eye[next].t <= t) {
+        next++;
+      }
+
+      EyeTraceRecord pose = eye[next ? next - 1 : 0];
+      if (next > 0 && next < eye.size()) {
+        const EyeTraceRecord& a = eye[next - 1];
+        const EyeTraceRecord& b = eye[next];
+        uint32_t              num = t - a.t;
+        uint32_t              den = b.t - a.t;
+        pose.iScale = a.iScale + (int32_t)((int64_t)((int32_t)b.iScale - a.iScale) * num / den);
+        pose.scleraX = lerp(a.scleraX, b.scleraX, num, den);
+        pose.scleraY = lerp(a.scleraY, b.scleraY, num, den);
+        pose.uT = lerp(a.uT, b.uT, num, den);
+        pose.lT = lerp(a.lT, b.lT, num, den);
+      }
+      pose.t = t;
+      pose.eye = e;
+      frames.push_back(pose);
+    }
+  }
+  return frames;
+}
+
+int main(int argc, char** argv)
+{
+  const char* pName = CONFIG_EYE;
+  bool        symmetrical = CONFIG_SYMMETRICAL;
+  double      fps = 0.0;
+  const char* pTraceFile = NULL;
+  const char* pMovieFile = NULL;
+  bool        usage = false;
+
+  for (int i = 1 ; i < argc ; i++) {
+    if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      pName = argv[++i];
+    } else if (strcmp(argv[i], "-s") == 0) {
+      symmetrical = true;
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      fps = strtod(argv[++i], NULL);
+      usage = fps <= 0.0;
+    } else if (argv[i][0] != '-' && !pTraceFile) {
+      pTraceFile = argv[i];
+    } else if (argv[i][0] != '-' && !pMovieFile) {
+      pMovieFile = argv[i];
+    } else {
+      usage = true;
+    }
+  }
+  if (usage || !pMovieFile) {
+    fprintf(stderr, "Usage: movieEncode [-e eyeName] [-s] [-f fps] traceFile movieFile\n");
+    return 1;
+  }
+
+  const EyeAsset* pAsset = findAsset(pName, symmetrical);
+  if (!pAsset) {
+    fprintf(stderr, "%s isn't one of the eyes in ../src/graphics.\n", pName);
+    return 1;
+  }
+
+  EyeTraceReader              trace;
+  EyeTraceRecord              record;
+  std::vector<EyeTraceRecord> frames;
+  uint8_t                     eyeCount = 0;
+  if (!trace.open(pTraceFile)) {
+    fprintf(stderr, "%s isn't a version %d trace.\n", pTraceFile, EYE_TRACE_VERSION);
+    return 1;
+  }
+  while (trace.read(&record)) {
+    // Recorded with another eye?
+    if (record.eye >= MAX_EYES || record.scleraX > pAsset->scleraXMax || record.scleraY > pAsset->scleraYMax) {
+      continue;
+    }
+    frames.push_back(record);
+    eyeCount = record.eye + 1 > eyeCount ? record.eye + 1 : eyeCount;
+  }
+  if (frames.empty()) {
+    fprintf(stderr, "%s has no frames which fit %s.\n", pTraceFile, pAsset->pName);
+    return 1;
+  }
+  if (fps > 0.0) {
+    frames = resample(frames, fps);
+  }
+
+  // Times are relative to the first frame so that playback starts at once.
+  uint32_t       start = frames.front().t;
+  EyeMovieWriter writer;
+  uint16_t       previous[MAX_EYES][EYE_FRAME_PIXELS];
+  uint16_t       frame[EYE_FRAME_PIXELS];
+  bool           seen[MAX_EYES] = { false };
+  if (!writer.open(pMovieFile, eyeCount, EYE_FRAME_WIDTH, EYE_FRAME_HEIGHT)) {
+    perror(pMovieFile);
+    return 1;
+  }
+  for (size_t i = 0 ; i < frames.size() ; i++) {
+    const EyeTraceRecord& pose = frames[i];
+    pAsset->render(frame, pose.iScale, pose.scleraX, pose.scleraY, pose.uT, pose.lT);
+    if (!writer.write(pose.t - start, pose.eye, frame, seen[pose.eye] ? previous[pose.eye] : NULL)) {
+      perror(pMovieFile);
+      return 1;
+    }
+    memcpy(previous[pose.eye], frame, sizeof(frame));
+    seen[pose.eye] = true;
+  }
+  uint64_t bytes = writer.bytes();
+  uint64_t spans = writer.spans();
+  uint64_t pixels = writer.pixels();
+  if (!writer.close()) {
+    perror(pMovieFile);
+    return 1;
+  }
+
+  // Play it back to make sure that it decodes to the same frames.
+  EyeMovieReader reader;
+  EyeMoviePacket packet;
+  FrameSink      sinks[MAX_EYES];
+  uint32_t       count = 0;
+  if (!reader.open(pMovieFile) || reader.packetCount() != frames.size()) {
+    fprintf(stderr, "%s couldn't be read back.\n", pMovieFile);
+    return 1;
+  }
+  while (reader.readPacket(&packet)) {
+    const EyeTraceRecord& pose = frames[count];
+    if (packet.eye != pose.eye || packet.t != pose.t - start || !reader.drawPacket(&sinks[packet.eye])) {
+      fprintf(stderr, "%s: packet %u doesn't decode.\n", pMovieFile, count);
+      return 1;
+    }
+    pAsset->render(frame, pose.iScale, pose.scleraX, pose.scleraY, pose.uT, pose.lT);
+    if (memcmp(frame, sinks[packet.eye].frame(), sizeof(frame)) != 0) {
+      fprintf(stderr, "%s: packet %u decodes to the wrong frame.\n", pMovieFile, count);
+      return 1;
+    }
+    count++;
+  }
+
+  double   packets = frames.size();
+  double   seconds = (frames.back().t - start) / 1000000.0;
+  double   fullSpi = SPI_BYTES_PER_WINDOW + 2.0 * EYE_FRAME_PIXELS;
+  double   deltaSpi = (SPI_BYTES_PER_WINDOW * spans + 2.0 * pixels) / packets;
+  printf("%s%s: %u frames for %u eyes over %.1f s, %.1f frames/s per eye.\n",
+         pAsset->pName, pAsset->symmetrical ? " (SYMMETRICAL_EYELID)" : "", count, eyeCount, seconds,
+         seconds > 0.0 ? packets / eyeCount / seconds : 0.0);
+  printf("%s: %llu bytes, %.0f bytes per frame.\n", pMovieFile, (unsigned long long)bytes, bytes / packets);
+  printf("Per frame: %.0f pixels (%.1f%%) in %.1f spans sent.\n",
+         pixels / packets, 100.0 * pixels / packets / EYE_FRAME_PIXELS, spans / packets);
+  printf("SPI bytes per frame: %.0f vs %.0f for drawEye(), %.0f vs %.0f frames/s at the SPI rate.\n",
+         deltaSpi, fullSpi, SPI_BYTES_PER_SECOND / deltaSpi, SPI_BYTES_PER_SECOND / fullSpi);
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Simulated GPIO check of the wink button press to first closing frame
+// latency.
+//
+// Each eye gets a simulated button which is pressed at random times with
+// random amounts of contact bounce on both the press and release.  The edges
+// are fed through WinkDebouncer at the exact (virtual) time that the pin
+// interrupt would fire and a frame loop uses EyeScheduler the same way that
+// frame() does to pick which eye to render next.  The latency of each press
+// is measured to the end of the first frame which served it.
+//
+// Usage: winkLatency [pressCount] [frameTimeUs] [eyeCount]
+//   pressCount   Number of presses per eye (default 1000).
+//   frameTimeUs  Longest render+transmit time of a frame (default 20000).  The
+//                actual frame times vary randomly between 75% and 100% of this.
+//   eyeCount     Number of eyes/buttons (1 - 8, default 2).
+//
+// Exits with a non-zero status if a press is missed, a bounce is mistaken for
+// a press or a press takes longer than 2 frame times to be served (plus a
+// frame time for each other eye which had its wink served first).
+#include <WinkRequest.h>
+#include <FrameStats.h>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+
+#define DEBOUNCE_TIME 20000 // Same as WINK_DEBOUNCE_TIME in config.h
+#define BOUNCE_TIME   5000  // Contact bounce settles within this time
+#define MAX_EYES      8
+
+
+struct Edge {
+  uint64_t time;
+  uint8_t  eye;
+  bool     pressed;
+
+  bool operator<(const Edge& other) const { return time < other.time; }
+};
+
+struct EyeState {
+  uint32_t served;
+  uint32_t pendingSince;  // Press time of the request waiting to be served
+  bool     pending;
+  uint32_t othersServed;  // Frames given to other winking eyes while pending
+};
+
+
+// Appends the edges for a press or release, with 0 - 5 extra bounces.
+static void addEdges(std::vector<Edge>* pEdges, uint64_t time, uint8_t eye, bool pressed)
+{
+  uint32_t bounces = (rand() % 3) * 2;
+
+  pEdges->push_back({ time, eye, pressed });
+  for (uint32_t i = 0 ; i < bounces ; i++) {
+    time += 1 + rand() % (BOUNCE_TIME / bounces);
+    // Bounce back to the other level and then return.
+    pEdges->push_back({ time, eye, (i & 1) ? pressed : !pressed });
+  }
+}
+
+int main(int argc, char** argv)
+{
+  uint32_t pressCount = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+  uint32_t frameTime = (argc > 2) ? strtoul(argv[2], NULL, 0) : 20000;
+  uint32_t eyeCount = (argc > 3) ? strtoul(argv[3], NULL, 0) : 2;
+
+  if (pressCount < 1 || frameTime < 4 || eyeCount < 1 || eyeCount > MAX_EYES) {
+    fprintf(stderr, "Usage: winkLatency [pressCount] [frameTimeUs] [eyeCount]\n");
+    return 1;
+  }
+
+  // Press each button every 50 - 500ms and hold it for 30 - 300ms.  Presses
+  // on different eyes are independent so they sometimes land in the same frame.
+  std::vector<Edge> edges;
+  srand(1);
+  for (uint8_t e = 0 ; e < eyeCount ; e++) {
+    uint64_t time = 0;
+    for (uint32_t i = 0 ; i < pressCount ; i++) {
+      time += 50000 + rand() % 450000;
+      uint64_t hold = 30000 + rand() % 270000;
+      addEdges(&edges, time, e, true);
+      addEdges(&edges, time + hold, e, false);
+      time += hold;
+    }
+  }
+  std::stable_sort(edges.begin(), edges.end());
+
+  std::vector<WinkDebouncer> buttons(eyeCount, WinkDebouncer(DEBOUNCE_TIME));
+  EyeState                   eyes[MAX_EYES] = { };
+  EyeScheduler               scheduler(eyeCount);
+  Histogram                  latency;
+  uint64_t                   now = 0;
+  size_t                     nextEdge = 0;
+  uint32_t                   lateCount = 0;
+  uint32_t                   extraCount = 0;
+  uint32_t                   worst = 0;
+
+  while (nextEdge < edges.size() || now < edges.back().time + 4 * frameTime) {
+    uint64_t frameStart = now;
+    uint64_t frameEnd = frameStart + frameTime - rand() % (frameTime / 4);
+
+    // Pin interrupts which fired before this frame started.
+    for ( ; nextEdge < edges.size() && edges[nextEdge].time <= frameStart ; nextEdge++) {
+      const Edge& edge = edges[nextEdge];
+      buttons[edge.eye].edge((uint32_t)edge.time, edge.pressed);
+    }
+
+    // Same as the start of frame().
+    uint32_t mask = 0;
+    for (uint8_t e = 0 ; e < eyeCount ; e++) {
+      if (buttons[e].pending()) {
+        mask |= 1 << e;
+        if (!eyes[e].pending) {
+          eyes[e].pending = true;
+          eyes[e].othersServed = 0;
+        }
+      }
+    }
+    uint8_t  eye = scheduler.next(mask);
+    uint32_t pressTime;
+    if (buttons[eye].fetch(&pressTime)) {
+      uint32_t elapsed = (uint32_t)frameEnd - pressTime;
+      uint32_t bound = (2 + eyes[eye].othersServed) * frameTime;
+
+      latency.add(elapsed);
+      if (elapsed > bound) {
+        lateCount++;
+      }
+      if (elapsed > worst) {
+        worst = elapsed;
+      }
+      eyes[eye].served++;
+      eyes[eye].pending = false;
+      for (uint8_t e = 0 ; e < eyeCount ; e++) {
+        if (e != eye && eyes[e].pending) {
+          eyes[e].othersServed++;
+        }
+      }
+    }
+
+    now = frameEnd;
+  }
+
+  uint32_t missedCount = 0;
+  for (uint8_t e = 0 ; e < eyeCount ; e++) {
+    if (eyes[e].served < pressCount) {
+      missedCount += pressCount - eyes[e].served;
+    } else {
+      extraCount += eyes[e].served - pressCount;
+    }
+  }
+
+  printf("%lu eyes x %lu presses, frames of %lu - %lu us\n",
+         (unsigned long)eyeCount, (unsigned long)pressCount,
+         (unsigned long)(frameTime - frameTime / 4 + 1), (unsigned long)frameTime);
+  printf("press to first closing frame done (us): p50 %lu  p99 %lu  max %lu\n",
+         (unsigned long)latency.percentile(50), (unsigned long)latency.percentile(99),
+         (unsigned long)worst);
+  printf("single eye bound (2 frames): %lu us\n", (unsigned long)(2 * frameTime));
+  printf("missed: %lu  bounces taken as presses: %lu  over bound: %lu\n",
+         (unsigned long)missedCount, (unsigned long)extraCount, (unsigned long)lateCount);
+
+  return (missedCount || extraCount || lateCount) ? 1 : 0;
+}
@@ -33,6 +33,7 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <string.h>
 #include "Adafruit_GFX.h"
+#include "GfxRaster.h"
 #include "glcdfont.x"
 
 // Many (but maybe not all) non-AVR board installs define macros
@@ -97,11 +98,13 @@ Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
   wrap = true;
   _cp437 = false;
   gfxFont = NULL;
+  resetClipRect();
 }
 
 /**************************************************************************/
 /*!
-   @brief    Write a line.  Bresenham's algorithm - thx wikpedia
+   @brief    Write a line.  Bresenham's algorithm - thx wikpedia - sent
+   as a writeFastHLine() or writeFastVLine() per run (see GfxRaster.h)
     @param    x0  Start point x coordinate
     @param    y0  Start point y coordinate
     @param    x1  End point x coordinate
@@ -111,42 +114,7 @@ Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h) {
 /**************************************************************************/
 void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
                              uint16_t color) {
-  int16_t steep = abs(y1 - y0) > abs(x1 - x0);
-  if (steep) {
-    _swap_int16_t(x0, y0);
-    _swap_int16_t(x1, y1);
-  }
-
-  if (x0 > x1) {
-    _swap_int16_t(x0, x1);
-    _swap_int16_t(y0, y1);
-  }
-
-  int16_t dx, dy;
-  dx = x1 - x0;
-  dy = abs(y1 - y0);
-
-  int16_t err = dx / 2;
-  int16_t ystep;
-
-  if (y0 < y1) {
-    ystep = 1;
-  } else {
-    ystep = -1;
-  }
-
-  for (; x0 <= x1; x0++) {
-    if (steep) {
-      writePixel(y0, x0, color);
-    } else {
-      writePixel(x0, y0, color);
-    }
-    err -= dy;
-    if (err < 0) {
-      y0 += ystep;
-      err += dx;
-    }
-  }
+  gfxWriteLine(this, x0, y0, x1, y1, color);
 }
 
 /**************************************************************************/
@@ -165,7 +133,8 @@ void Adafruit_GFX::startWrite() {}
 */
 /**************************************************************************/
 void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
-  drawPixel(x, y, color);
+  if (clipContains(x, y))
+    drawPixel(x, y, color);
 }
 
 /**************************************************************************/
@@ -241,8 +210,13 @@ void Adafruit_GFX::endWrite() {}
 /**************************************************************************/
 void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h,
                                  uint16_t color) {
+  int16_t w = 1;
+  if (!clipRect(x, y, w, h))
+    return;
   startWrite();
-  writeLine(x, y, x, y + h - 1, color);
+  for (int16_t i = y; i < y + h; i++) {
+    writePixel(x, i, color);
+  }
   endWrite();
 }
 
@@ -258,8 +232,13 @@ void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h,
 /**************************************************************************/
 void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w,
                                  uint16_t color) {
+  int16_t h = 1;
+  if (!clipRect(x, y, w, h))
+    return;
   startWrite();
-  writeLine(x, y, x + w - 1, y, color);
+  for (int16_t i = x; i < x + w; i++) {
+    writePixel(i, y, color);
+  }
   endWrite();
 }
 
@@ -276,6 +255,8 @@ void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w,
 /**************************************************************************/
 void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
                             uint16_t color) {
+  if (!clipRect(x, y, w, h))
+    return;
   startWrite();
   for (int16_t i = x; i < x + w; i++) {
     writeFastVLine(i, y, h, color);
@@ -333,37 +314,8 @@ void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 /**************************************************************************/
 void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r,
                               uint16_t color) {
-  int16_t f = 1 - r;
-  int16_t ddF_x = 1;
-  int16_t ddF_y = -2 * r;
-  int16_t x = 0;
-  int16_t y = r;
-
   startWrite();
-  writePixel(x0, y0 + r, color);
-  writePixel(x0, y0 - r, color);
-  writePixel(x0 + r, y0, color);
-  writePixel(x0 - r, y0, color);
-
-  while (x < y) {
-    if (f >= 0) {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-
-    writePixel(x0 + x, y0 + y, color);
-    writePixel(x0 - x, y0 + y, color);
-    writePixel(x0 + x, y0 - y, color);
-    writePixel(x0 - x, y0 - y, color);
-    writePixel(x0 + y, y0 + x, color);
-    writePixel(x0 - y, y0 + x, color);
-    writePixel(x0 + y, y0 - x, color);
-    writePixel(x0 - y, y0 - x, color);
-  }
+  gfxWriteCircle(this, x0, y0, r, 0xF, true, color);
   endWrite();
 }
 
@@ -380,38 +332,7 @@ void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r,
 /**************************************************************************/
 void Adafruit_GFX::drawCircleHelper(int16_t x0, int16_t y0, int16_t r,
                                     uint8_t cornername, uint16_t color) {
-  int16_t f = 1 - r;
-  int16_t ddF_x = 1;
-  int16_t ddF_y = -2 * r;
-  int16_t x = 0;
-  int16_t y = r;
-
-  while (x < y) {
-    if (f >= 0) {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-    if (cornername & 0x4) {
-      writePixel(x0 + x, y0 + y, color);
-      writePixel(x0 + y, y0 + x, color);
-    }
-    if (cornername & 0x2) {
-      writePixel(x0 + x, y0 - y, color);
-      writePixel(x0 + y, y0 - x, color);
-    }
-    if (cornername & 0x8) {
-      writePixel(x0 - y, y0 + x, color);
-      writePixel(x0 - x, y0 + y, color);
-    }
-    if (cornername & 0x1) {
-      writePixel(x0 - y, y0 - x, color);
-      writePixel(x0 - x, y0 - y, color);
-    }
-  }
+  gfxWriteCircle(this, x0, y0, r, cornername, false, color);
 }
 
 /**************************************************************************/
@@ -445,43 +366,7 @@ void Adafruit_GFX::fillCircle(int16_t x0, int16_t y0, int16_t r,
 void Adafruit_GFX::fillCircleHelper(int16_t x0, int16_t y0, int16_t r,
                                     uint8_t corners, int16_t delta,
                                     uint16_t color) {
-
-  int16_t f = 1 - r;
-  int16_t ddF_x = 1;
-  int16_t ddF_y = -2 * r;
-  int16_t x = 0;
-  int16_t y = r;
-  int16_t px = x;
-  int16_t py = y;
-
-  delta++; // Avoid some +1's in the loop
-
-  while (x < y) {
-    if (f >= 0) {
-      y--;
-      ddF_y += 2;
-      f += ddF_y;
-    }
-    x++;
-    ddF_x += 2;
-    f += ddF_x;
-    // These checks avoid double-drawing certain lines, important
-    // for the SSD1306 library which has an INVERT drawing mode.
-    if (x < (y + 1)) {
-      if (corners & 1)
-        writeFastVLine(x0 + x, y0 - y, 2 * y + delta, color);
-      if (corners & 2)
-        writeFastVLine(x0 - x, y0 - y, 2 * y + delta, color);
-    }
-    if (y != py) {
-      if (corners & 1)
-        writeFastVLine(x0 + py, y0 - px, 2 * px + delta, color);
-      if (corners & 2)
-        writeFastVLine(x0 - py, y0 - px, 2 * px + delta, color);
-      py = y;
-    }
-    px = x;
-  }
+  gfxFillCircle(this, x0, y0, r, corners, delta, color);
 }
 
 /**************************************************************************/
@@ -592,85 +477,8 @@ void Adafruit_GFX::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
 /**************************************************************************/
 void Adafruit_GFX::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
                                 int16_t x2, int16_t y2, uint16_t color) {
-
-  int16_t a, b, y, last;
-
-  // Sort coordinates by Y order (y2 >= y1 >= y0)
-  if (y0 > y1) {
-    _swap_int16_t(y0, y1);
-    _swap_int16_t(x0, x1);
-  }
-  if (y1 > y2) {
-    _swap_int16_t(y2, y1);
-    _swap_int16_t(x2, x1);
-  }
-  if (y0 > y1) {
-    _swap_int16_t(y0, y1);
-    _swap_int16_t(x0, x1);
-  }
-
   startWrite();
-  if (y0 == y2) { // Handle awkward all-on-same-line case as its own thing
-    a = b = x0;
-    if (x1 < a)
-      a = x1;
-    else if (x1 > b)
-      b = x1;
-    if (x2 < a)
-      a = x2;
-    else if (x2 > b)
-      b = x2;
-    writeFastHLine(a, y0, b - a + 1, color);
-    endWrite();
-    return;
-  }
-
-  int16_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0,
-          dx12 = x2 - x1, dy12 = y2 - y1;
-  int32_t sa = 0, sb = 0;
-
-  // For upper part of triangle, find scanline crossings for segments
-  // 0-1 and 0-2.  If y1=y2 (flat-bottomed triangle), the scanline y1
-  // is included here (and second loop will be skipped, avoiding a /0
-  // error there), otherwise scanline y1 is skipped here and handled
-  // in the second loop...which also avoids a /0 error here if y0=y1
-  // (flat-topped triangle).
-  if (y1 == y2)
-    last = y1; // Include y1 scanline
-  else
-    last = y1 - 1; // Skip it
-
-  for (y = y0; y <= last; y++) {
-    a = x0 + sa / dy01;
-    b = x0 + sb / dy02;
-    sa += dx01;
-    sb += dx02;
-    /* longhand:
-    a = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
-    b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
-    */
-    if (a > b)
-      _swap_int16_t(a, b);
-    writeFastHLine(a, y, b - a + 1, color);
-  }
-
-  // For lower part of triangle, find scanline crossings for segments
-  // 0-2 and 1-2.  This loop is skipped if y1=y2.
-  sa = (int32_t)dx12 * (y - y1);
-  sb = (int32_t)dx02 * (y - y0);
-  for (; y <= y2; y++) {
-    a = x1 + sa / dy12;
-    b = x0 + sb / dy02;
-    sa += dx12;
-    sb += dx02;
-    /* longhand:
-    a = x1 + (x2 - x1) * (y - y1) / (y2 - y1);
-    b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
-    */
-    if (a > b)
-      _swap_int16_t(a, b);
-    writeFastHLine(a, y, b - a + 1, color);
-  }
+  gfxFillTriangle(this, x0, y0, x1, y1, x2, y2, color);
   endWrite();
 }
 
@@ -1268,6 +1076,8 @@ void Adafruit_GFX::print(const char* p)
     }
 }
 
+const uint8_t *Adafruit_GFX::classicFont(void) { return font; }
+
 /**************************************************************************/
 /*!
     @brief   Set text 'magnification' size. Each increase in s makes 1 pixel
@@ -1310,6 +1120,54 @@ void Adafruit_GFX::setRotation(uint8_t x) {
     _height = WIDTH;
     break;
   }
+  resetClipRect();
+}
+
+/**************************************************************************/
+/*!
+    @brief  Limit drawing to a rectangle of the screen, replacing the
+            current clip rectangle.  It is trimmed to the screen.
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+*/
+/**************************************************************************/
+void Adafruit_GFX::setClipRect(int16_t x, int16_t y, int16_t w, int16_t h) {
+  int32_t x1 = (int32_t)x + w;
+  int32_t y1 = (int32_t)y + h;
+  _clipX0 = x < 0 ? 0 : x > _width ? _width : x;
+  _clipY0 = y < 0 ? 0 : y > _height ? _height : y;
+  _clipX1 = x1 < _clipX0 ? _clipX0 : x1 > _width ? _width : x1;
+  _clipY1 = y1 < _clipY0 ? _clipY0 : y1 > _height ? _height : y1;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Let drawing cover the whole screen again
+*/
+/**************************************************************************/
+void Adafruit_GFX::resetClipRect(void) {
+  _clipX0 = _clipY0 = 0;
+  _clipX1 = _width;
+  _clipY1 = _height;
+}
+
+/**************************************************************************/
+/*!
+    @brief  Get the clip rectangle, such as to restore it later
+    @param  x   Returns the top left corner x coordinate
+    @param  y   Returns the top left corner y coordinate
+    @param  w   Returns the width in pixels, 0 if nothing is drawn
+    @param  h   Returns the height in pixels, 0 if nothing is drawn
+*/
+/**************************************************************************/
+void Adafruit_GFX::getClipRect(int16_t *x, int16_t *y, int16_t *w,
+                               int16_t *h) const {
+  *x = _clipX0;
+  *y = _clipY0;
+  *w = _clipX1 - _clipX0;
+  *h = _clipY1 - _clipY0;
 }
 
 /**************************************************************************/
@@ -1643,6 +1501,35 @@ bool Adafruit_GFX_Button::justReleased() {
 
 // -------------------------------------------------------------------------
 
+/**************************************************************************/
+/*!
+    @brief  Narrow the clip rectangle of a display to the part of a
+            viewport which is inside it
+    @param  gfx Display to clip
+    @param  x   Top left corner x coordinate of the viewport
+    @param  y   Top left corner y coordinate of the viewport
+    @param  w   Width of the viewport in pixels
+    @param  h   Height of the viewport in pixels
+*/
+/**************************************************************************/
+GFXviewport::GFXviewport(Adafruit_GFX *gfx, int16_t x, int16_t y, int16_t w,
+                         int16_t h)
+    : _gfx(gfx) {
+  _gfx->getClipRect(&_x, &_y, &_w, &_h);
+  if (!_gfx->clipRect(x, y, w, h))
+    w = h = 0;
+  _gfx->setClipRect(x, y, w, h);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Restore the clip rectangle from before the viewport
+*/
+/**************************************************************************/
+GFXviewport::~GFXviewport(void) { _gfx->setClipRect(_x, _y, _w, _h); }
+
+// -------------------------------------------------------------------------
+
 // GFXcanvas1, GFXcanvas8 and GFXcanvas16 (currently a WIP, don't get too
 // comfy with the implementation) provide 1-, 8- and 16-bit offscreen
 // canvases, the address of which can be passed to drawBitmap() or
@@ -1660,6 +1547,48 @@ bool Adafruit_GFX_Button::justReleased() {
 // scanline pad).
 // NOT EXTENSIVELY TESTED YET.  MAY CONTAIN WORST BUGS KNOWN TO HUMANKIND.
 
+/**************************************************************************/
+/*!
+    @brief  Clip a rectangle to a canvas's clip rectangle and rotate it
+            into the canvas's unrotated framebuffer, so that the canvases
+            can fill spans a buffer row at a time
+    @param  canvas  The canvas, for its clip rectangle and rotation
+    @param  W   Unrotated width of the canvas
+    @param  H   Unrotated height of the canvas
+    @param  x   Top left corner x coordinate, replaced by the buffer's
+    @param  y   Top left corner y coordinate, replaced by the buffer's
+    @param  w   Width in pixels, replaced by the width in the buffer
+    @param  h   Height in pixels, replaced by the height in the buffer
+    @returns  False if nothing of the rectangle is on the canvas
+*/
+/**************************************************************************/
+static bool canvasRect(const Adafruit_GFX *canvas, int16_t W, int16_t H,
+                       int16_t &x, int16_t &y, int16_t &w, int16_t &h) {
+  if (!canvas->clipRect(x, y, w, h))
+    return false;
+
+  int16_t t;
+  switch (canvas->getRotation()) {
+  case 1:
+    t = x;
+    x = W - y - h;
+    y = t;
+    _swap_int16_t(w, h);
+    break;
+  case 2:
+    x = W - x - w;
+    y = H - y - h;
+    break;
+  case 3:
+    t = x;
+    x = y;
+    y = H - t - w;
+    _swap_int16_t(w, h);
+    break;
+  }
+  return true;
+}
+
 /**************************************************************************/
 /*!
    @brief    Instatiate a GFX 1-bit canvas context for graphics
@@ -1694,7 +1623,7 @@ GFXcanvas1::~GFXcanvas1(void) {
 /**************************************************************************/
 void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
   if (buffer) {
-    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    if (!clipContains(x, y))
       return;
 
     int16_t t;
@@ -1730,12 +1659,194 @@ void GFXcanvas1::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 /**************************************************************************/
 void GFXcanvas1::fillScreen(uint16_t color) {
-  if (buffer) {
+  if (!clipIsScreen()) {
+    fillBuffer(0, 0, _width, _height, color);
+  } else if (buffer) {
     uint16_t bytes = ((WIDTH + 7) / 8) * HEIGHT;
     memset(buffer, color ? 0xFF : 0x00, bytes);
   }
 }
 
+/**************************************************************************/
+/*!
+    @brief  Fill a rectangle of the canvas, clipped to it.  The rectangle is
+            rotated into the framebuffer once, then each row has the partly
+            covered bytes at either end masked and the bytes between them
+            set with memset(), which fills them a word at a time.
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::fillBuffer(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  if (!buffer || !canvasRect(this, WIDTH, HEIGHT, x, y, w, h))
+    return;
+
+  uint16_t bytesPerRow = (WIDTH + 7) / 8;
+  int16_t x1 = x + w;
+  int16_t bytes = (x1 - 1) / 8 - x / 8;
+  uint8_t first = 0xFF >> (x & 7);
+  uint8_t last = 0xFF << ((8 - (x1 & 7)) & 7);
+  if (bytes == 0)
+    first &= last;
+
+  uint8_t *row = buffer + y * bytesPerRow + x / 8;
+  for (int16_t i = 0; i < h; i++, row += bytesPerRow) {
+    if (color) {
+      row[0] |= first;
+      if (bytes > 0) {
+        memset(row + 1, 0xFF, bytes - 1);
+        row[bytes] |= last;
+      }
+    } else {
+      row[0] &= ~first;
+      if (bytes > 0) {
+        memset(row + 1, 0x00, bytes - 1);
+        row[bytes] &= ~last;
+      }
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a pixel, as drawPixel() since the canvas has no
+            transactions
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::writePixel(int16_t x, int16_t y, uint16_t color) {
+  GFXcanvas1::drawPixel(x, y, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a perfectly vertical line
+    @param  x   Top-most x coordinate
+    @param  y   Top-most y coordinate
+    @param  h   Height in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::writeFastVLine(int16_t x, int16_t y, int16_t h,
+                                uint16_t color) {
+  fillBuffer(x, y, 1, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a perfectly horizontal line
+    @param  x   Left-most x coordinate
+    @param  y   Left-most y coordinate
+    @param  w   Width in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::writeFastHLine(int16_t x, int16_t y, int16_t w,
+                                uint16_t color) {
+  fillBuffer(x, y, w, 1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a rectangle completely with one color
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                               uint16_t color) {
+  fillBuffer(x, y, w, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a perfectly vertical line
+    @param  x   Top-most x coordinate
+    @param  y   Top-most y coordinate
+    @param  h   Height in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                               uint16_t color) {
+  fillBuffer(x, y, 1, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a perfectly horizontal line
+    @param  x   Left-most x coordinate
+    @param  y   Left-most y coordinate
+    @param  w   Width in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                               uint16_t color) {
+  fillBuffer(x, y, w, 1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fill a rectangle completely with one color
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color Binary (on or off) color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas1::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                          uint16_t color) {
+  fillBuffer(x, y, w, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw the unrotated framebuffer on a display with its top left
+            corner at (x, y), expanding set pixels to one RGB565 color and
+            clear ones to another.  The SSD1351 expands it as it streams it
+            through a single address window.
+    @param  display  Display to draw the canvas on
+    @param  x   Display x coordinate of the canvas
+    @param  y   Display y coordinate of the canvas
+    @param  color 16-bit 5-6-5 Color of the set pixels
+    @param  bg    16-bit 5-6-5 Color of the clear pixels
+*/
+/**************************************************************************/
+void GFXcanvas1::blit(Adafruit_GFX *display, int16_t x, int16_t y,
+                      uint16_t color, uint16_t bg) {
+  if (buffer)
+    display->drawBitmap(x, y, buffer, WIDTH, HEIGHT, color, bg);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw just the set pixels of the unrotated framebuffer on a
+            display with its top left corner at (x, y), leaving what is
+            already under the clear ones.  The SSD1351 sends each run of set
+            pixels in a row through its own address window.
+    @param  display  Display to draw the canvas on
+    @param  x   Display x coordinate of the canvas
+    @param  y   Display y coordinate of the canvas
+    @param  color 16-bit 5-6-5 Color of the set pixels
+*/
+/**************************************************************************/
+void GFXcanvas1::blit(Adafruit_GFX *display, int16_t x, int16_t y,
+                      uint16_t color) {
+  if (buffer)
+    display->drawBitmap(x, y, buffer, WIDTH, HEIGHT, color);
+}
+
 /**************************************************************************/
 /*!
    @brief    Instatiate a GFX 8-bit canvas context for graphics
@@ -1770,7 +1881,7 @@ GFXcanvas8::~GFXcanvas8(void) {
 /**************************************************************************/
 void GFXcanvas8::drawPixel(int16_t x, int16_t y, uint16_t color) {
   if (buffer) {
-    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    if (!clipContains(x, y))
       return;
 
     int16_t t;
@@ -1802,47 +1913,132 @@ void GFXcanvas8::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 /**************************************************************************/
 void GFXcanvas8::fillScreen(uint16_t color) {
-  if (buffer) {
+  if (!clipIsScreen()) {
+    fillBuffer(0, 0, _width, _height, color);
+  } else if (buffer) {
     memset(buffer, color, WIDTH * HEIGHT);
   }
 }
 
+/**************************************************************************/
+/*!
+    @brief  Fill a rectangle of the canvas, clipped to it.  The rectangle is
+            rotated into the framebuffer once and then filled a row at a
+            time with memset().
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::fillBuffer(int16_t x, int16_t y, int16_t w, int16_t h,
+                            uint16_t color) {
+  if (!buffer || !canvasRect(this, WIDTH, HEIGHT, x, y, w, h))
+    return;
+
+  uint8_t *row = buffer + y * WIDTH + x;
+  for (int16_t i = 0; i < h; i++, row += WIDTH)
+    memset(row, color, w);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a pixel, as drawPixel() since the canvas has no
+            transactions
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::writePixel(int16_t x, int16_t y, uint16_t color) {
+  GFXcanvas8::drawPixel(x, y, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a perfectly vertical line
+    @param  x   Top-most x coordinate
+    @param  y   Top-most y coordinate
+    @param  h   Height in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::writeFastVLine(int16_t x, int16_t y, int16_t h,
+                                uint16_t color) {
+  fillBuffer(x, y, 1, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a perfectly horizontal line
+    @param  x   Left-most x coordinate
+    @param  y   Left-most y coordinate
+    @param  w   Width in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
 void GFXcanvas8::writeFastHLine(int16_t x, int16_t y, int16_t w,
                                 uint16_t color) {
+  fillBuffer(x, y, w, 1, color);
+}
 
-  if ((x >= _width) || (y < 0) || (y >= _height))
-    return;
-  int16_t x2 = x + w - 1;
-  if (x2 < 0)
-    return;
+/**************************************************************************/
+/*!
+    @brief  Write a rectangle completely with one color
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                               uint16_t color) {
+  fillBuffer(x, y, w, h, color);
+}
 
-  // Clip left/right
-  if (x < 0) {
-    x = 0;
-    w = x2 + 1;
-  }
-  if (x2 >= _width)
-    w = _width - x;
+/**************************************************************************/
+/*!
+    @brief  Draw a perfectly vertical line
+    @param  x   Top-most x coordinate
+    @param  y   Top-most y coordinate
+    @param  h   Height in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                               uint16_t color) {
+  fillBuffer(x, y, 1, h, color);
+}
 
-  int16_t t;
-  switch (rotation) {
-  case 1:
-    t = x;
-    x = WIDTH - 1 - y;
-    y = t;
-    break;
-  case 2:
-    x = WIDTH - 1 - x;
-    y = HEIGHT - 1 - y;
-    break;
-  case 3:
-    t = x;
-    x = y;
-    y = HEIGHT - 1 - t;
-    break;
-  }
+/**************************************************************************/
+/*!
+    @brief  Draw a perfectly horizontal line
+    @param  x   Left-most x coordinate
+    @param  y   Left-most y coordinate
+    @param  w   Width in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                               uint16_t color) {
+  fillBuffer(x, y, w, 1, color);
+}
 
-  memset(buffer + y * WIDTH + x, color, w);
+/**************************************************************************/
+/*!
+    @brief  Fill a rectangle completely with one color
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color 8-bit color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas8::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                          uint16_t color) {
+  fillBuffer(x, y, w, h, color);
 }
 
 /**************************************************************************/
@@ -1857,6 +2053,8 @@ GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
   if ((buffer = (uint16_t *)malloc(bytes))) {
     memset(buffer, 0, bytes);
   }
+  dirty = (uint16_t *)malloc(h * 2 * sizeof(*dirty));
+  invalidate();
 }
 
 /**************************************************************************/
@@ -1867,6 +2065,20 @@ GFXcanvas16::GFXcanvas16(uint16_t w, uint16_t h) : Adafruit_GFX(w, h) {
 GFXcanvas16::~GFXcanvas16(void) {
   if (buffer)
     free(buffer);
+  if (dirty)
+    free(dirty);
+}
+
+// Widens the changed span of buffer row y to include x0 to x1.
+static inline void markDirty(uint16_t *dirty, int16_t y, int16_t x0,
+                             int16_t x1) {
+  if (dirty) {
+    uint16_t *span = &dirty[y * 2];
+    if ((uint16_t)x0 < span[0])
+      span[0] = x0;
+    if ((uint16_t)x1 > span[1])
+      span[1] = x1;
+  }
 }
 
 /**************************************************************************/
@@ -1879,7 +2091,7 @@ GFXcanvas16::~GFXcanvas16(void) {
 /**************************************************************************/
 void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
   if (buffer) {
-    if ((x < 0) || (y < 0) || (x >= _width) || (y >= _height))
+    if (!clipContains(x, y))
       return;
 
     int16_t t;
@@ -1901,6 +2113,7 @@ void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
     }
 
     buffer[x + y * WIDTH] = color;
+    markDirty(dirty, y, x, x);
   }
 }
 
@@ -1911,7 +2124,9 @@ void GFXcanvas16::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 /**************************************************************************/
 void GFXcanvas16::fillScreen(uint16_t color) {
-  if (buffer) {
+  if (!clipIsScreen()) {
+    fillBuffer(0, 0, _width, _height, color);
+  } else if (buffer) {
     uint8_t hi = color >> 8, lo = color & 0xFF;
     if (hi == lo) {
       memset(buffer, lo, WIDTH * HEIGHT * 2);
@@ -1920,6 +2135,194 @@ void GFXcanvas16::fillScreen(uint16_t color) {
       for (i = 0; i < pixels; i++)
         buffer[i] = color;
     }
+    invalidate();
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fill a rectangle of the canvas, clipped to it.  The rectangle is
+            rotated into the framebuffer once and then filled a row at a
+            time, rather than a drawPixel() at a time.
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::fillBuffer(int16_t x, int16_t y, int16_t w, int16_t h,
+                             uint16_t color) {
+  if (!buffer || !canvasRect(this, WIDTH, HEIGHT, x, y, w, h))
+    return;
+
+  uint16_t *row = buffer + y * WIDTH + x;
+  for (int16_t i = 0; i < h; i++, row += WIDTH) {
+    if (w == 1) {
+      *row = color;
+    } else if ((color >> 8) == (color & 0xFF)) {
+      memset(row, color & 0xFF, w * 2);
+    } else {
+      for (int16_t j = 0; j < w; j++)
+        row[j] = color;
+    }
+    markDirty(dirty, y + i, x, x + w - 1);
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a pixel, as drawPixel() since the canvas has no
+            transactions
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::writePixel(int16_t x, int16_t y, uint16_t color) {
+  GFXcanvas16::drawPixel(x, y, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a perfectly vertical line
+    @param  x   Top-most x coordinate
+    @param  y   Top-most y coordinate
+    @param  h   Height in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::writeFastVLine(int16_t x, int16_t y, int16_t h,
+                                 uint16_t color) {
+  fillBuffer(x, y, 1, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a perfectly horizontal line
+    @param  x   Left-most x coordinate
+    @param  y   Left-most y coordinate
+    @param  w   Width in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::writeFastHLine(int16_t x, int16_t y, int16_t w,
+                                 uint16_t color) {
+  fillBuffer(x, y, w, 1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Write a rectangle completely with one color
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                                uint16_t color) {
+  fillBuffer(x, y, w, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a perfectly vertical line
+    @param  x   Top-most x coordinate
+    @param  y   Top-most y coordinate
+    @param  h   Height in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::drawFastVLine(int16_t x, int16_t y, int16_t h,
+                                uint16_t color) {
+  fillBuffer(x, y, 1, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Draw a perfectly horizontal line
+    @param  x   Left-most x coordinate
+    @param  y   Left-most y coordinate
+    @param  w   Width in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::drawFastHLine(int16_t x, int16_t y, int16_t w,
+                                uint16_t color) {
+  fillBuffer(x, y, w, 1, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Fill a rectangle completely with one color
+    @param  x   Top left corner x coordinate
+    @param  y   Top left corner y coordinate
+    @param  w   Width in pixels
+    @param  h   Height in pixels
+    @param  color 16-bit 5-6-5 Color to fill with
+*/
+/**************************************************************************/
+void GFXcanvas16::fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                           uint16_t color) {
+  fillBuffer(x, y, w, h, color);
+}
+
+/**************************************************************************/
+/*!
+    @brief  Send the pixels which have changed since the last flush() to a
+            display, with the unrotated framebuffer's top left corner at
+            (x, y) on it.  Each changed row goes from its first to its last
+            changed pixel with one drawRGBBitmap(), which the SSD1351 sends
+            through a single address window.  Consecutive rows which have
+            changed across the whole width are contiguous in the
+            framebuffer, so they go together.  Writes made directly to
+            getBuffer() aren't seen unless invalidate() is called.  The
+            pixels are sent in native order, so a canvas kept in wire order
+            with byteSwap() is drawn with SSD1351::drawWireBitmap() instead.
+    @param  display  Display to draw the canvas on
+    @param  x   Display x coordinate of the canvas
+    @param  y   Display y coordinate of the canvas
+*/
+/**************************************************************************/
+void GFXcanvas16::flush(Adafruit_GFX *display, int16_t x, int16_t y) {
+  if (!buffer || !dirty)
+    return;
+
+  for (int16_t row = 0; row < HEIGHT;) {
+    uint16_t first = dirty[row * 2], last = dirty[row * 2 + 1];
+    int16_t rows = 1;
+    if (first > last) {
+      row++;
+      continue;
+    }
+    if (first == 0 && last == WIDTH - 1) {
+      while (row + rows < HEIGHT && dirty[(row + rows) * 2] == 0 &&
+             dirty[(row + rows) * 2 + 1] == WIDTH - 1)
+        rows++;
+    }
+    display->drawRGBBitmap(x + first, y + row, buffer + row * WIDTH + first,
+                           last - first + 1, rows);
+    for (int16_t i = 0; i < rows; i++, row++) {
+      dirty[row * 2] = 0xFFFF;
+      dirty[row * 2 + 1] = 0;
+    }
+  }
+}
+
+/**************************************************************************/
+/*!
+    @brief  Mark the whole canvas as changed, so that the next flush() sends
+            all of it, such as after the display has been cleared
+*/
+/**************************************************************************/
+void GFXcanvas16::invalidate(void) {
+  if (dirty) {
+    for (int16_t row = 0; row < HEIGHT; row++) {
+      dirty[row * 2] = 0;
+      dirty[row * 2 + 1] = WIDTH - 1;
+    }
   }
 }
 
@@ -1941,5 +2344,6 @@ void GFXcanvas16::byteSwap(void) {
     uint32_t i, pixels = WIDTH * HEIGHT;
     for (i = 0; i < pixels; i++)
       buffer[i] = __builtin_bswap16(buffer[i]);
+    invalidate();
   }
 }
@@ -68,8 +68,20 @@ public:
                     int16_t radius, uint16_t color),
       fillRoundRect(int16_t x0, int16_t y0, int16_t w, int16_t h,
                     int16_t radius, uint16_t color),
-      drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
-                 int16_t h, uint16_t color),
+      drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+               uint16_t bg, uint8_t size),
+      drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
+               uint16_t bg, uint8_t size_x, uint8_t size_y),
+      getTextBounds(const char *string, int16_t x, int16_t y, int16_t *x1,
+                    int16_t *y1, uint16_t *w, uint16_t *h),
+      setTextSize(uint8_t s), setTextSize(uint8_t sx, uint8_t sy),
+      setFont(const GFXfont *f = NULL);
+
+  // Bitmaps.  These MAY be overridden by the subclass to stream whole
+  // bitmaps rather than a writePixel() per pixel.
+  virtual void
+  drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
+             int16_t h, uint16_t color),
       drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w,
                  int16_t h, uint16_t color, uint16_t bg),
       drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h,
@@ -93,15 +105,7 @@ public:
       drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[],
                     const uint8_t mask[], int16_t w, int16_t h),
       drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, uint8_t *mask,
-                    int16_t w, int16_t h),
-      drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
-               uint16_t bg, uint8_t size),
-      drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color,
-               uint16_t bg, uint8_t size_x, uint8_t size_y),
-      getTextBounds(const char *string, int16_t x, int16_t y, int16_t *x1,
-                    int16_t *y1, uint16_t *w, uint16_t *h),
-      setTextSize(uint8_t s), setTextSize(uint8_t sx, uint8_t sy),
-      setFont(const GFXfont *f = NULL);
+                    int16_t w, int16_t h);
 
   /**********************************************************************/
   /*!
@@ -165,6 +169,10 @@ public:
   virtual size_t write(uint8_t);
   void print(const char*);
 
+  // The 'classic' 5x7 font, 5 bytes of columns per character, for front
+  // ends such as StaticGfx which draw text themselves.
+  static const uint8_t *classicFont(void);
+
   /************************************************************************/
   /*!
     @brief      Get width of the display, accounting for current rotation
@@ -207,7 +215,66 @@ public:
   /************************************************************************/
   int16_t getCursorY(void) const { return cursor_y; };
 
+  // Clip rectangle, in the coordinates of the current rotation.  Drawing is
+  // limited to it as well as to the screen, with each span or bitmap row
+  // trimmed to it once rather than each pixel tested.  setRotation() resets
+  // it to the whole screen.
+  void setClipRect(int16_t x, int16_t y, int16_t w, int16_t h),
+      resetClipRect(void),
+      getClipRect(int16_t *x, int16_t *y, int16_t *w, int16_t *h) const;
+
+  /************************************************************************/
+  /*!
+    @brief  Trim a rectangle to the clip rectangle, for displays and
+            canvases to do once per span or bitmap rather than per pixel
+    @param  x   Top left corner x coordinate, updated
+    @param  y   Top left corner y coordinate, updated
+    @param  w   Width in pixels, updated
+    @param  h   Height in pixels, updated
+    @returns    False if none of the rectangle is left to draw
+  */
+  /************************************************************************/
+  bool clipRect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+    int32_t x1 = (int32_t)x + w;
+    int32_t y1 = (int32_t)y + h;
+    if (x < _clipX0)
+      x = _clipX0;
+    if (y < _clipY0)
+      y = _clipY0;
+    if (x1 > _clipX1)
+      x1 = _clipX1;
+    if (y1 > _clipY1)
+      y1 = _clipY1;
+    if (x >= x1 || y >= y1)
+      return false;
+    w = x1 - x;
+    h = y1 - y;
+    return true;
+  }
+
+  /************************************************************************/
+  /*!
+    @brief  Check whether a pixel is inside the clip rectangle
+    @param  x   x coordinate
+    @param  y   y coordinate
+    @returns    True if the pixel would be drawn
+  */
+  /************************************************************************/
+  bool clipContains(int16_t x, int16_t y) const {
+    return x >= _clipX0 && x < _clipX1 && y >= _clipY0 && y < _clipY1;
+  }
+
 protected:
+  /************************************************************************/
+  /*!
+    @brief  Check whether the clip rectangle is the whole screen, for the
+            canvases' fillScreen()
+    @returns    True if nothing is clipped
+  */
+  /************************************************************************/
+  bool clipIsScreen(void) const {
+    return !_clipX0 && !_clipY0 && _clipX1 == _width && _clipY1 == _height;
+  }
   void charBounds(char c, int16_t *x, int16_t *y, int16_t *minx, int16_t *miny,
                   int16_t *maxx, int16_t *maxy);
   int16_t WIDTH,      ///< This is the 'raw' display width - never changes
@@ -224,6 +291,23 @@ protected:
   bool wrap,       ///< If set, 'wrap' text at right edge of display
       _cp437;         ///< If set, use correct CP437 charset (default is off)
   GFXfont *gfxFont;   ///< Pointer to special font
+  int16_t _clipX0,    ///< Left edge of the clip rectangle
+      _clipY0,        ///< Top edge of the clip rectangle
+      _clipX1,        ///< Right edge of the clip rectangle, exclusive
+      _clipY1;        ///< Bottom edge of the clip rectangle, exclusive
+};
+
+/// Narrows a display's clip rectangle to a viewport while it is in scope and
+/// then restores the one before it, so that nested viewports form a stack
+class GFXviewport {
+
+public:
+  GFXviewport(Adafruit_GFX *gfx, int16_t x, int16_t y, int16_t w, int16_t h);
+  ~GFXviewport(void);
+
+private:
+  Adafruit_GFX *_gfx;
+  int16_t _x, _y, _w, _h; // Clip rectangle to restore
 };
 
 /// A simple drawn button UI element
@@ -291,6 +375,20 @@ public:
   ~GFXcanvas1(void);
   void drawPixel(int16_t x, int16_t y, uint16_t color),
       fillScreen(uint16_t color);
+  // Spans are filled a byte of the buffer at a time rather than through
+  // drawPixel().
+  void writePixel(int16_t x, int16_t y, uint16_t color),
+      writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
+      writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
+      writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                    uint16_t color),
+      drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
+      drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
+      fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  // Draws the canvas on a display in two colors, or just the set pixels.
+  void blit(Adafruit_GFX *display, int16_t x, int16_t y, uint16_t color,
+            uint16_t bg),
+      blit(Adafruit_GFX *display, int16_t x, int16_t y, uint16_t color);
   /**********************************************************************/
   /*!
     @brief    Get a pointer to the internal buffer memory
@@ -300,6 +398,7 @@ public:
   uint8_t *getBuffer(void) const { return buffer; }
 
 private:
+  void fillBuffer(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   uint8_t *buffer;
 };
 
@@ -309,8 +408,17 @@ public:
   GFXcanvas8(uint16_t w, uint16_t h);
   ~GFXcanvas8(void);
   void drawPixel(int16_t x, int16_t y, uint16_t color),
-      fillScreen(uint16_t color),
-      writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+      fillScreen(uint16_t color);
+  // Spans are filled a row of the buffer at a time rather than through
+  // drawPixel().
+  void writePixel(int16_t x, int16_t y, uint16_t color),
+      writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
+      writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
+      writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                    uint16_t color),
+      drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
+      drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
+      fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   /**********************************************************************/
   /*!
    @brief    Get a pointer to the internal buffer memory
@@ -320,6 +428,7 @@ public:
   uint8_t *getBuffer(void) const { return buffer; }
 
 private:
+  void fillBuffer(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   uint8_t *buffer;
 };
 
@@ -330,6 +439,19 @@ public:
   ~GFXcanvas16(void);
   void drawPixel(int16_t x, int16_t y, uint16_t color),
       fillScreen(uint16_t color), byteSwap(void);
+  // Spans are filled a row of the buffer at a time rather than through
+  // drawPixel().
+  void writePixel(int16_t x, int16_t y, uint16_t color),
+      writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
+      writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
+      writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                    uint16_t color),
+      drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color),
+      drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color),
+      fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  // Sends the pixels drawn since the last flush() to a display.
+  void flush(Adafruit_GFX *display, int16_t x = 0, int16_t y = 0),
+      invalidate(void);
   /**********************************************************************/
   /*!
     @brief    Get a pointer to the internal buffer memory
@@ -339,7 +461,9 @@ public:
   uint16_t *getBuffer(void) const { return buffer; }
 
 private:
+  void fillBuffer(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
   uint16_t *buffer;
+  uint16_t *dirty; ///< First and last changed x of each buffer row
 };
 
 #endif // _ADAFRUIT_GFX_H
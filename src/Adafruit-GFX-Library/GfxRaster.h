@@ -0,0 +1,363 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Rasterizers for lines, circles and filled circles and triangles which hand
+// the display the longest horizontal or vertical runs of pixels that they can
+// rather than a pixel at a time, so that a windowed display such as the
+// SSD1351 fills each run from one address window.  They draw exactly the
+// same pixels as Adafruit's per pixel versions, just in a different order.
+// The one exception is outside of them: a rect or round rect of zero width or
+// height draws nothing, as it always did on the SSD1351, rather than the
+// stray pixels of Adafruit's writeLine() based drawFastVLine().
+//
+// Shared by Adafruit_GFX and StaticGfx.  Sink is anything with Adafruit_GFX's
+// writeFastHLine(), writeFastVLine() and writeFillRect().  The caller brackets
+// them with startWrite() and endWrite().
+#ifndef _GFX_RASTER_H_
+#define _GFX_RASTER_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+
+// Joins the spans given to it into rectangles, sending each to the sink once
+// the next span can't extend it by whole rows or columns.  The fills give one
+// merger each sequence of spans which can line up, such as the columns moving
+// out from the centre of a circle.
+template<class Sink>
+class GfxSpanMerger
+{
+  public:
+    GfxSpanMerger(Sink* pSink, uint16_t color)
+    {
+      m_pSink = pSink;
+      m_color = color;
+      m_x = m_y = m_w = m_h = 0;
+    }
+    ~GfxSpanMerger()
+    {
+      flush();
+    }
+
+    // Adafruit drew each span with writeLine(x, y, x, y + h - 1), so one with
+    // h <= 0 covers the rows from y + h - 1 down to y instead of none (and
+    // likewise for w <= 0).  The ends of a fillRoundRect() whose radius is
+    // half its height rely on that for their outermost column.
+    void add(int16_t x, int16_t y, int16_t w, int16_t h)
+    {
+      if (h <= 0) {
+        y += h - 1;
+        h = 2 - h;
+      }
+      if (w <= 0) {
+        x += w - 1;
+        w = 2 - w;
+      }
+      if (x == m_x && w == m_w && (y == m_y + m_h || y + h == m_y)) {
+        m_y = y < m_y ? y : m_y;
+        m_h += h;
+        return;
+      }
+      if (y == m_y && h == m_h && (x == m_x + m_w || x + w == m_x)) {
+        m_x = x < m_x ? x : m_x;
+        m_w += w;
+        return;
+      }
+      flush();
+      m_x = x;
+      m_y = y;
+      m_w = w;
+      m_h = h;
+    }
+
+    void flush()
+    {
+      if (m_w <= 0) {
+        return;
+      }
+      if (m_h == 1) {
+        m_pSink->writeFastHLine(m_x, m_y, m_w, m_color);
+      } else if (m_w == 1) {
+        m_pSink->writeFastVLine(m_x, m_y, m_h, m_color);
+      } else {
+        m_pSink->writeFillRect(m_x, m_y, m_w, m_h, m_color);
+      }
+      m_w = m_h = 0;
+    }
+
+  protected:
+    Sink*    m_pSink;
+    uint16_t m_color;
+    int16_t  m_x;
+    int16_t  m_y;
+    int16_t  m_w;
+    int16_t  m_h;
+};
+
+
+static inline void gfxSwap(int16_t& a, int16_t& b)
+{
+  int16_t t = a;
+  a = b;
+  b = t;
+}
+
+// Bresenham's line, sent as one run for each row of a shallow line or each
+// column of a steep one.
+template<class Sink>
+void gfxWriteLine(Sink* pSink, int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    gfxSwap(x0, y0);
+    gfxSwap(x1, y1);
+  }
+  if (x0 > x1) {
+    gfxSwap(x0, x1);
+    gfxSwap(y0, y1);
+  }
+
+  int16_t dx = x1 - x0;
+  int16_t dy = abs(y1 - y0);
+  int16_t err = dx / 2;
+  int16_t ystep = (y0 < y1) ? 1 : -1;
+  int16_t start = x0;
+
+  for ( ; x0 <= x1 ; x0++) {
+    err -= dy;
+    // The run ends at this pixel if the next one is on another row.
+    if (err < 0 || x0 == x1) {
+      if (steep) {
+        pSink->writeFastVLine(y0, start, x0 - start + 1, color);
+      } else {
+        pSink->writeFastHLine(start, y0, x0 - start + 1, color);
+      }
+      start = x0 + 1;
+    }
+    if (err < 0) {
+      y0 += ystep;
+      err += dx;
+    }
+  }
+}
+
+// Runs of the circle octants in the given corners (as for drawCircleHelper())
+// for x offsets xs to xe at offset y.  Runs on either side of an axis are
+// joined into one across it when they start on the axis.
+template<class Sink>
+void gfxCircleRuns(Sink* pSink, int16_t x0, int16_t y0, int16_t xs, int16_t xe, int16_t y, uint8_t corners,
+                   uint16_t color)
+{
+  int16_t length = xe - xs + 1;
+  if (length <= 0) {
+    return;
+  }
+
+  // Rows below and above the centre.
+  if ((corners & 0xC) == 0xC && xs == 0) {
+    pSink->writeFastHLine(x0 - xe, y0 + y, 2 * xe + 1, color);
+  } else {
+    if (corners & 0x4) {
+      pSink->writeFastHLine(x0 + xs, y0 + y, length, color);
+    }
+    if (corners & 0x8) {
+      pSink->writeFastHLine(x0 - xe, y0 + y, length, color);
+    }
+  }
+  if ((corners & 0x3) == 0x3 && xs == 0) {
+    pSink->writeFastHLine(x0 - xe, y0 - y, 2 * xe + 1, color);
+  } else {
+    if (corners & 0x2) {
+      pSink->writeFastHLine(x0 + xs, y0 - y, length, color);
+    }
+    if (corners & 0x1) {
+      pSink->writeFastHLine(x0 - xe, y0 - y, length, color);
+    }
+  }
+
+  // Columns right and left of the centre.
+  if ((corners & 0x6) == 0x6 && xs == 0) {
+    pSink->writeFastVLine(x0 + y, y0 - xe, 2 * xe + 1, color);
+  } else {
+    if (corners & 0x4) {
+      pSink->writeFastVLine(x0 + y, y0 + xs, length, color);
+    }
+    if (corners & 0x2) {
+      pSink->writeFastVLine(x0 + y, y0 - xe, length, color);
+    }
+  }
+  if ((corners & 0x9) == 0x9 && xs == 0) {
+    pSink->writeFastVLine(x0 - y, y0 - xe, 2 * xe + 1, color);
+  } else {
+    if (corners & 0x8) {
+      pSink->writeFastVLine(x0 - y, y0 + xs, length, color);
+    }
+    if (corners & 0x1) {
+      pSink->writeFastVLine(x0 - y, y0 - xe, length, color);
+    }
+  }
+}
+
+// Circle outline of the given corners.  drawCircle() is all four corners with
+// axis set, to include the points on the axes which drawCircleHelper()
+// leaves out.  Each run is sent once the midpoint algorithm steps off its row.
+template<class Sink>
+void gfxWriteCircle(Sink* pSink, int16_t x0, int16_t y0, int16_t r, uint8_t corners, bool axis, uint16_t color)
+{
+  int16_t f = 1 - r;
+  int16_t ddFx = 1;
+  int16_t ddFy = -2 * r;
+  int16_t x = 0;
+  int16_t y = r;
+  int16_t start = axis ? 0 : 1;
+
+  while (x < y) {
+    if (f >= 0) {
+      gfxCircleRuns(pSink, x0, y0, start, x, y, corners, color);
+      start = x + 1;
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+  }
+  gfxCircleRuns(pSink, x0, y0, start, x, y, corners, color);
+}
+
+// Filled quarter circles as for fillCircleHelper().  The columns moving out
+// from the centre are the same height until the edge steps down a row, so
+// each side merges them into rectangles.
+template<class Sink>
+void gfxFillCircle(Sink* pSink, int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color)
+{
+  GfxSpanMerger<Sink> rightInner(pSink, color);
+  GfxSpanMerger<Sink> leftInner(pSink, color);
+  GfxSpanMerger<Sink> rightOuter(pSink, color);
+  GfxSpanMerger<Sink> leftOuter(pSink, color);
+  int16_t             f = 1 - r;
+  int16_t             ddFx = 1;
+  int16_t             ddFy = -2 * r;
+  int16_t             x = 0;
+  int16_t             y = r;
+  int16_t             px = x;
+  int16_t             py = y;
+
+  delta++;
+  while (x < y) {
+    if (f >= 0) {
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    // Avoids drawing some of the columns twice.
+    if (x < (y + 1)) {
+      if (corners & 1) {
+        rightInner.add(x0 + x, y0 - y, 1, 2 * y + delta);
+      }
+      if (corners & 2) {
+        leftInner.add(x0 - x, y0 - y, 1, 2 * y + delta);
+      }
+    }
+    if (y != py) {
+      if (corners & 1) {
+        rightOuter.add(x0 + py, y0 - px, 1, 2 * px + delta);
+      }
+      if (corners & 2) {
+        leftOuter.add(x0 - py, y0 - px, 1, 2 * px + delta);
+      }
+      py = y;
+    }
+    px = x;
+  }
+}
+
+// Filled triangle as for fillTriangle(), with rows of the same width merged
+// into rectangles.
+template<class Sink>
+void gfxFillTriangle(Sink* pSink, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+                     uint16_t color)
+{
+  int16_t a, b, y, last;
+
+  // Sort coordinates by Y order (y2 >= y1 >= y0).
+  if (y0 > y1) {
+    gfxSwap(y0, y1);
+    gfxSwap(x0, x1);
+  }
+  if (y1 > y2) {
+    gfxSwap(y2, y1);
+    gfxSwap(x2, x1);
+  }
+  if (y0 > y1) {
+    gfxSwap(y0, y1);
+    gfxSwap(x0, x1);
+  }
+
+  if (y0 == y2) {
+    // All on the same line.
+    a = b = x0;
+    if (x1 < a) {
+      a = x1;
+    } else if (x1 > b) {
+      b = x1;
+    }
+    if (x2 < a) {
+      a = x2;
+    } else if (x2 > b) {
+      b = x2;
+    }
+    pSink->writeFastHLine(a, y0, b - a + 1, color);
+    return;
+  }
+
+  GfxSpanMerger<Sink> rows(pSink, color);
+  int16_t             dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+  int32_t             sa = 0, sb = 0;
+
+  // Upper part from the crossings of edges 0-1 and 0-2.  Includes scanline
+  // y1 if the triangle is flat bottomed, otherwise it is left for the lower
+  // part, which also avoids dividing by 0 when it is flat topped.
+  last = (y1 == y2) ? y1 : y1 - 1;
+  for (y = y0 ; y <= last ; y++) {
+    a = x0 + sa / dy01;
+    b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b) {
+      gfxSwap(a, b);
+    }
+    rows.add(a, y, b - a + 1, 1);
+  }
+
+  // Lower part from the crossings of edges 1-2 and 0-2.
+  sa = (int32_t)dx12 * (y - y1);
+  sb = (int32_t)dx02 * (y - y0);
+  for ( ; y <= y2 ; y++) {
+    a = x1 + sa / dy12;
+    b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b) {
+      gfxSwap(a, b);
+    }
+    rows.add(a, y, b - a + 1, 1);
+  }
+}
+
+#endif // _GFX_RASTER_H_
@@ -0,0 +1,106 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "EyeBlob.h"
+#include <string.h>
+
+
+static const uint8_t g_magic[4] = { 'E', 'Y', 'E', 'B' };
+static const uint8_t g_entrySize[EYE_BLOB_SECTION_COUNT] = { 2, 2, 2, 1, 1, 1, 1 };
+
+static uint16_t getU16(const uint8_t* pBuffer)
+{
+  return pBuffer[0] | (pBuffer[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* pBuffer)
+{
+  return getU16(pBuffer) | ((uint32_t)getU16(pBuffer + 2) << 16);
+}
+
+
+// ----------------------------------------------------------
+EyeBlob::EyeBlob()
+{
+  open(NULL, 0, false);
+}
+
+EyeBlob::EyeBlob(const void* pBlob, uint32_t size, bool symmetrical)
+{
+  open(pBlob, size, symmetrical);
+}
+
+bool EyeBlob::open(const void* pBlob, uint32_t size, bool symmetrical)
+{
+  const uint8_t* pBytes = (const uint8_t*)pBlob;
+
+  memset(m_pTable, 0, sizeof(m_pTable));
+  memset(m_width, 0, sizeof(m_width));
+  memset(m_height, 0, sizeof(m_height));
+  memset(m_name, 0, sizeof(m_name));
+  m_irisMin = 0;
+  m_irisMax = 0;
+  m_isValid = false;
+
+  if (!pBytes || size < EYE_BLOB_HEADER_SIZE || memcmp(pBytes, g_magic, sizeof(g_magic)) != 0 ||
+      getU16(pBytes + 4) != EYE_BLOB_VERSION || getU16(pBytes + 6) != EYE_BLOB_HEADER_SIZE ||
+      getU16(pBytes + 28) != EYE_BLOB_SECTION_COUNT) {
+    return false;
+  }
+
+  for (int i = 0 ; i < EYE_BLOB_SECTION_COUNT ; i++) {
+    const uint8_t* pSection = pBytes + 32 + i * 12;
+    uint32_t       offset = getU32(pSection);
+    uint16_t       width = getU16(pSection + 4);
+    uint16_t       height = getU16(pSection + 6);
+
+    // Only the symmetrical eyelids are optional.
+    if (width == 0 && i >= EYE_BLOB_SYMMETRICAL_UPPER) {
+      continue;
+    }
+    if (width == 0 || height == 0 || pSection[8] != g_entrySize[i] || offset % EYE_BLOB_ALIGNMENT ||
+        offset < EYE_BLOB_HEADER_SIZE || offset > size ||
+        (uint64_t)width * height * g_entrySize[i] > size - offset) { // Can exceed 32 bits
+      return false;
+    }
+    m_pTable[i] = pBytes + offset;
+    m_width[i] = width;
+    m_height[i] = height;
+  }
+
+  // The symmetrical eyelids stand in for the others when asked for.
+  for (int i = EYE_BLOB_UPPER ; i <= EYE_BLOB_LOWER ; i++) {
+    int symmetricalSection = i - EYE_BLOB_UPPER + EYE_BLOB_SYMMETRICAL_UPPER;
+    if (symmetrical && m_pTable[symmetricalSection]) {
+      m_pTable[i] = m_pTable[symmetricalSection];
+      m_width[i] = m_width[symmetricalSection];
+      m_height[i] = m_height[symmetricalSection];
+    }
+  }
+
+  // Same constraints as the kernel in eyeRender.h puts on the headers.
+  if (m_width[EYE_BLOB_LOWER] != m_width[EYE_BLOB_UPPER] ||
+      m_height[EYE_BLOB_LOWER] != m_height[EYE_BLOB_UPPER] ||
+      m_width[EYE_BLOB_SCLERA] < m_width[EYE_BLOB_UPPER] ||
+      m_height[EYE_BLOB_SCLERA] < m_height[EYE_BLOB_UPPER] ||
+      m_width[EYE_BLOB_SCLERA] < m_width[EYE_BLOB_POLAR] ||
+      m_height[EYE_BLOB_SCLERA] < m_height[EYE_BLOB_POLAR]) {
+    return false;
+  }
+
+  memcpy(m_name, pBytes + 8, EYE_BLOB_NAME_SIZE);
+  m_irisMin = getU16(pBytes + 24);
+  m_irisMax = getU16(pBytes + 26);
+  m_isValid = m_irisMin <= m_irisMax && m_irisMax <= 1023;
+  return m_isValid;
+}
@@ -0,0 +1,107 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Binary eye asset: the tables of one of the graphics/*Eye.h headers packed
+// into a single blob which is used in place, from flash in the firmware or
+// from an mmap()ed file on the host.
+//
+// The blob is a 128 byte header followed by the tables, all values little
+// endian:
+//   0    'E' 'Y' 'E' 'B'
+//   4    version (u16, 1)
+//   6    header size (u16, 128)
+//   8    name of the eye (16 bytes, NUL padded)
+//   24   IRIS_MIN, IRIS_MAX (u16 each)
+//   28   section count (u16, EYE_BLOB_SECTION_COUNT), 2 reserved bytes
+//   32   EYE_BLOB_SECTION_COUNT 12 byte sections in EyeBlobSection order:
+//          offset (u32) of the table from the start of the blob, width and
+//          height (u16 each), entry size in bytes (u8) and 3 reserved bytes.
+//   116  12 reserved bytes
+// Each table starts on an EYE_BLOB_ALIGNMENT byte boundary with its rows
+// packed together.  The symmetrical eyelid sections have a width of 0 if the
+// eye only has one set of eyelids.
+//
+// Nothing in here depends on mbed so that it can also be used by host tools.
+#ifndef _EYE_BLOB_H_
+#define _EYE_BLOB_H_
+
+#include <stdint.h>
+
+
+#define EYE_BLOB_VERSION     1
+#define EYE_BLOB_HEADER_SIZE 128
+#define EYE_BLOB_ALIGNMENT   16
+#define EYE_BLOB_NAME_SIZE   16
+
+enum EyeBlobSection {
+  EYE_BLOB_SCLERA,
+  EYE_BLOB_IRIS,
+  EYE_BLOB_POLAR,
+  EYE_BLOB_UPPER,
+  EYE_BLOB_LOWER,
+  EYE_BLOB_SYMMETRICAL_UPPER,
+  EYE_BLOB_SYMMETRICAL_LOWER,
+  EYE_BLOB_SECTION_COUNT
+};
+
+
+class EyeBlob
+{
+  public:
+    EyeBlob();
+    EyeBlob(const void* pBlob, uint32_t size, bool symmetrical);
+
+    // Fails if the blob is truncated, isn't of this version or its tables
+    // don't fit together.  symmetrical picks which of the eyelid sections
+    // EYE_BLOB_UPPER and EYE_BLOB_LOWER refer to.
+    bool        open(const void* pBlob, uint32_t size, bool symmetrical);
+
+    bool        isValid() const { return m_isValid; }
+    const char* name() const { return m_name; }
+    uint16_t    irisMin() const { return m_irisMin; }
+    uint16_t    irisMax() const { return m_irisMax; }
+    uint16_t    width(EyeBlobSection section) const { return m_width[section]; }
+    uint16_t    height(EyeBlobSection section) const { return m_height[section]; }
+    const void* table(EyeBlobSection section) const { return m_pTable[section]; }
+
+  protected:
+    const void* m_pTable[EYE_BLOB_SECTION_COUNT];
+    uint16_t    m_width[EYE_BLOB_SECTION_COUNT];
+    uint16_t    m_height[EYE_BLOB_SECTION_COUNT];
+    uint16_t    m_irisMin;
+    uint16_t    m_irisMax;
+    char        m_name[EYE_BLOB_NAME_SIZE + 1];
+    bool        m_isValid;
+};
+
+
+// Indexes a table of an EyeBlob like the 2-dimensional arrays in the
+// graphics/*Eye.h headers.
+template<class T>
+class EyeBlobTable
+{
+  public:
+    EyeBlobTable(const EyeBlob* pBlob, EyeBlobSection section) : m_pBlob(pBlob), m_section(section) {}
+
+    const T* operator[](uint32_t row) const
+    {
+      return (const T*)m_pBlob->table(m_section) + row * m_pBlob->width(m_section);
+    }
+
+  protected:
+    const EyeBlob* m_pBlob;
+    EyeBlobSection m_section;
+};
+
+#endif // _EYE_BLOB_H_
@@ -0,0 +1,58 @@
+//--------------------------------------------------------------------------
+// Stands in for one of the graphics/*Eye.h headers, binding the names that
+// main.cpp and eyeRender.h use for an eye's tables and dimensions to the
+// tables of g_eyeBlob, a binary eye asset packed by the host eyePack tool.
+// This keeps the thousands of lines of hex in those headers out of the
+// build of main.cpp.
+//
+// With EYE_BLOB_FILE defined (normally in config.h), that file is linked
+// into flash with .incbin, relative to the directory the compiler is run
+// from, and g_eyeBlob is defined here.  Otherwise the includer must define
+// g_eyeBlob and open() it before rendering.
+//
+// The dimensions are only known at runtime so can't be used in #if.
+//--------------------------------------------------------------------------
+#ifndef _EYE_BLOB_TABLES_H_
+#define _EYE_BLOB_TABLES_H_
+
+#include <EyeBlob.h>
+
+#ifdef SYMMETRICAL_EYELID
+  #define EYE_BLOB_SYMMETRICAL true
+#else
+  #define EYE_BLOB_SYMMETRICAL false
+#endif
+
+#ifdef EYE_BLOB_FILE
+__asm__(".section .rodata.eyeBlob, \"a\"\n"
+        ".balign 16\n"
+        ".global g_eyeBlobData\n"
+        "g_eyeBlobData:\n"
+        ".incbin \"" EYE_BLOB_FILE "\"\n"
+        ".global g_eyeBlobDataEnd\n"
+        "g_eyeBlobDataEnd:\n"
+        ".previous\n");
+extern "C" const uint8_t g_eyeBlobData[];
+extern "C" const uint8_t g_eyeBlobDataEnd[];
+
+static EyeBlob g_eyeBlob(g_eyeBlobData, g_eyeBlobDataEnd - g_eyeBlobData, EYE_BLOB_SYMMETRICAL);
+#endif // EYE_BLOB_FILE
+
+#define IRIS_MIN        g_eyeBlob.irisMin()
+#define IRIS_MAX        g_eyeBlob.irisMax()
+#define SCLERA_WIDTH    g_eyeBlob.width(EYE_BLOB_SCLERA)
+#define SCLERA_HEIGHT   g_eyeBlob.height(EYE_BLOB_SCLERA)
+#define IRIS_MAP_WIDTH  g_eyeBlob.width(EYE_BLOB_IRIS)
+#define IRIS_MAP_HEIGHT g_eyeBlob.height(EYE_BLOB_IRIS)
+#define SCREEN_WIDTH    g_eyeBlob.width(EYE_BLOB_UPPER)
+#define SCREEN_HEIGHT   g_eyeBlob.height(EYE_BLOB_UPPER)
+#define IRIS_WIDTH      g_eyeBlob.width(EYE_BLOB_POLAR)
+#define IRIS_HEIGHT     g_eyeBlob.height(EYE_BLOB_POLAR)
+
+static const EyeBlobTable<uint16_t> sclera(&g_eyeBlob, EYE_BLOB_SCLERA);
+static const EyeBlobTable<uint16_t> iris(&g_eyeBlob, EYE_BLOB_IRIS);
+static const EyeBlobTable<uint16_t> polar(&g_eyeBlob, EYE_BLOB_POLAR);
+static const EyeBlobTable<uint8_t>  upper(&g_eyeBlob, EYE_BLOB_UPPER);
+static const EyeBlobTable<uint8_t>  lower(&g_eyeBlob, EYE_BLOB_LOWER);
+
+#endif // _EYE_BLOB_TABLES_H_
@@ -0,0 +1,64 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "ControlPort.h"
+
+
+ControlPort::ControlPort(PinName txPin, PinName rxPin, int baudRate, Timer* pTimer) :
+  m_serial(txPin, rxPin)
+{
+  m_pTimer = pTimer;
+  m_lastByteTime = 0;
+  m_droppedCount = 0;
+  m_key = -1;
+  m_serial.baud(baudRate);
+  m_serial.attach(this, &ControlPort::rxInterrupt, Serial::RxIrq);
+}
+
+int ControlPort::fetchKey()
+{
+  // Keep the receive interrupt from storing a new key between the read and
+  // the clear, which would lose it.
+  __disable_irq();
+  int key = m_key;
+  m_key = -1;
+  __enable_irq();
+  return key;
+}
+
+void ControlPort::rxInterrupt()
+{
+  while (m_serial.readable()) {
+    uint8_t  byte = m_serial.getc();
+    uint32_t now = m_pTimer->read_us();
+
+    if (now - m_lastByteTime > CONTROL_BYTE_TIMEOUT_US) {
+      m_parser.timeout();
+    }
+    m_lastByteTime = now;
+
+    switch (m_parser.parse(byte, &m_command)) {
+    case ControlParser::CONTROL_COMMAND:
+      m_command.timestamp = now;
+      if (!m_mailbox.post(m_command)) {
+        m_droppedCount++;
+      }
+      break;
+    case ControlParser::CONTROL_STRAY:
+      m_key = byte;
+      break;
+    case ControlParser::CONTROL_PENDING:
+      break;
+    }
+  }
+}
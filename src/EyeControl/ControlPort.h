@@ -0,0 +1,54 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// UART which receives control commands in its RX interrupt and hands them to
+// the main loop through a lock free mailbox.
+#ifndef _CONTROL_PORT_H_
+#define _CONTROL_PORT_H_
+
+#include <mbed.h>
+#include "ControlProtocol.h"
+
+
+class ControlPort
+{
+  public:
+    // pTimer is used to timestamp each command as it is received.
+    ControlPort(PinName txPin, PinName rxPin, int baudRate, Timer* pTimer);
+
+    // Called from the main loop to fetch the next received command.
+    bool fetch(ControlCommand* pCommand) { return m_mailbox.fetch(pCommand); }
+
+    // Returns the last byte received outside of a command frame (or -1 if
+    // none) so that the port can also be used for single key console commands.
+    // Safe to call while the receive interrupt is active.
+    int  fetchKey();
+
+    uint32_t droppedCount() const { return m_droppedCount; }
+    uint32_t errorCount() const { return m_parser.errorCount(); }
+
+  protected:
+    void rxInterrupt();
+
+    Serial            m_serial;
+    ControlParser     m_parser;
+    ControlMailbox    m_mailbox;
+    ControlCommand    m_command;
+    Timer*            m_pTimer;
+    uint32_t          m_lastByteTime;
+    volatile uint32_t m_droppedCount;
+    volatile int      m_key;
+};
+
+#endif // _CONTROL_PORT_H_
@@ -0,0 +1,130 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "ControlProtocol.h"
+
+
+uint8_t controlCrc8(uint8_t crc, uint8_t byte)
+{
+  crc ^= byte;
+  for (int i = 0 ; i < 8 ; i++) {
+    crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : (crc << 1);
+  }
+  return crc;
+}
+
+uint8_t controlPayloadU8(const ControlCommand* pCommand, uint8_t offset)
+{
+  if (offset >= pCommand->length) {
+    return 0;
+  }
+  return pCommand->payload[offset];
+}
+
+uint16_t controlPayloadU16(const ControlCommand* pCommand, uint8_t offset)
+{
+  return controlPayloadU8(pCommand, offset) | (controlPayloadU8(pCommand, offset + 1) << 8);
+}
+
+uint32_t controlEncode(uint8_t id, const uint8_t* pPayload, uint8_t length, uint8_t* pBuffer)
+{
+  uint8_t  crc = 0;
+  uint32_t i = 0;
+
+  if (length > CONTROL_MAX_PAYLOAD) {
+    return 0;
+  }
+
+  pBuffer[i++] = CONTROL_SYNC;
+  pBuffer[i++] = id;
+  crc = controlCrc8(crc, id);
+  pBuffer[i++] = length;
+  crc = controlCrc8(crc, length);
+  for (uint8_t j = 0 ; j < length ; j++) {
+    pBuffer[i++] = pPayload[j];
+    crc = controlCrc8(crc, pPayload[j]);
+  }
+  pBuffer[i++] = crc;
+
+  return i;
+}
+
+
+// ----------------------------------------------------------
+ControlParser::ControlParser()
+{
+  m_errorCount = 0;
+  reset();
+}
+
+void ControlParser::reset()
+{
+  m_state = STATE_SYNC;
+  m_index = 0;
+  m_crc = 0;
+}
+
+void ControlParser::timeout()
+{
+  if (m_state != STATE_SYNC) {
+    m_errorCount++;
+    reset();
+  }
+}
+
+ControlParser::Result ControlParser::parse(uint8_t byte, ControlCommand* pCommand)
+{
+  switch (m_state) {
+  case STATE_SYNC:
+    if (byte != CONTROL_SYNC) {
+      return CONTROL_STRAY;
+    }
+    m_crc = 0;
+    m_state = STATE_ID;
+    break;
+  case STATE_ID:
+    m_command.id = byte;
+    m_crc = controlCrc8(m_crc, byte);
+    m_state = STATE_LENGTH;
+    break;
+  case STATE_LENGTH:
+    if (byte > CONTROL_MAX_PAYLOAD) {
+      m_errorCount++;
+      reset();
+      break;
+    }
+    m_command.length = byte;
+    m_crc = controlCrc8(m_crc, byte);
+    m_index = 0;
+    m_state = byte ? STATE_PAYLOAD : STATE_CRC;
+    break;
+  case STATE_PAYLOAD:
+    m_command.payload[m_index++] = byte;
+    m_crc = controlCrc8(m_crc, byte);
+    if (m_index >= m_command.length) {
+      m_state = STATE_CRC;
+    }
+    break;
+  case STATE_CRC:
+    if (byte != m_crc) {
+      m_errorCount++;
+      reset();
+      break;
+    }
+    *pCommand = m_command;
+    reset();
+    return CONTROL_COMMAND;
+  }
+
+  return CONTROL_PENDING;
+}
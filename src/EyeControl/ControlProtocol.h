@@ -0,0 +1,156 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Compact framed serial protocol used to control the eyes externally (from a
+// puppeteer, tracker, etc).  Each command is sent as:
+//   0xA5        Sync byte.
+//   id          One of the CONTROL_CMD_* values below.
+//   length      Number of payload bytes (0 - CONTROL_MAX_PAYLOAD).
+//   payload     Command specific parameters, multi-byte values little endian.
+//   crc         CRC-8 (polynomial 0x07) of the id, length and payload bytes.
+//
+// Bytes received outside of a frame are ignored by the parser but reported
+// back to the caller so that single key console commands still work.
+//
+// The bytes of a frame must follow each other within CONTROL_BYTE_TIMEOUT_US.
+// A longer gap abandons the partial frame so that a dropped byte can't leave
+// the parser misaligned with the commands which follow it.
+//
+// Nothing in here depends on mbed so that it can also be used by host tools.
+#ifndef _CONTROL_PROTOCOL_H_
+#define _CONTROL_PROTOCOL_H_
+
+#include <stdint.h>
+
+
+#define CONTROL_SYNC        0xA5
+#define CONTROL_MAX_PAYLOAD 8
+// Longest encoded command: sync + id + length + payload + crc.
+#define CONTROL_MAX_FRAME   (CONTROL_MAX_PAYLOAD + 4)
+// Longest allowed gap between two bytes of the same frame.
+#define CONTROL_BYTE_TIMEOUT_US 10000
+
+// Commands.
+#define CONTROL_CMD_GAZE    0x01 // x:u16 (0-1023), y:u16 (0-1023), moveTime:u16 (ms)
+#define CONTROL_CMD_BLINK   0x02 // eyeMask:u8 (0 = all eyes), duration:u16 (ms, 0 = default)
+#define CONTROL_CMD_IRIS    0x03 // scale:u16 (0-1023)
+#define CONTROL_CMD_RELEASE 0x04 // Return to autonomous behavior immediately.
+#define CONTROL_CMD_STATS   0x05 // Dump frame time/latency histograms and profile.
+#define CONTROL_CMD_RESET   0x06 // Clear the statistics.
+
+
+typedef struct {
+  uint32_t timestamp;                     // micros() when the command was received
+  uint8_t  id;                            // CONTROL_CMD_*
+  uint8_t  length;                        // Number of valid bytes in payload
+  uint8_t  payload[CONTROL_MAX_PAYLOAD];
+} ControlCommand;
+
+// Fetches a little endian 16-bit value from a command's payload.  Bytes past
+// the end of the payload read as 0.
+uint16_t controlPayloadU16(const ControlCommand* pCommand, uint8_t offset);
+uint8_t  controlPayloadU8(const ControlCommand* pCommand, uint8_t offset);
+
+// Encodes a command into pBuffer (at least CONTROL_MAX_FRAME bytes) and returns
+// the number of bytes to send.
+uint32_t controlEncode(uint8_t id, const uint8_t* pPayload, uint8_t length, uint8_t* pBuffer);
+
+uint8_t  controlCrc8(uint8_t crc, uint8_t byte);
+
+
+// Byte at a time decoder for the framed protocol.  Small and allocation free
+// so that it can be run from the UART receive interrupt.
+class ControlParser
+{
+  public:
+    enum Result {
+      CONTROL_PENDING,  // Byte consumed, no complete command yet.
+      CONTROL_COMMAND,  // A complete command was decoded into *pCommand.
+      CONTROL_STRAY     // Byte received outside of a frame (console key?).
+    };
+
+    ControlParser();
+
+    void     reset();
+    Result   parse(uint8_t byte, ControlCommand* pCommand);
+    // Discards a partially received frame (counted as an error), called when
+    // the sender went quiet for longer than CONTROL_BYTE_TIMEOUT_US.
+    void     timeout();
+    // Number of frames discarded due to bad length, CRC or timeout.
+    uint32_t errorCount() const { return m_errorCount; }
+
+  protected:
+    enum State {
+      STATE_SYNC,
+      STATE_ID,
+      STATE_LENGTH,
+      STATE_PAYLOAD,
+      STATE_CRC
+    };
+
+    ControlCommand m_command;
+    uint32_t       m_errorCount;
+    uint8_t        m_state;
+    uint8_t        m_index;
+    uint8_t        m_crc;
+};
+
+
+// Lock free single-producer/single-consumer queue of commands.  The receive
+// interrupt posts and frame() fetches, neither side ever blocks or allocates.
+#define CONTROL_MAILBOX_SIZE 8 // Must be a power of 2.
+
+class ControlMailbox
+{
+  public:
+    ControlMailbox() : m_head(0), m_tail(0)
+    {
+    }
+
+    // Producer side.  Returns false (and drops the command) if full.
+    bool post(const ControlCommand& command)
+    {
+      uint32_t head = m_head;
+      if (head - m_tail >= CONTROL_MAILBOX_SIZE) {
+        return false;
+      }
+      m_slots[head & (CONTROL_MAILBOX_SIZE - 1)] = command;
+      // Make sure the slot is written before the consumer can see it.
+      __sync_synchronize();
+      m_head = head + 1;
+      return true;
+    }
+
+    // Consumer side.  Returns false if there are no commands waiting.
+    bool fetch(ControlCommand* pCommand)
+    {
+      uint32_t tail = m_tail;
+      if (tail == m_head) {
+        return false;
+      }
+      __sync_synchronize();
+      *pCommand = m_slots[tail & (CONTROL_MAILBOX_SIZE - 1)];
+      // Make sure the slot has been read before the producer can reuse it.
+      __sync_synchronize();
+      m_tail = tail + 1;
+      return true;
+    }
+
+  protected:
+    ControlCommand    m_slots[CONTROL_MAILBOX_SIZE];
+    volatile uint32_t m_head;
+    volatile uint32_t m_tail;
+};
+
+#endif // _CONTROL_PROTOCOL_H_
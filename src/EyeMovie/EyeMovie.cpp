@@ -0,0 +1,340 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "EyeMovie.h"
+#include <string.h>
+
+
+static const uint8_t g_magic[4] = { 'E', 'Y', 'M', 'V' };
+
+static void putU16(uint8_t* pBuffer, uint16_t value)
+{
+  pBuffer[0] = value;
+  pBuffer[1] = value >> 8;
+}
+
+static void putU32(uint8_t* pBuffer, uint32_t value)
+{
+  putU16(pBuffer, value);
+  putU16(pBuffer + 2, value >> 16);
+}
+
+static uint16_t getU16(const uint8_t* pBuffer)
+{
+  return pBuffer[0] | (pBuffer[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* pBuffer)
+{
+  return getU16(pBuffer) | ((uint32_t)getU16(pBuffer + 2) << 16);
+}
+
+
+// ----------------------------------------------------------
+EyeMovieWriter::EyeMovieWriter()
+{
+  m_pFile = NULL;
+  m_pBuffer = NULL;
+  m_count = 0;
+  m_width = 0;
+  m_height = 0;
+  m_bytes = 0;
+  m_spans = 0;
+  m_pixels = 0;
+}
+
+EyeMovieWriter::~EyeMovieWriter()
+{
+  close();
+}
+
+bool EyeMovieWriter::open(const char* pFilename, uint8_t eyeCount, uint16_t width, uint16_t height)
+{
+  uint8_t header[EYE_MOVIE_HEADER_SIZE];
+
+  close();
+  if (width == 0 || width > EYE_MOVIE_MAX_SPAN || height == 0 || height > 256) {
+    return false;
+  }
+  m_pFile = fopen(pFilename, "wb");
+  if (!m_pFile) {
+    return false;
+  }
+
+  memcpy(header, g_magic, sizeof(g_magic));
+  putU16(&header[4], EYE_MOVIE_VERSION);
+  header[6] = eyeCount;
+  header[7] = 0;
+  putU16(&header[8], width);
+  putU16(&header[10], height);
+  putU32(&header[12], 0);
+  if (fwrite(header, sizeof(header), 1, m_pFile) != 1) {
+    close();
+    return false;
+  }
+
+  // Worst case is a span for every other pixel, each a 1 pixel literal.
+  m_pBuffer = new uint8_t[height * (width / 2 + 1) * (EYE_MOVIE_SPAN_SIZE + 3)];
+  m_width = width;
+  m_height = height;
+  m_count = 0;
+  m_bytes = sizeof(header);
+  m_spans = 0;
+  m_pixels = 0;
+  return true;
+}
+
+bool EyeMovieWriter::write(uint32_t t, uint8_t eye, const uint16_t* pFrame, const uint16_t* pPrevious)
+{
+  uint8_t  packet[EYE_MOVIE_PACKET_SIZE];
+  uint32_t size = 0;
+  uint32_t spanCount = 0;
+
+  if (!m_pFile) {
+    return false;
+  }
+
+  for (uint32_t y = 0 ; y < m_height ; y++) {
+    const uint16_t* pRow = &pFrame[y * m_width];
+    const uint16_t* pPreviousRow = pPrevious ? &pPrevious[y * m_width] : NULL;
+    uint32_t        x = 0;
+
+    while (x < m_width) {
+      if (pPreviousRow && pRow[x] == pPreviousRow[x]) {
+        x++;
+        continue;
+      }
+
+      // Extend the span over changed pixels and short gaps between them.
+      uint32_t start = x;
+      uint32_t end = x + 1;
+      for (x = end ; x < m_width && x - end <= EYE_MOVIE_MERGE_GAP && x - start < EYE_MOVIE_MAX_SPAN ; x++) {
+        if (!pPreviousRow || pRow[x] != pPreviousRow[x]) {
+          end = x + 1;
+        }
+      }
+      size += encodeSpan(&m_pBuffer[size], &pRow[start], start, y, end - start);
+      spanCount++;
+      m_pixels += end - start;
+      x = end;
+    }
+  }
+
+  putU32(&packet[0], t);
+  packet[4] = eye;
+  packet[5] = 0;
+  putU16(&packet[6], spanCount);
+  putU32(&packet[8], size);
+  if (fwrite(packet, sizeof(packet), 1, m_pFile) != 1 ||
+      (size && fwrite(m_pBuffer, size, 1, m_pFile) != 1)) {
+    return false;
+  }
+  m_count++;
+  m_bytes += sizeof(packet) + size;
+  m_spans += spanCount;
+  return true;
+}
+
+uint32_t EyeMovieWriter::encodeSpan(uint8_t* pBuffer, const uint16_t* pPixels, uint32_t x, uint32_t y,
+                                    uint32_t length)
+{
+  uint8_t* pStart = pBuffer;
+  uint32_t i = 0;
+
+  *pBuffer++ = x;
+  *pBuffer++ = y;
+  *pBuffer++ = length - 1;
+  while (i < length) {
+    uint32_t run = 1;
+    while (i + run < length && run < EYE_MOVIE_MAX_RUN && pPixels[i + run] == pPixels[i]) {
+      run++;
+    }
+    if (run >= 2) {
+      *pBuffer++ = 0x80 | (run - 1);
+      putU16(pBuffer, pPixels[i]);
+      pBuffer += 2;
+      i += run;
+      continue;
+    }
+
+    // Literal up to the next run of 3 or more, for which a run is smaller.
+    uint32_t count = 1;
+    while (i + count < length && count < EYE_MOVIE_MAX_RUN &&
+           !(i + count + 2 < length &&
+             pPixels[i + count] == pPixels[i + count + 1] &&
+             pPixels[i + count] == pPixels[i + count + 2])) {
+      count++;
+    }
+    *pBuffer++ = count - 1;
+    for ( ; count > 0 ; count--, i++) {
+      putU16(pBuffer, pPixels[i]);
+      pBuffer += 2;
+    }
+  }
+  return pBuffer - pStart;
+}
+
+bool EyeMovieWriter::close()
+{
+  bool    result = true;
+  uint8_t count[4];
+
+  if (m_pFile) {
+    putU32(count, m_count);
+    result = fseek(m_pFile, 12, SEEK_SET) == 0 && fwrite(count, sizeof(count), 1, m_pFile) == 1;
+    result = fclose(m_pFile) == 0 && result;
+    m_pFile = NULL;
+  }
+  delete[] m_pBuffer;
+  m_pBuffer = NULL;
+  return result;
+}
+
+
+// ----------------------------------------------------------
+EyeMovieReader::EyeMovieReader()
+{
+  m_pFile = NULL;
+  m_pData = NULL;
+  close();
+}
+
+EyeMovieReader::~EyeMovieReader()
+{
+  close();
+}
+
+bool EyeMovieReader::open(const char* pFilename)
+{
+  close();
+  m_pFile = fopen(pFilename, "rb");
+  if (!m_pFile) {
+    return false;
+  }
+  m_pBuffer = m_buffer;
+  return readHeader();
+}
+
+bool EyeMovieReader::open(const void* pMovie, uint32_t size)
+{
+  close();
+  m_pData = (const uint8_t*)pMovie;
+  m_pBuffer = m_pData;
+  m_bufferEnd = size;
+  return readHeader();
+}
+
+bool EyeMovieReader::readHeader()
+{
+  uint8_t header[EYE_MOVIE_HEADER_SIZE];
+
+  if (!read(header, sizeof(header)) ||
+      memcmp(header, g_magic, sizeof(g_magic)) != 0 ||
+      getU16(&header[4]) != EYE_MOVIE_VERSION) {
+    close();
+    return false;
+  }
+  m_eyeCount = header[6];
+  m_width = getU16(&header[8]);
+  m_height = getU16(&header[10]);
+  m_packetCount = getU32(&header[12]);
+  m_nextPacket = EYE_MOVIE_HEADER_SIZE;
+  return true;
+}
+
+bool EyeMovieReader::readPacket(EyeMoviePacket* pPacket)
+{
+  uint8_t packet[EYE_MOVIE_PACKET_SIZE];
+
+  seek(m_nextPacket);
+  m_spanCount = 0;
+  if (!read(packet, sizeof(packet))) {
+    return false;
+  }
+
+  pPacket->t = getU32(&packet[0]);
+  pPacket->eye = packet[4];
+  pPacket->spanCount = getU16(&packet[6]);
+  pPacket->size = getU32(&packet[8]);
+  m_spanCount = pPacket->spanCount;
+  m_nextPacket = m_position + pPacket->size;
+  return true;
+}
+
+void EyeMovieReader::rewind()
+{
+  m_nextPacket = EYE_MOVIE_HEADER_SIZE;
+  m_spanCount = 0;
+}
+
+void EyeMovieReader::close()
+{
+  if (m_pFile) {
+    fclose(m_pFile);
+    m_pFile = NULL;
+  }
+  m_pData = NULL;
+  m_pBuffer = NULL;
+  m_bufferStart = 0;
+  m_bufferEnd = 0;
+  m_position = 0;
+  m_nextPacket = EYE_MOVIE_HEADER_SIZE;
+  m_packetCount = 0;
+  m_spanCount = 0;
+  m_width = 0;
+  m_height = 0;
+  m_eyeCount = 0;
+}
+
+bool EyeMovieReader::read(void* pBuffer, uint32_t size)
+{
+  uint8_t* pDest = (uint8_t*)pBuffer;
+
+  while (size > 0) {
+    if (m_position >= m_bufferEnd && !fill()) {
+      return false;
+    }
+    uint32_t count = m_bufferEnd - m_position;
+    count = count < size ? count : size;
+    memcpy(pDest, &m_pBuffer[m_position - m_bufferStart], count);
+    pDest += count;
+    m_position += count;
+    size -= count;
+  }
+  return true;
+}
+
+// Reads the next EYE_MOVIE_BUFFER_SIZE bytes of a file.  Movies in memory
+// are already all in the buffer.
+bool EyeMovieReader::fill()
+{
+  if (!m_pFile) {
+    return false;
+  }
+  size_t count = fread(m_buffer, 1, sizeof(m_buffer), m_pFile);
+  m_bufferStart = m_bufferEnd;
+  m_bufferEnd += count;
+  return count > 0;
+}
+
+void EyeMovieReader::seek(uint32_t position)
+{
+  if (!m_pFile || (position >= m_bufferStart && position <= m_bufferEnd)) {
+    m_position = position;
+    return;
+  }
+  fseek(m_pFile, position, SEEK_SET);
+  m_bufferStart = position;
+  m_bufferEnd = position;
+  m_position = position;
+}
@@ -0,0 +1,213 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Pre-rendered eye animation: the frames of each display, encoded as only the
+// pixels which changed since that display's previous frame, so that playing
+// it back costs time in proportion to how much of each frame changed rather
+// than a drawEye() of every pixel.
+//
+// A movie file is a 16 byte header followed by one packet per frame, all
+// values little endian:
+//   header  'E' 'Y' 'M' 'V', version (u16, 1), eye count (u8), a reserved
+//           byte, width and height (u16 each) of the frames and the packet
+//           count (u32).
+//   packet  t (u32, micros from the start of the movie to show it at), eye
+//           (u8), a reserved byte, span count (u16) and the size (u32) of
+//           the spans which follow.
+//   span    x, y and length - 1 (u8 each) of a run of pixels within one row,
+//           then the length pixels run length encoded as control bytes:
+//           0x00-0x7F  followed by (control + 1) RGB565 pixels (u16 each).
+//           0x80-0xFF  followed by one RGB565 pixel to repeat
+//                      (control - 0x80 + 1) times.
+// The first packet for each eye covers the whole frame.
+//
+// Nothing in here depends on mbed so that it can also be used by host tools.
+// The reader plays movies from memory (linked into flash) or from a file
+// (such as one on the mbed's LocalFileSystem).
+#ifndef _EYE_MOVIE_H_
+#define _EYE_MOVIE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+#define EYE_MOVIE_VERSION      1
+#define EYE_MOVIE_HEADER_SIZE  16
+#define EYE_MOVIE_PACKET_SIZE  12
+#define EYE_MOVIE_SPAN_SIZE    3
+#define EYE_MOVIE_MAX_SPAN     256
+#define EYE_MOVIE_MAX_RUN      128
+// Unchanged pixels between two changed ones which are sent anyway rather than
+// starting another span, as that costs a setAddrWindow() of 7 SPI bytes.
+#define EYE_MOVIE_MERGE_GAP    3
+// Bytes read from a file at a time.
+#define EYE_MOVIE_BUFFER_SIZE  256
+
+typedef struct {
+  uint32_t t;
+  uint8_t  eye;
+  uint16_t spanCount;
+  uint32_t size;
+} EyeMoviePacket;
+
+
+class EyeMovieWriter
+{
+  public:
+    EyeMovieWriter();
+    ~EyeMovieWriter();
+
+    bool     open(const char* pFilename, uint8_t eyeCount, uint16_t width, uint16_t height);
+    // Appends the pixels of pFrame (width * height long) which differ from
+    // pPrevious, the last frame written for this eye.  pPrevious is NULL for
+    // the first frame of each eye, which is then written in full.
+    bool     write(uint32_t t, uint8_t eye, const uint16_t* pFrame, const uint16_t* pPrevious);
+    // Fills in the packet count, so the movie isn't valid until it is closed.
+    bool     close();
+
+    bool     isOpen() const { return m_pFile != NULL; }
+    uint32_t count() const { return m_count; }
+    // Totals over the packets written so far.
+    uint64_t bytes() const { return m_bytes; }
+    uint64_t spans() const { return m_spans; }
+    uint64_t pixels() const { return m_pixels; }
+
+  protected:
+    uint32_t encodeSpan(uint8_t* pBuffer, const uint16_t* pPixels, uint32_t x, uint32_t y, uint32_t length);
+
+    FILE*    m_pFile;
+    uint8_t* m_pBuffer;
+    uint32_t m_count;
+    uint16_t m_width;
+    uint16_t m_height;
+    uint64_t m_bytes;
+    uint64_t m_spans;
+    uint64_t m_pixels;
+};
+
+
+class EyeMovieReader
+{
+  public:
+    EyeMovieReader();
+    ~EyeMovieReader();
+
+    // Fail if the movie is missing, truncated or isn't of this version.
+    bool     open(const char* pFilename);
+    bool     open(const void* pMovie, uint32_t size);
+    // Returns false at the end of the movie.  Any spans of the previous
+    // packet which weren't drawn are skipped.
+    bool     readPacket(EyeMoviePacket* pPacket);
+    // Sends the spans of the packet just read to pDisplay, which needs
+    // drawRGBBitmap() like Adafruit_GFX.  Each span is decoded into a row
+    // buffer first so that SSD1351 can send it as one transaction.  Returns
+    // false if the movie is corrupt.
+    template<class Display>
+    bool     drawPacket(Display* pDisplay);
+    // Back to the first packet.
+    void     rewind();
+    void     close();
+
+    bool     isOpen() const { return m_pFile != NULL || m_pData != NULL; }
+    uint8_t  eyeCount() const { return m_eyeCount; }
+    uint16_t width() const { return m_width; }
+    uint16_t height() const { return m_height; }
+    uint32_t packetCount() const { return m_packetCount; }
+
+  protected:
+    bool     readHeader();
+    bool     read(void* pBuffer, uint32_t size);
+    int      readByte()
+    {
+      if (m_position < m_bufferEnd) {
+        return m_pBuffer[m_position++ - m_bufferStart];
+      }
+      return fill() ? m_pBuffer[m_position++ - m_bufferStart] : -1;
+    }
+    int32_t  readPixel()
+    {
+      int lsb = readByte();
+      int msb = readByte();
+      return msb < 0 ? -1 : (lsb | (msb << 8));
+    }
+    bool     fill();
+    void     seek(uint32_t position);
+
+    FILE*          m_pFile;
+    const uint8_t* m_pData;
+    const uint8_t* m_pBuffer;        // m_pData or m_buffer
+    uint32_t       m_bufferStart;    // Movie offset of m_pBuffer[0]
+    uint32_t       m_bufferEnd;      // and of just past its last valid byte
+    uint32_t       m_position;       // Movie offset of the next byte to read
+    uint32_t       m_nextPacket;     // Movie offset of the next packet
+    uint32_t       m_packetCount;
+    uint16_t       m_spanCount;      // Spans of the current packet
+    uint16_t       m_width;
+    uint16_t       m_height;
+    uint8_t        m_eyeCount;
+    uint8_t        m_buffer[EYE_MOVIE_BUFFER_SIZE];
+    uint16_t       m_row[EYE_MOVIE_MAX_SPAN]; // Pixels of the span being drawn
+};
+
+
+template<class Display>
+bool EyeMovieReader::drawPacket(Display* pDisplay)
+{
+  uint8_t span[EYE_MOVIE_SPAN_SIZE];
+
+  for ( ; m_spanCount > 0 ; m_spanCount--) {
+    if (!read(span, sizeof(span))) {
+      return false;
+    }
+
+    uint32_t length = span[2] + 1;
+    if (span[0] + length > m_width || span[1] >= m_height) {
+      return false;
+    }
+    uint16_t* pPixel = m_row;
+    uint16_t* pEnd = m_row + length;
+    while (pPixel < pEnd) {
+      int control = readByte();
+      if (control < 0) {
+        return false;
+      }
+
+      uint32_t count = (control & 0x7F) + 1;
+      if (count > (uint32_t)(pEnd - pPixel)) {
+        return false;
+      }
+      if (control & 0x80) {
+        int32_t pixel = readPixel();
+        if (pixel < 0) {
+          return false;
+        }
+        while (count--) {
+          *pPixel++ = pixel;
+        }
+      } else {
+        while (count--) {
+          int32_t pixel = readPixel();
+          if (pixel < 0) {
+            return false;
+          }
+          *pPixel++ = pixel;
+        }
+      }
+    }
+    pDisplay->drawRGBBitmap(span[0], span[1], m_row, length, 1);
+  }
+  return true;
+}
+
+#endif // _EYE_MOVIE_H_
@@ -0,0 +1,70 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Small pseudo random number generator with an explicit seed.  Each animation
+// subsystem (gaze, blinks, iris) has its own so that a given seed always
+// produces the same animation, and a change to how often one subsystem draws
+// numbers doesn't shift the sequence seen by the others.
+//
+// Nothing in here depends on mbed so that it can also be used by host tools.
+#ifndef _EYE_RANDOM_H_
+#define _EYE_RANDOM_H_
+
+#include <stdint.h>
+
+
+// Marsaglia's 32-bit xorshift.  Period of 2^32 - 1 and 3 shifts + 3 xors per
+// number, which is plenty for picking gaze targets and blink timings.
+class EyeRandom
+{
+  public:
+    EyeRandom(uint32_t seedValue = 1, uint32_t stream = 0)
+    {
+      seed(seedValue, stream);
+    }
+
+    // Different streams from the same seed give unrelated sequences.
+    void seed(uint32_t seedValue, uint32_t stream = 0)
+    {
+      m_state = seedValue ^ (stream * 0x9E3779B9);
+      if (m_state == 0) {
+        m_state = 0x6D2B79F5; // xorshift gets stuck at 0.
+      }
+      // Mix in the seed so that similar seeds don't start out similar.
+      for (int i = 0 ; i < 8 ; i++) {
+        next();
+      }
+    }
+
+    uint32_t next()
+    {
+      uint32_t x = m_state;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      m_state = x;
+      return x;
+    }
+
+    // 0 to range-1, for use in place of rand() % range.
+    int32_t below(int32_t range)
+    {
+      return (int32_t)(next() % (uint32_t)range);
+    }
+
+  protected:
+    uint32_t m_state;
+};
+
+#endif // _EYE_RANDOM_H_
@@ -0,0 +1,173 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "EyeTrace.h"
+#include <string.h>
+
+
+static const uint8_t g_magic[4] = { 'E', 'Y', 'T', 'R' };
+
+static void putU16(uint8_t* pBuffer, uint16_t value)
+{
+  pBuffer[0] = value;
+  pBuffer[1] = value >> 8;
+}
+
+static void putU32(uint8_t* pBuffer, uint32_t value)
+{
+  putU16(pBuffer, value);
+  putU16(pBuffer + 2, value >> 16);
+}
+
+static uint16_t getU16(const uint8_t* pBuffer)
+{
+  return pBuffer[0] | (pBuffer[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* pBuffer)
+{
+  return getU16(pBuffer) | ((uint32_t)getU16(pBuffer + 2) << 16);
+}
+
+
+// ----------------------------------------------------------
+EyeTraceWriter::EyeTraceWriter()
+{
+  m_pFile = NULL;
+  m_count = 0;
+}
+
+EyeTraceWriter::~EyeTraceWriter()
+{
+  close();
+}
+
+bool EyeTraceWriter::open(const char* pFilename, uint32_t seed)
+{
+  uint8_t header[EYE_TRACE_HEADER_SIZE];
+
+  close();
+  m_pFile = fopen(pFilename, "wb");
+  if (!m_pFile) {
+    return false;
+  }
+
+  memcpy(header, g_magic, sizeof(g_magic));
+  header[4] = EYE_TRACE_VERSION;
+  header[5] = EYE_TRACE_RECORD_SIZE;
+  putU16(&header[6], 0);
+  putU32(&header[8], seed);
+  if (fwrite(header, sizeof(header), 1, m_pFile) != 1) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool EyeTraceWriter::write(const EyeTraceRecord& record)
+{
+  uint8_t buffer[EYE_TRACE_RECORD_SIZE];
+
+  if (!m_pFile) {
+    return false;
+  }
+
+  putU32(&buffer[0], record.t);
+  putU16(&buffer[4], record.iScale);
+  buffer[6] = record.eye;
+  buffer[7] = record.scleraX;
+  buffer[8] = record.scleraY;
+  buffer[9] = record.uT;
+  buffer[10] = record.lT;
+  buffer[11] = 0;
+  if (fwrite(buffer, sizeof(buffer), 1, m_pFile) != 1) {
+    return false;
+  }
+  m_count++;
+  return true;
+}
+
+void EyeTraceWriter::close()
+{
+  if (m_pFile) {
+    fclose(m_pFile);
+    m_pFile = NULL;
+  }
+}
+
+
+// ----------------------------------------------------------
+EyeTraceReader::EyeTraceReader()
+{
+  m_pFile = NULL;
+  m_seed = 0;
+}
+
+EyeTraceReader::~EyeTraceReader()
+{
+  close();
+}
+
+bool EyeTraceReader::open(const char* pFilename)
+{
+  uint8_t header[EYE_TRACE_HEADER_SIZE];
+
+  close();
+  m_pFile = fopen(pFilename, "rb");
+  if (!m_pFile) {
+    return false;
+  }
+
+  if (fread(header, sizeof(header), 1, m_pFile) != 1 ||
+      memcmp(header, g_magic, sizeof(g_magic)) != 0 ||
+      header[4] != EYE_TRACE_VERSION ||
+      header[5] != EYE_TRACE_RECORD_SIZE) {
+    close();
+    return false;
+  }
+  m_seed = getU32(&header[8]);
+  return true;
+}
+
+bool EyeTraceReader::read(EyeTraceRecord* pRecord)
+{
+  uint8_t buffer[EYE_TRACE_RECORD_SIZE];
+
+  if (!m_pFile || fread(buffer, sizeof(buffer), 1, m_pFile) != 1) {
+    return false;
+  }
+
+  pRecord->t = getU32(&buffer[0]);
+  pRecord->iScale = getU16(&buffer[4]);
+  pRecord->eye = buffer[6];
+  pRecord->scleraX = buffer[7];
+  pRecord->scleraY = buffer[8];
+  pRecord->uT = buffer[9];
+  pRecord->lT = buffer[10];
+  return true;
+}
+
+void EyeTraceReader::rewind()
+{
+  if (m_pFile) {
+    fseek(m_pFile, EYE_TRACE_HEADER_SIZE, SEEK_SET);
+  }
+}
+
+void EyeTraceReader::close()
+{
+  if (m_pFile) {
+    fclose(m_pFile);
+    m_pFile = NULL;
+  }
+}
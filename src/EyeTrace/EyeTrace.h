@@ -0,0 +1,90 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Record and replay of the inputs that frame() passes to drawEye(), so that
+// performance comparisons can render exactly the same frames every run.
+//
+// A trace file is a 12 byte header followed by one 12 byte record per frame,
+// all values little endian:
+//   header  'E' 'Y' 'T' 'R', version (1), record size (12), 2 reserved bytes,
+//           seed (u32) of the EyeRandom generators which animated the eyes.
+//   record  t (u32, micros animation was evaluated at), iScale (u16), eye,
+//           scleraX, scleraY, upper and lower eyelid thresholds (u8 each) and
+//           a reserved byte.
+//
+// Nothing in here depends on mbed so that it can also be used by host tools.
+#ifndef _EYE_TRACE_H_
+#define _EYE_TRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+#define EYE_TRACE_VERSION     1
+#define EYE_TRACE_HEADER_SIZE 12
+#define EYE_TRACE_RECORD_SIZE 12
+
+typedef struct {
+  uint32_t t;
+  uint16_t iScale;
+  uint8_t  eye;
+  uint8_t  scleraX;
+  uint8_t  scleraY;
+  uint8_t  uT;
+  uint8_t  lT;
+} EyeTraceRecord;
+
+
+class EyeTraceWriter
+{
+  public:
+    EyeTraceWriter();
+    ~EyeTraceWriter();
+
+    bool     open(const char* pFilename, uint32_t seed);
+    bool     write(const EyeTraceRecord& record);
+    void     close();
+
+    bool     isOpen() const { return m_pFile != NULL; }
+    uint32_t count() const { return m_count; }
+
+  protected:
+    FILE*    m_pFile;
+    uint32_t m_count;
+};
+
+
+class EyeTraceReader
+{
+  public:
+    EyeTraceReader();
+    ~EyeTraceReader();
+
+    // Fails if the file is missing or isn't a trace of this version.
+    bool     open(const char* pFilename);
+    // Returns false at the end of the trace.
+    bool     read(EyeTraceRecord* pRecord);
+    // Back to the first record.
+    void     rewind();
+    void     close();
+
+    bool     isOpen() const { return m_pFile != NULL; }
+    uint32_t seed() const { return m_seed; }
+
+  protected:
+    FILE*    m_pFile;
+    uint32_t m_seed;
+};
+
+#endif // _EYE_TRACE_H_
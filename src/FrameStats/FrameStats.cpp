@@ -0,0 +1,171 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "FrameStats.h"
+#include <stdio.h>
+#include <string.h>
+
+
+// ----------------------------------------------------------
+Histogram::Histogram()
+{
+  reset();
+}
+
+void Histogram::reset()
+{
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_count = 0;
+  m_max = 0;
+}
+
+void Histogram::add(uint32_t value)
+{
+  m_buckets[bucketIndex(value)]++;
+  m_count++;
+  if (value > m_max) {
+    m_max = value;
+  }
+}
+
+uint32_t Histogram::percentile(uint32_t percent) const
+{
+  if (m_count == 0) {
+    return 0;
+  }
+
+  uint32_t target = ((uint64_t)m_count * percent + 99) / 100;
+  if (target == 0) {
+    target = 1;
+  }
+
+  uint32_t total = 0;
+  for (uint32_t i = 0 ; i < HISTOGRAM_BUCKETS ; i++) {
+    total += m_buckets[i];
+    if (total >= target) {
+      uint32_t bound = bucketUpperBound(i);
+      return bound < m_max ? bound : m_max;
+    }
+  }
+  return m_max;
+}
+
+uint32_t Histogram::bucketIndex(uint32_t value)
+{
+  if (value < HISTOGRAM_EXACT_BUCKETS) {
+    return value;
+  }
+
+  uint32_t msb = 31 - __builtin_clz(value);
+  uint32_t shift = msb - HISTOGRAM_SUB_BUCKET_BITS;
+  uint32_t subBucket = (value >> shift) & ((1 << HISTOGRAM_SUB_BUCKET_BITS) - 1);
+  uint32_t index = HISTOGRAM_EXACT_BUCKETS +
+                   ((shift - 1) << HISTOGRAM_SUB_BUCKET_BITS) + subBucket;
+  if (index >= HISTOGRAM_BUCKETS) {
+    index = HISTOGRAM_BUCKETS - 1;
+  }
+  return index;
+}
+
+uint32_t Histogram::bucketUpperBound(uint32_t index)
+{
+  if (index < HISTOGRAM_EXACT_BUCKETS) {
+    return index;
+  }
+  if (index == HISTOGRAM_BUCKETS - 1) {
+    return ~0U;
+  }
+
+  index -= HISTOGRAM_EXACT_BUCKETS;
+  uint32_t shift = (index >> HISTOGRAM_SUB_BUCKET_BITS) + 1;
+  uint32_t subBucket = index & ((1 << HISTOGRAM_SUB_BUCKET_BITS) - 1);
+  uint32_t lower = ((1 << HISTOGRAM_SUB_BUCKET_BITS) + subBucket) << shift;
+  return lower + (1 << shift) - 1;
+}
+
+
+// ----------------------------------------------------------
+FrameStats::FrameStats(uint8_t eyeCount)
+{
+  m_eyeCount = eyeCount;
+  m_pEyes = new EyeStats[eyeCount];
+  reset();
+}
+
+FrameStats::~FrameStats()
+{
+  delete[] m_pEyes;
+}
+
+void FrameStats::reset()
+{
+  for (uint8_t e = 0 ; e < m_eyeCount ; e++) {
+    m_pEyes[e].frameTime.reset();
+    m_pEyes[e].latency.reset();
+    m_pEyes[e].eventTime = 0;
+    m_pEyes[e].eventPending = false;
+  }
+}
+
+void FrameStats::postEvent(uint8_t eye, uint32_t timestamp)
+{
+  EyeStats* pEye = &m_pEyes[eye];
+
+  if (pEye->eventPending) {
+    return;
+  }
+  pEye->eventTime = timestamp;
+  pEye->eventPending = true;
+}
+
+void FrameStats::postEventAllEyes(uint32_t timestamp)
+{
+  for (uint8_t e = 0 ; e < m_eyeCount ; e++) {
+    postEvent(e, timestamp);
+  }
+}
+
+void FrameStats::frameDone(uint8_t eye, uint32_t startTime, uint32_t endTime)
+{
+  EyeStats* pEye = &m_pEyes[eye];
+
+  pEye->frameTime.add(endTime - startTime);
+
+  // Events which occurred after work on this frame began can't be reflected
+  // in it so leave them for the next frame.
+  if (pEye->eventPending && (int32_t)(startTime - pEye->eventTime) >= 0) {
+    pEye->latency.add(endTime - pEye->eventTime);
+    pEye->eventPending = false;
+  }
+}
+
+static void printHistogram(const char* pName, const Histogram& histogram)
+{
+  printf(" %-7s %7lu %7lu %7lu %7lu", pName,
+         (unsigned long)histogram.count(),
+         (unsigned long)histogram.percentile(50),
+         (unsigned long)histogram.percentile(99),
+         (unsigned long)histogram.max());
+}
+
+void FrameStats::dump() const
+{
+  printf("eye  stat      count p50(us) p99(us) max(us)\n");
+  for (uint8_t e = 0 ; e < m_eyeCount ; e++) {
+    printf("%3u ", e);
+    printHistogram("frame", m_pEyes[e].frameTime);
+    printf("\n    ");
+    printHistogram("latency", m_pEyes[e].latency);
+    printf("\n");
+  }
+}
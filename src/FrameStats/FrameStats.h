@@ -0,0 +1,99 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Per-eye frame time and motion-to-photon latency histograms.
+//
+// The frame time is measured from the start of frame() until the last pixel
+// of that eye has left the SPI port.  The latency is measured from an input
+// or animation decision (a new gaze target, the start of a blink, a change in
+// light level, etc) until the last pixel of the first frame which reflects
+// that decision has left the SPI port.
+#ifndef _FRAME_STATS_H_
+#define _FRAME_STATS_H_
+
+#include <stdint.h>
+
+
+// Values 0 - 7 each get their own bucket and then every power of 2 above that
+// is split into 4 buckets so that the reported percentiles are always within
+// 25% of the actual value.  Values past 2^25 microseconds (~33 seconds) are
+// lumped into the last bucket.
+#define HISTOGRAM_EXACT_BUCKETS   8
+#define HISTOGRAM_SUB_BUCKET_BITS 2
+#define HISTOGRAM_BUCKETS         96
+
+
+class Histogram
+{
+  public:
+    Histogram();
+
+    void     reset();
+    void     add(uint32_t value);
+
+    uint32_t count() const { return m_count; }
+    uint32_t max() const { return m_max; }
+    // Smallest bucket bound which covers the requested percentage (0 - 100)
+    // of the samples.  Returns 0 if there are no samples.
+    uint32_t percentile(uint32_t percent) const;
+
+  protected:
+    static uint32_t bucketIndex(uint32_t value);
+    static uint32_t bucketUpperBound(uint32_t index);
+
+    uint32_t m_buckets[HISTOGRAM_BUCKETS];
+    uint32_t m_count;
+    uint32_t m_max;
+};
+
+
+class FrameStats
+{
+  public:
+    FrameStats(uint8_t eyeCount);
+    ~FrameStats();
+
+    void reset();
+
+    // Note an input or animation decision made at time 'timestamp' (micros)
+    // which will be reflected in the next frame rendered for this eye.  Only
+    // the oldest unpresented decision is tracked for each eye.
+    void postEvent(uint8_t eye, uint32_t timestamp);
+    void postEventAllEyes(uint32_t timestamp);
+
+    // Called once the last pixel of a frame for this eye has been sent.
+    // 'startTime' is the time at which work on the frame began, with events
+    // posted up to then counted as reflected in it, and 'endTime' the time at
+    // which its transmit completed.
+    void frameDone(uint8_t eye, uint32_t startTime, uint32_t endTime);
+
+    const Histogram& frameTimes(uint8_t eye) const { return m_pEyes[eye].frameTime; }
+    const Histogram& latencies(uint8_t eye) const { return m_pEyes[eye].latency; }
+
+    // Prints p50/p99/max of the frame time and latency for each eye.
+    void dump() const;
+
+  protected:
+    struct EyeStats {
+      Histogram frameTime;
+      Histogram latency;
+      uint32_t  eventTime;
+      bool      eventPending;
+    };
+
+    EyeStats* m_pEyes;
+    uint8_t   m_eyeCount;
+};
+
+#endif // _FRAME_STATS_H_
@@ -0,0 +1,93 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "GfxBenchmark.h"
+
+
+// Shared by every GfxBenchmark rather than a member, to keep it off the stack
+// of the firmware which creates its benchmark there.
+static GlyphCache g_glyphCache;
+
+GfxBenchmark::GfxBenchmark(Adafruit_GFX* pDisplay, Timer* pTimer, GfxByteCounter pByteCounter,
+                           GfxTickCounter pTickCounter)
+{
+  m_pDisplay = pDisplay;
+  m_pTimer = pTimer;
+  m_pByteCounter = pByteCounter;
+  m_pTickCounter = pTickCounter;
+  m_startTime = 0;
+  m_startBytes = 0;
+  m_startTicks = 0;
+  m_time = 0;
+  m_bytes = 0;
+  m_ticks = 0;
+  m_count = 0;
+}
+
+void GfxBenchmark::run()
+{
+  run(m_pDisplay);
+}
+
+GlyphCache* GfxBenchmark::emptyGlyphCache()
+{
+  g_glyphCache.setFont(NULL);
+  return &g_glyphCache;
+}
+
+void GfxBenchmark::printHeader()
+{
+  printf("Benchmark                Time (us)  Count   us/prim");
+  if (m_pByteCounter) {
+    printf("  SPI bytes  bytes/prim");
+  }
+  if (m_pTickCounter) {
+    printf("  ticks/prim");
+  }
+  printf("\n");
+}
+
+void GfxBenchmark::start()
+{
+  m_startBytes = m_pByteCounter ? m_pByteCounter() : 0;
+  m_startTicks = m_pTickCounter ? m_pTickCounter() : 0;
+  m_startTime = m_pTimer->read_us();
+}
+
+void GfxBenchmark::stop(uint32_t count)
+{
+  m_time += m_pTimer->read_us() - m_startTime;
+  m_ticks += m_pTickCounter ? m_pTickCounter() - m_startTicks : 0;
+  m_bytes += m_pByteCounter ? m_pByteCounter() - m_startBytes : 0;
+  m_count += count;
+}
+
+void GfxBenchmark::report(const char* pName)
+{
+  uint32_t count = m_count ? m_count : 1;
+
+  printf("%-24s %9lu %6lu %9lu", pName,
+         (unsigned long)m_time, (unsigned long)m_count, (unsigned long)(m_time / count));
+  if (m_pByteCounter) {
+    printf(" %10lu %11lu", (unsigned long)m_bytes, (unsigned long)(m_bytes / count));
+  }
+  if (m_pTickCounter) {
+    printf(" %11lu", (unsigned long)(m_ticks / count));
+  }
+  printf("\n");
+
+  m_time = 0;
+  m_bytes = 0;
+  m_ticks = 0;
+  m_count = 0;
+}
@@ -0,0 +1,481 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Port of the Adafruit_GFX primitive benchmark from
+// Adafruit-GFX-Library/examples/mock_ili9341 to mbed.  Runs against any
+// Adafruit_GFX display and reports the time and number of SPI bytes taken by
+// each kind of primitive (each character for the text test).  As in the
+// original, only the primitives being measured are timed, not the screen
+// clears and outlines in between.
+//
+// The tests are templates so that they can also be run through other front
+// ends with the same drawing API, such as StaticGfx, to compare them against
+// the virtual calls of Adafruit_GFX.  The text test is also run with an
+// opaque background, and then through a GlyphCache, which always draws to the
+// Adafruit_GFX display whichever front end is being run.  So is the charset
+// test, which prints every character of the classic font with cp437() off
+// and then on.
+#ifndef _GFX_BENCHMARK_H_
+#define _GFX_BENCHMARK_H_
+
+#include <mbed.h>
+#include <Adafruit_GFX.h>
+#include <GlyphCache.h>
+
+
+// Returns the number of bytes sent to the display so far.
+typedef uint32_t (*GfxByteCounter)(void);
+// Returns a free running count of CPU time, such as Profiler::now().
+typedef uint32_t (*GfxTickCounter)(void);
+
+
+// Same colors as ILI9341_* in the original sketch.
+#define GFX_BLACK   0x0000
+#define GFX_BLUE    0x001F
+#define GFX_RED     0xF800
+#define GFX_GREEN   0x07E0
+#define GFX_CYAN    0x07FF
+#define GFX_MAGENTA 0xF81F
+#define GFX_YELLOW  0xFFE0
+#define GFX_WHITE   0xFFFF
+
+
+// Text drawing API of a display printed through a GlyphCache instead, for
+// GfxBenchmark::testText().
+class GfxCachedText
+{
+  public:
+    GfxCachedText(Adafruit_GFX* pDisplay, GlyphCache* pCache) : m_pDisplay(pDisplay), m_pCache(pCache) {}
+
+    void fillScreen(uint16_t color) { m_pDisplay->fillScreen(color); }
+    void setCursor(int16_t x, int16_t y) { m_pDisplay->setCursor(x, y); }
+    void setTextColor(uint16_t c, uint16_t bg) { m_pCache->setTextColor(c, bg); }
+    void setTextSize(uint8_t s) { m_pCache->setTextSize(s); }
+    void cp437(bool x) { m_pCache->cp437(x); }
+    void print(const char* pText) { m_pCache->print(m_pDisplay, pText); }
+
+  protected:
+    Adafruit_GFX* m_pDisplay;
+    GlyphCache*   m_pCache;
+};
+
+
+class GfxBenchmark
+{
+  public:
+    // pByteCounter and pTickCounter can be NULL if the counts aren't
+    // available, in which case their columns are left out.
+    GfxBenchmark(Adafruit_GFX* pDisplay, Timer* pTimer, GfxByteCounter pByteCounter = NULL,
+                 GfxTickCounter pTickCounter = NULL);
+
+    // Runs every test against the display given to the constructor and prints
+    // a table of results.
+    void run();
+    // Runs every test through another front end to the same display.
+    template<class Display>
+    void run(Display* pDisplay);
+
+    template<class Display>
+    void testFillScreen(Display* pDisplay);
+    // Transparent text unless opaque is set, in which case it is drawn over a
+    // black background.
+    template<class Display>
+    void testText(Display* pDisplay, bool opaque);
+    // Every character of the classic font, 16 to a line.
+    template<class Display>
+    void testCharset(Display* pDisplay, bool cp437);
+    template<class Display>
+    void testLines(Display* pDisplay, uint16_t color);
+    template<class Display>
+    void testFastLines(Display* pDisplay, uint16_t color1, uint16_t color2);
+    template<class Display>
+    void testRects(Display* pDisplay, uint16_t color);
+    template<class Display>
+    void testFilledRects(Display* pDisplay, uint16_t color1, uint16_t color2);
+    template<class Display>
+    void testFilledCircles(Display* pDisplay, uint8_t radius, uint16_t color);
+    template<class Display>
+    void testCircles(Display* pDisplay, uint8_t radius, uint16_t color);
+    template<class Display>
+    void testTriangles(Display* pDisplay);
+    template<class Display>
+    void testFilledTriangles(Display* pDisplay);
+    template<class Display>
+    void testRoundRects(Display* pDisplay);
+    template<class Display>
+    void testFilledRoundRects(Display* pDisplay);
+
+  protected:
+    // Bracket the primitives to be measured, count is the number of
+    // primitives drawn between them.
+    void start();
+    void stop(uint32_t count);
+    void printHeader();
+    void report(const char* pName);
+    // Empties the cache, so that each cached text test starts cold.
+    GlyphCache* emptyGlyphCache();
+    // Prints text to the display, returning the number of characters drawn.
+    template<class Display>
+    uint32_t print(Display* pDisplay, const char* pText);
+    static int      minimum(int a, int b) { return a < b ? a : b; }
+    static uint16_t color565(uint8_t r, uint8_t g, uint8_t b)
+    {
+      return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+    static uint16_t background(uint16_t color, bool opaque) { return opaque ? GFX_BLACK : color; }
+
+    Adafruit_GFX*  m_pDisplay;
+    Timer*         m_pTimer;
+    GfxByteCounter m_pByteCounter;
+    GfxTickCounter m_pTickCounter;
+    uint32_t       m_startTime;
+    uint32_t       m_startBytes;
+    uint32_t       m_startTicks;
+    uint32_t       m_time;
+    uint32_t       m_bytes;
+    uint32_t       m_ticks;
+    uint32_t       m_count;
+};
+
+template<class Display>
+void GfxBenchmark::run(Display* pDisplay)
+{
+  m_pTimer->start();
+  printHeader();
+
+  testFillScreen(pDisplay);
+  report("Screen fill");
+  testText(pDisplay, false);
+  report("Text");
+  testText(pDisplay, true);
+  report("Text (opaque)");
+  GfxCachedText cachedText(m_pDisplay, emptyGlyphCache());
+  testText(&cachedText, false);
+  report("Text (glyph cache)");
+  emptyGlyphCache();
+  testText(&cachedText, true);
+  report("Text (cached, opaque)");
+  testCharset(pDisplay, false);
+  report("Charset");
+  testCharset(pDisplay, true);
+  report("Charset (cp437)");
+  testCharset(&cachedText, false);
+  report("Charset (glyph cache)");
+  testCharset(&cachedText, true);
+  report("Charset (cached, cp437)");
+  testLines(pDisplay, GFX_CYAN);
+  report("Lines");
+  testFastLines(pDisplay, GFX_RED, GFX_BLUE);
+  report("Horiz/Vert Lines");
+  testRects(pDisplay, GFX_GREEN);
+  report("Rectangles (outline)");
+  testFilledRects(pDisplay, GFX_YELLOW, GFX_MAGENTA);
+  report("Rectangles (filled)");
+  testFilledCircles(pDisplay, 10, GFX_MAGENTA);
+  report("Circles (filled)");
+  testCircles(pDisplay, 10, GFX_WHITE);
+  report("Circles (outline)");
+  testTriangles(pDisplay);
+  report("Triangles (outline)");
+  testFilledTriangles(pDisplay);
+  report("Triangles (filled)");
+  testRoundRects(pDisplay);
+  report("Rounded rects (outline)");
+  testFilledRoundRects(pDisplay);
+  report("Rounded rects (filled)");
+
+  printf("Done!\n");
+}
+
+template<class Display>
+uint32_t GfxBenchmark::print(Display* pDisplay, const char* pText)
+{
+  uint32_t count = 0;
+
+  pDisplay->print(pText);
+  for ( ; *pText ; pText++) {
+    if (*pText != '\n') {
+      count++;
+    }
+  }
+  return count;
+}
+
+template<class Display>
+void GfxBenchmark::testFillScreen(Display* pDisplay)
+{
+  start();
+  pDisplay->fillScreen(GFX_BLACK);
+  pDisplay->fillScreen(GFX_RED);
+  pDisplay->fillScreen(GFX_GREEN);
+  pDisplay->fillScreen(GFX_BLUE);
+  pDisplay->fillScreen(GFX_BLACK);
+  stop(5);
+}
+
+template<class Display>
+void GfxBenchmark::testText(Display* pDisplay, bool opaque)
+{
+  static const char* const lines[] = {
+    "my foonting turlingdromes.\n",
+    "And hooptiously drangle me\n",
+    "with crinkly bindlewurdles,\n",
+    "Or I will rend thee\n",
+    "in the gobberwarts\n",
+    "with my blurglecruncheon,\n",
+    "see if I don't!\n"
+  };
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  start();
+  pDisplay->setCursor(0, 0);
+  pDisplay->setTextColor(GFX_WHITE, background(GFX_WHITE, opaque));  pDisplay->setTextSize(1);
+  count += print(pDisplay, "Hello World!\n");
+  pDisplay->setTextColor(GFX_YELLOW, background(GFX_YELLOW, opaque)); pDisplay->setTextSize(2);
+  count += print(pDisplay, "1234.56\n");
+  pDisplay->setTextColor(GFX_RED, background(GFX_RED, opaque));    pDisplay->setTextSize(3);
+  count += print(pDisplay, "DEADBEEF\n");
+  count += print(pDisplay, "\n");
+  pDisplay->setTextColor(GFX_GREEN, background(GFX_GREEN, opaque));
+  pDisplay->setTextSize(5);
+  count += print(pDisplay, "Groop\n");
+  pDisplay->setTextSize(2);
+  count += print(pDisplay, "I implore thee,\n");
+  pDisplay->setTextSize(1);
+  for (size_t i = 0 ; i < sizeof(lines) / sizeof(lines[0]) ; i++) {
+    count += print(pDisplay, lines[i]);
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testCharset(Display* pDisplay, bool cp437)
+{
+  char     line[16 + 2];
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  start();
+  pDisplay->setCursor(0, 0);
+  pDisplay->setTextColor(GFX_WHITE, GFX_WHITE);
+  pDisplay->setTextSize(1);
+  pDisplay->cp437(cp437);
+  for (int c = 0 ; c < 256 ; c += 16) {
+    // NUL would end the text and print() doesn't draw '\n' or '\r', so those
+    // are left as spaces.
+    for (int i = 0 ; i < 16 ; i++) {
+      char ch = c + i;
+      line[i] = (ch == '\0' || ch == '\n' || ch == '\r') ? ' ' : ch;
+    }
+    line[16] = '\n';
+    line[17] = '\0';
+    count += print(pDisplay, line);
+  }
+  pDisplay->cp437(false);
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testLines(Display* pDisplay, uint16_t color)
+{
+  int x1, y1, x2, y2;
+  int w = pDisplay->width();
+  int h = pDisplay->height();
+
+  // Fan of lines out from each corner in turn.  fillScreen doesn't count
+  // against timing.
+  for (int corner = 0 ; corner < 4 ; corner++) {
+    uint32_t count = 0;
+
+    pDisplay->fillScreen(GFX_BLACK);
+    x1 = (corner & 1) ? w - 1 : 0;
+    y1 = (corner & 2) ? h - 1 : 0;
+    y2 = (corner & 2) ? 0 : h - 1;
+    start();
+    for (x2 = 0 ; x2 < w ; x2 += 6, count++) {
+      pDisplay->drawLine(x1, y1, x2, y2, color);
+    }
+    x2 = (corner & 1) ? 0 : w - 1;
+    for (y2 = 0 ; y2 < h ; y2 += 6, count++) {
+      pDisplay->drawLine(x1, y1, x2, y2, color);
+    }
+    stop(count);
+  }
+}
+
+template<class Display>
+void GfxBenchmark::testFastLines(Display* pDisplay, uint16_t color1, uint16_t color2)
+{
+  int      x, y, w = pDisplay->width(), h = pDisplay->height();
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  start();
+  for (y = 0 ; y < h ; y += 5, count++) {
+    pDisplay->drawFastHLine(0, y, w, color1);
+  }
+  for (x = 0 ; x < w ; x += 5, count++) {
+    pDisplay->drawFastVLine(x, 0, h, color2);
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testRects(Display* pDisplay, uint16_t color)
+{
+  int      n, i, i2;
+  int      cx = pDisplay->width() / 2;
+  int      cy = pDisplay->height() / 2;
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  n = minimum(pDisplay->width(), pDisplay->height());
+  start();
+  for (i = 2 ; i < n ; i += 6, count++) {
+    i2 = i / 2;
+    pDisplay->drawRect(cx - i2, cy - i2, i, i, color);
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testFilledRects(Display* pDisplay, uint16_t color1, uint16_t color2)
+{
+  int n, i, i2;
+  int cx = pDisplay->width() / 2 - 1;
+  int cy = pDisplay->height() / 2 - 1;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  n = minimum(pDisplay->width(), pDisplay->height());
+  for (i = n ; i > 0 ; i -= 6) {
+    i2 = i / 2;
+    start();
+    pDisplay->fillRect(cx - i2, cy - i2, i, i, color1);
+    stop(1);
+    // Outlines are not included in timing results
+    pDisplay->drawRect(cx - i2, cy - i2, i, i, color2);
+  }
+}
+
+template<class Display>
+void GfxBenchmark::testFilledCircles(Display* pDisplay, uint8_t radius, uint16_t color)
+{
+  int      x, y, w = pDisplay->width(), h = pDisplay->height(), r2 = radius * 2;
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  start();
+  for (x = radius ; x < w ; x += r2) {
+    for (y = radius ; y < h ; y += r2, count++) {
+      pDisplay->fillCircle(x, y, radius, color);
+    }
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testCircles(Display* pDisplay, uint8_t radius, uint16_t color)
+{
+  int      x, y, r2 = radius * 2;
+  int      w = pDisplay->width() + radius;
+  int      h = pDisplay->height() + radius;
+  uint32_t count = 0;
+
+  // Screen is not cleared for this one -- this is
+  // intentional and does not affect the reported time.
+  start();
+  for (x = 0 ; x < w ; x += r2) {
+    for (y = 0 ; y < h ; y += r2, count++) {
+      pDisplay->drawCircle(x, y, radius, color);
+    }
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testTriangles(Display* pDisplay)
+{
+  int      n, i;
+  int      cx = pDisplay->width() / 2 - 1;
+  int      cy = pDisplay->height() / 2 - 1;
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  n = minimum(cx, cy);
+  start();
+  for (i = 0 ; i < n ; i += 5, count++) {
+    pDisplay->drawTriangle(
+      cx    , cy - i, // peak
+      cx - i, cy + i, // bottom left
+      cx + i, cy + i, // bottom right
+      color565(i, i, i));
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testFilledTriangles(Display* pDisplay)
+{
+  int i;
+  int cx = pDisplay->width() / 2 - 1;
+  int cy = pDisplay->height() / 2 - 1;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  for (i = minimum(cx, cy) ; i > 10 ; i -= 5) {
+    start();
+    pDisplay->fillTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                           color565(0, i * 10, i * 10));
+    stop(1);
+    pDisplay->drawTriangle(cx, cy - i, cx - i, cy + i, cx + i, cy + i,
+                           color565(i * 10, i * 10, 0));
+  }
+}
+
+template<class Display>
+void GfxBenchmark::testRoundRects(Display* pDisplay)
+{
+  int      w, i, i2;
+  int      cx = pDisplay->width() / 2 - 1;
+  int      cy = pDisplay->height() / 2 - 1;
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  w = minimum(pDisplay->width(), pDisplay->height());
+  start();
+  for (i = 0 ; i < w ; i += 6, count++) {
+    i2 = i / 2;
+    pDisplay->drawRoundRect(cx - i2, cy - i2, i, i, i / 8, color565(i, 0, 0));
+  }
+  stop(count);
+}
+
+template<class Display>
+void GfxBenchmark::testFilledRoundRects(Display* pDisplay)
+{
+  int      i, i2;
+  int      cx = pDisplay->width() / 2 - 1;
+  int      cy = pDisplay->height() / 2 - 1;
+  uint32_t count = 0;
+
+  pDisplay->fillScreen(GFX_BLACK);
+  start();
+  for (i = minimum(pDisplay->width(), pDisplay->height()) ; i > 20 ; i -= 6, count++) {
+    i2 = i / 2;
+    pDisplay->fillRoundRect(cx - i2, cy - i2, i, i, i / 8, color565(0, i, 0));
+  }
+  stop(count);
+}
+
+#endif // _GFX_BENCHMARK_H_
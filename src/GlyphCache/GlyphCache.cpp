@@ -0,0 +1,329 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "GlyphCache.h"
+#include <string.h>
+
+
+static int16_t minimum(int16_t a, int16_t b)
+{
+  return a < b ? a : b;
+}
+
+static int16_t maximum(int16_t a, int16_t b)
+{
+  return a > b ? a : b;
+}
+
+// Sets count bits of a 1bpp row, most significant bit first, from bit x.
+static void setBits(uint8_t* pRow, int16_t x, int16_t count)
+{
+  for ( ; count > 0 && (x & 7) ; x++, count--) {
+    pRow[x >> 3] |= 0x80 >> (x & 7);
+  }
+  for ( ; count >= 8 ; x += 8, count -= 8) {
+    pRow[x >> 3] = 0xFF;
+  }
+  for ( ; count > 0 ; x++, count--) {
+    pRow[x >> 3] |= 0x80 >> (x & 7);
+  }
+}
+
+
+GlyphCache::GlyphCache()
+{
+  m_color = 0xFFFF;
+  m_bg = 0xFFFF;
+  m_sizeX = 1;
+  m_sizeY = 1;
+  m_wrap = true;
+  m_cp437 = false;
+  setFont(NULL);
+}
+
+void GlyphCache::setFont(const GFXfont* pFont)
+{
+  m_pFont = pFont;
+  empty();
+
+  // Opaque lines cover the tallest glyph in the font.
+  if (!pFont) {
+    m_ascent = 0;
+    m_descent = 8;
+    return;
+  }
+  m_ascent = 0;
+  m_descent = 0;
+  for (int c = pFont->first ; c <= pFont->last ; c++) {
+    const GFXglyph* pGlyph = &pFont->glyph[c - pFont->first];
+    if (pGlyph->width == 0 || pGlyph->height == 0) {
+      continue;
+    }
+    m_ascent = maximum(m_ascent, -pGlyph->yOffset);
+    m_descent = maximum(m_descent, pGlyph->yOffset + pGlyph->height);
+  }
+}
+
+void GlyphCache::cp437(bool x)
+{
+  m_cp437 = x;
+  empty();
+}
+
+void GlyphCache::empty()
+{
+  memset(m_index, 0, sizeof(m_index));
+  m_used = 0;
+}
+
+int16_t GlyphCache::lineHeight() const
+{
+  return m_sizeY * (m_pFont ? m_pFont->yAdvance : 8);
+}
+
+// Returns the cell for c, rendering it on a miss, or NULL if c isn't in the
+// font.  The cell is only valid until the next call, which may empty the pool.
+const GlyphCache::Cell* GlyphCache::cell(uint8_t c)
+{
+  if (m_index[c]) {
+    return (const Cell*)&m_pool[m_index[c] - 1];
+  }
+
+  uint8_t width = 5;
+  uint8_t height = 8;
+  if (m_pFont) {
+    if (c < m_pFont->first || c > m_pFont->last) {
+      return NULL;
+    }
+    const GFXglyph* pGlyph = &m_pFont->glyph[c - m_pFont->first];
+    width = pGlyph->width;
+    height = pGlyph->height;
+  }
+
+  // Glyphs too large for the pool keep just their metrics, with no rows.
+  uint16_t size = sizeof(Cell) + height * ((width + 7) / 8);
+  if (size > sizeof(m_pool)) {
+    size = sizeof(Cell);
+  }
+  if (m_used + size > sizeof(m_pool)) {
+    empty();
+  }
+
+  Cell* pCell = (Cell*)&m_pool[m_used];
+  render(c, pCell);
+  m_index[c] = m_used + 1;
+  m_used += size;
+  return pCell;
+}
+
+void GlyphCache::render(uint8_t c, Cell* pCell)
+{
+  uint8_t* pBits = (uint8_t*)(pCell + 1);
+
+  if (!m_pFont) {
+    // Classic font, 5 bytes of columns with the top row in the least
+    // significant bit.  The classic charset skips glyph 176, wrapping 255
+    // around to glyph 0 as drawChar() does.
+    uint8_t index = c + (!m_cp437 && c >= 176);
+    const uint8_t* pColumns = &Adafruit_GFX::classicFont()[index * 5];
+    pCell->width = 5;
+    pCell->height = 8;
+    pCell->xAdvance = 6;
+    pCell->xOffset = 0;
+    pCell->yOffset = 0;
+    for (uint8_t row = 0 ; row < 8 ; row++) {
+      uint8_t bits = 0;
+      for (uint8_t column = 0 ; column < 5 ; column++) {
+        if (pColumns[column] & (1 << row)) {
+          bits |= 0x80 >> column;
+        }
+      }
+      pBits[row] = bits;
+    }
+    return;
+  }
+
+  // Custom font glyphs are packed without padding at the end of each row.
+  const GFXglyph* pGlyph = &m_pFont->glyph[c - m_pFont->first];
+  const uint8_t*  pSrc = &m_pFont->bitmap[pGlyph->bitmapOffset];
+  uint8_t         bytesPerRow = (pGlyph->width + 7) / 8;
+  uint8_t         bits = 0;
+  uint8_t         bit = 0;
+
+  pCell->width = pGlyph->width;
+  pCell->height = pGlyph->height;
+  pCell->xAdvance = pGlyph->xAdvance;
+  pCell->xOffset = pGlyph->xOffset;
+  pCell->yOffset = pGlyph->yOffset;
+  if (sizeof(Cell) + pGlyph->height * bytesPerRow > sizeof(m_pool)) {
+    pCell->width = 0;
+    pCell->height = 0;
+    return;
+  }
+  memset(pBits, 0, pGlyph->height * bytesPerRow);
+  for (uint8_t row = 0 ; row < pGlyph->height ; row++, pBits += bytesPerRow) {
+    for (uint8_t column = 0 ; column < pGlyph->width ; column++) {
+      if (!(bit++ & 7)) {
+        bits = *pSrc++;
+      }
+      if (bits & 0x80) {
+        pBits[column >> 3] |= 0x80 >> (column & 7);
+      }
+      bits <<= 1;
+    }
+  }
+}
+
+void GlyphCache::print(Adafruit_GFX* pDisplay, const char* pText)
+{
+  int16_t x = pDisplay->getCursorX();
+  int16_t y = pDisplay->getCursorY();
+
+  while (*pText) {
+    Line line;
+    pText = layout(pText, &x, &y, pDisplay->width(), &line);
+    draw(pDisplay, &line);
+    if (*pText == '\n') {
+      x = 0;
+      y += lineHeight();
+      pText++;
+    }
+  }
+  pDisplay->setCursor(x, y);
+}
+
+// Lays out the characters from pText which fit on the line at the cursor,
+// moving the cursor past them.  Stops at a newline, at the character which
+// wraps, or at the end of the text, and returns where it stopped.  A
+// character which wraps at the start of the line moves the line down instead,
+// as print() would.
+const char* GlyphCache::layout(const char* pText, int16_t* pX, int16_t* pY, int16_t width, Line* pLine)
+{
+  int16_t x = *pX;
+  int16_t y = *pY;
+  bool    placed = false;
+
+  pLine->x = x;
+  pLine->y = y;
+  pLine->left = x;
+  pLine->right = x;
+  for (pLine->pStart = pText ; *pText && *pText != '\n' ; pText++) {
+    const Cell* pCell = *pText == '\r' ? NULL : cell(*pText);
+    if (!pCell) {
+      continue;
+    }
+
+    bool wraps;
+    if (m_pFont) {
+      wraps = pCell->width > 0 && pCell->height > 0 && x + m_sizeX * (pCell->xOffset + pCell->width) > width;
+    } else {
+      wraps = x + m_sizeX * 6 > width;
+    }
+    if (m_wrap && wraps) {
+      if (placed) {
+        break;
+      }
+      x = 0;
+      y += lineHeight();
+      pLine->x = pLine->left = pLine->right = x;
+      pLine->y = y;
+    }
+
+    if (pCell->width > 0 && pCell->height > 0) {
+      pLine->left = minimum(pLine->left, x + pCell->xOffset * m_sizeX);
+      pLine->right = maximum(pLine->right, x + (pCell->xOffset + pCell->width) * m_sizeX);
+    }
+    x += pCell->xAdvance * m_sizeX;
+    pLine->right = maximum(pLine->right, x);
+    placed = true;
+  }
+  pLine->pEnd = pText;
+  pLine->top = y - m_ascent * m_sizeY;
+  pLine->bottom = y + m_descent * m_sizeY;
+
+  *pX = x;
+  *pY = y;
+  return pText;
+}
+
+// Sends the line's box, clipped to the display's clip rectangle, as one bitmap
+// for each band of rows which fits in m_line.
+void GlyphCache::draw(Adafruit_GFX* pDisplay, const Line* pLine)
+{
+  int16_t x0 = pLine->left;
+  int16_t y0 = pLine->top;
+  int16_t w = pLine->right - pLine->left;
+  int16_t h = pLine->bottom - pLine->top;
+  if (!pDisplay->clipRect(x0, y0, w, h)) {
+    return;
+  }
+  int16_t x1 = x0 + w;
+  int16_t y1 = y0 + h;
+
+  int16_t bandRows = sizeof(m_line) / ((x1 - x0 + 7) / 8);
+  for (int16_t y = y0 ; y < y1 ; y += bandRows) {
+    int16_t rows = minimum(bandRows, y1 - y);
+    compose(pLine, x0, x1, y, y + rows);
+    if (m_bg != m_color) {
+      pDisplay->drawBitmap(x0, y, m_line, x1 - x0, rows, m_color, m_bg);
+    } else {
+      pDisplay->drawBitmap(x0, y, m_line, x1 - x0, rows, m_color);
+    }
+  }
+}
+
+// Composes the part of the line within x0 - x1 and y0 - y1 into m_line,
+// scaling each cell by the text size.
+void GlyphCache::compose(const Line* pLine, int16_t x0, int16_t x1, int16_t y0, int16_t y1)
+{
+  int16_t bytesPerRow = (x1 - x0 + 7) / 8;
+  int16_t x = pLine->x;
+
+  memset(m_line, 0, bytesPerRow * (y1 - y0));
+  for (const char* p = pLine->pStart ; p < pLine->pEnd ; p++) {
+    const Cell* pCell = *p == '\r' ? NULL : cell(*p);
+    if (!pCell) {
+      continue;
+    }
+
+    const uint8_t* pBits = (const uint8_t*)(pCell + 1);
+    uint8_t        cellBytes = (pCell->width + 7) / 8;
+    int16_t        left = x + pCell->xOffset * m_sizeX;
+    int16_t        top = pLine->y + pCell->yOffset * m_sizeY;
+    for (uint8_t row = 0 ; row < pCell->height ; row++, pBits += cellBytes) {
+      int16_t rowStart = maximum(top + row * m_sizeY, y0);
+      int16_t rowEnd = minimum(top + (row + 1) * m_sizeY, y1);
+      if (rowStart >= rowEnd) {
+        continue;
+      }
+      // Each run of set bits in the row is one span of the scaled glyph.
+      uint8_t column = 0;
+      while (column < pCell->width) {
+        if (!(pBits[column >> 3] & (0x80 >> (column & 7)))) {
+          column++;
+          continue;
+        }
+        uint8_t start = column;
+        while (column < pCell->width && (pBits[column >> 3] & (0x80 >> (column & 7)))) {
+          column++;
+        }
+        int16_t spanStart = maximum(left + start * m_sizeX, x0);
+        int16_t spanEnd = minimum(left + column * m_sizeX, x1);
+        for (int16_t y = rowStart ; spanStart < spanEnd && y < rowEnd ; y++) {
+          setBits(&m_line[(y - y0) * bytesPerRow], spanStart - x0, spanEnd - spanStart);
+        }
+      }
+    }
+    x += pCell->xAdvance * m_sizeX;
+  }
+}
@@ -0,0 +1,123 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Text drawn a line at a time rather than a pixel at a time.  Adafruit_GFX's
+// drawChar() makes a writePixel() or writeFillRect() for every pixel of each
+// character, and can't draw a background behind a custom GFXfont at all.
+// GlyphCache instead renders each character the first time it is used into
+// a 1bpp cell in RAM, with its rows padded to whole bytes, and prints by
+// composing each line of text from those cells into one bitmap which is sent
+// with a single drawBitmap().  On the SSD1351 that is one address window per
+// line, with the background (if any) sent along with the text, so text can
+// be redrawn over itself without flickering.
+//
+// The opaque background of a line covers the character cells of the classic
+// font, exactly as drawChar() fills them, or for a custom font, the font's
+// tallest ascent and descent from the baseline and the whole width of the
+// line.  Cursor, wrapping and newlines work as they do for Adafruit_GFX's
+// print(), using the cursor of the display being drawn to.  The font,
+// colours and size are set on the cache, separately from those of the
+// display, and lines are clipped to the display's clip rectangle.
+//
+// Cells are packed into a fixed pool which is emptied when a glyph doesn't
+// fit, so that only the glyphs in use are kept.  1bpp cells, rather than
+// RGB565 ones, keep a whole font's worth in 1k and let the same cells be
+// drawn in any colours.
+#ifndef _GLYPH_CACHE_H_
+#define _GLYPH_CACHE_H_
+
+#include <Adafruit_GFX.h>
+
+
+// Bytes of glyph cells kept at once.  Glyphs larger than this are left blank.
+#ifndef GLYPH_CACHE_POOL_SIZE
+#define GLYPH_CACHE_POOL_SIZE   1024
+#endif
+// Bytes in which each line is composed.  Lines too large for it are sent as
+// several bands of rows, each its own drawBitmap().
+#ifndef GLYPH_CACHE_LINE_SIZE
+#define GLYPH_CACHE_LINE_SIZE   1024
+#endif
+
+
+class GlyphCache
+{
+  public:
+    GlyphCache();
+
+    // Changing the font or the cp437() setting empties the cache.
+    void     setFont(const GFXfont* pFont = NULL);
+    void     cp437(bool x = true);
+    void     setTextColor(uint16_t c) { m_color = m_bg = c; }
+    void     setTextColor(uint16_t c, uint16_t bg) { m_color = c; m_bg = bg; }
+    void     setTextSize(uint8_t s) { setTextSize(s, s); }
+    void     setTextSize(uint8_t sizeX, uint8_t sizeY)
+    {
+      m_sizeX = sizeX ? sizeX : 1;
+      m_sizeY = sizeY ? sizeY : 1;
+    }
+    void     setTextWrap(bool wrap) { m_wrap = wrap; }
+
+    // Prints pText at the cursor of pDisplay and moves the cursor past it.
+    void     print(Adafruit_GFX* pDisplay, const char* pText);
+
+  protected:
+    // Header of each cell in the pool, followed by its rows of
+    // (width + 7) / 8 bytes each.
+    struct Cell
+    {
+      uint8_t width;
+      uint8_t height;
+      uint8_t xAdvance;
+      int8_t  xOffset;
+      int8_t  yOffset;
+    };
+    // Characters on one line and the box which they cover.
+    struct Line
+    {
+      const char* pStart;
+      const char* pEnd;
+      int16_t     x;
+      int16_t     y;
+      int16_t     left;
+      int16_t     right;
+      int16_t     top;
+      int16_t     bottom;
+    };
+
+    void        empty();
+    const Cell* cell(uint8_t c);
+    void        render(uint8_t c, Cell* pCell);
+    const char* layout(const char* pText, int16_t* pX, int16_t* pY, int16_t width, Line* pLine);
+    void        draw(Adafruit_GFX* pDisplay, const Line* pLine);
+    void        compose(const Line* pLine, int16_t x0, int16_t x1, int16_t y0, int16_t y1);
+    int16_t     lineHeight() const;
+
+    const GFXfont* m_pFont;
+    uint16_t       m_used;
+    uint16_t       m_color;
+    uint16_t       m_bg;
+    int16_t        m_ascent;
+    int16_t        m_descent;
+    uint8_t        m_sizeX;
+    uint8_t        m_sizeY;
+    bool           m_wrap;
+    bool           m_cp437;
+    // Offset + 1 of each character's cell in m_pool, 0 if it isn't cached.
+    uint16_t       m_index[256];
+    uint8_t        m_pool[GLYPH_CACHE_POOL_SIZE];
+    uint8_t        m_line[GLYPH_CACHE_LINE_SIZE];
+};
+
+#endif // _GLYPH_CACHE_H_
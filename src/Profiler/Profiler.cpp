@@ -0,0 +1,172 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "Profiler.h"
+#include <string.h>
+#if defined(__CORTEX_M)
+  #include <unistd.h>
+#endif
+
+// Value written to each word of unused stack by init().
+#define STACK_PAINT 0xDEADBEEF
+
+// Number of words below the current stack pointer that init() leaves unpainted
+// for its own use.
+#define STACK_PAINT_MARGIN 16
+
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+} zoneStats;
+
+static const char* g_zoneNames[PROFILE_ZONE_COUNT] = {
+  "animation",
+  "eyelid",
+  "drawEye",
+  "setAddrWindow",
+  "spiStall"
+};
+
+static zoneStats g_zones[PROFILE_ZONE_COUNT];
+uint32_t         Profiler::m_pending[PROFILE_ZONE_COUNT];
+
+#if defined(__CORTEX_M)
+// Top of stack is provided by the linker script.
+extern "C" uint32_t __StackTop;
+
+// Lowest word of stack painted by init().
+static uint32_t* g_pStackPaint = NULL;
+
+static uint32_t* heapEnd()
+{
+  return (uint32_t*)(((uintptr_t)sbrk(0) + 3) & ~3);
+}
+
+static __attribute__((noinline)) void paintStack()
+{
+  uint32_t* pCurr = heapEnd();
+  uint32_t* pEnd = (uint32_t*)__get_MSP() - STACK_PAINT_MARGIN;
+
+  g_pStackPaint = pCurr;
+  while (pCurr < pEnd) {
+    *pCurr++ = STACK_PAINT;
+  }
+}
+#endif
+
+
+void Profiler::init()
+{
+#if defined(__CORTEX_M)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  paintStack();
+#endif
+  reset();
+}
+
+void Profiler::reset()
+{
+  memset(g_zones, 0, sizeof(g_zones));
+  memset(m_pending, 0, sizeof(m_pending));
+  for (int i = 0 ; i < PROFILE_ZONE_COUNT ; i++) {
+    g_zones[i].min = ~0U;
+  }
+}
+
+void Profiler::record(ProfileZone zone, uint32_t ticks)
+{
+  zoneStats* pZone = &g_zones[zone];
+
+  pZone->count++;
+  pZone->total += ticks;
+  if (ticks < pZone->min) {
+    pZone->min = ticks;
+  }
+  if (ticks > pZone->max) {
+    pZone->max = ticks;
+  }
+}
+
+void Profiler::commit(ProfileZone zone)
+{
+  record(zone, m_pending[zone]);
+  m_pending[zone] = 0;
+}
+
+uint32_t Profiler::stackHighWater()
+{
+#if defined(__CORTEX_M)
+  if (!g_pStackPaint) {
+    return 0;
+  }
+
+  // The heap may have grown up into the painted area since init() so start
+  // the search above its current end.
+  uint32_t* pCurr = heapEnd();
+  if (pCurr < g_pStackPaint) {
+    pCurr = g_pStackPaint;
+  }
+  while (pCurr < &__StackTop && *pCurr == STACK_PAINT) {
+    pCurr++;
+  }
+  return (uintptr_t)&__StackTop - (uintptr_t)pCurr;
+#else
+  return 0;
+#endif
+}
+
+// Converts ticks to tenths of a microsecond for printing.
+static unsigned long ticksToTenthsOfUs(uint64_t ticks)
+{
+#if defined(__CORTEX_M)
+  return (unsigned long)(ticks * 10 / (SystemCoreClock / 1000000));
+#else
+  return (unsigned long)(ticks / 100);
+#endif
+}
+
+static void printTime(uint64_t ticks)
+{
+  unsigned long tenths = ticksToTenthsOfUs(ticks);
+  printf(" %8lu.%lu", tenths / 10, tenths % 10);
+}
+
+void Profiler::dump()
+{
+  printf("%-14s %8s %10s %10s %10s\n", "zone", "count", "min(us)", "avg(us)", "max(us)");
+  for (int i = 0 ; i < PROFILE_ZONE_COUNT ; i++) {
+    const zoneStats* pZone = &g_zones[i];
+
+    printf("%-14s %8lu", g_zoneNames[i], (unsigned long)pZone->count);
+    if (pZone->count == 0) {
+      printf(" %10s %10s %10s\n", "-", "-", "-");
+      continue;
+    }
+    printTime(pZone->min);
+    printTime(pZone->total / pZone->count);
+    printTime(pZone->max);
+    printf("\n");
+  }
+
+  uint32_t stackUsed = stackHighWater();
+  if (stackUsed) {
+    printf("stack high-water: %lu bytes\n", (unsigned long)stackUsed);
+  } else {
+    printf("stack high-water: n/a\n");
+  }
+}
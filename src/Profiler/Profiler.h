@@ -0,0 +1,122 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Lightweight profiling zones for the render and animation paths.
+// On the LPC1768 the zones are timed with the Cortex-M3 DWT cycle counter
+// (CYCCNT) and on the host with std::chrono.  Every zone keeps a running
+// count/min/avg/max which can be dumped with Profiler::dump().
+//
+// All of the PROFILE_* macros compile away to nothing unless PROFILE is
+// defined on the compiler command line.  The firmware Makefile does that when
+// PROFILE is enabled in config.h.
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <mbed.h>
+#if !defined(__CORTEX_M)
+  #include <chrono>
+#endif
+
+
+// The zones that can be timed.  Add new zones before PROFILE_ZONE_COUNT and
+// give them a name in Profiler.cpp as well.
+enum ProfileZone {
+  PROFILE_ANIMATION,        // Eye motion and blink state update in frame()
+  PROFILE_EYELID,           // Eyelid tracking and blink threshold scaling
+  PROFILE_DRAW_EYE,         // Scanline loop of drawEye()
+  PROFILE_SET_ADDR_WINDOW,  // SSD1351::setAddrWindow()
+  PROFILE_SPI_STALL,        // Waiting on FastSpiWriter's FIFO, summed per frame
+  PROFILE_ZONE_COUNT
+};
+
+class Profiler
+{
+  public:
+    // Enables the cycle counter and paints the unused stack so that its
+    // high-water mark can be reported later.
+    static void     init();
+    // Clears the statistics for all zones.
+    static void     reset();
+    // Adds a single timing sample to a zone.
+    static void     record(ProfileZone zone, uint32_t ticks);
+    // Sums up short intervals (such as SPI stalls) which are recorded as a
+    // single sample once commit() is called.
+    static void     accumulate(ProfileZone zone, uint32_t ticks)
+    {
+      m_pending[zone] += ticks;
+    }
+    static void     commit(ProfileZone zone);
+    // Number of bytes of stack used so far (0 if not supported).
+    static uint32_t stackHighWater();
+    // Prints the min/avg/max for each zone and the stack high-water mark.
+    static void     dump();
+
+    // Current time in ticks: CPU cycles on the LPC1768, nanoseconds on the host.
+    static uint32_t now()
+    {
+#if defined(__CORTEX_M)
+      return DWT->CYCCNT;
+#else
+      return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+  protected:
+    static uint32_t m_pending[PROFILE_ZONE_COUNT];
+};
+
+// Times the rest of the enclosing C++ scope.
+class ProfileScope
+{
+  public:
+    ProfileScope(ProfileZone zone) : m_zone(zone), m_start(Profiler::now())
+    {
+    }
+    ~ProfileScope()
+    {
+      Profiler::record(m_zone, Profiler::now() - m_start);
+    }
+
+  protected:
+    ProfileZone m_zone;
+    uint32_t    m_start;
+};
+
+
+#define PROFILE_CONCAT_(A, B) A##B
+#define PROFILE_CONCAT(A, B)  PROFILE_CONCAT_(A, B)
+
+#ifdef PROFILE
+  #define PROFILE_INIT()       Profiler::init()
+  #define PROFILE_DUMP()       Profiler::dump()
+  #define PROFILE_RESET()      Profiler::reset()
+  // Time from here to the end of the enclosing scope.
+  #define PROFILE_SCOPE(ZONE)  ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(ZONE)
+  // Time a section of code which can't be wrapped in its own scope.
+  #define PROFILE_BEGIN(ZONE)  uint32_t PROFILE_CONCAT(profileStart_, ZONE) = Profiler::now()
+  #define PROFILE_END(ZONE)    Profiler::record(ZONE, Profiler::now() - PROFILE_CONCAT(profileStart_, ZONE))
+  // Record the time accumulated into a zone since the last commit as one sample.
+  #define PROFILE_COMMIT(ZONE) Profiler::commit(ZONE)
+#else
+  #define PROFILE_INIT()       ((void)0)
+  #define PROFILE_DUMP()       ((void)0)
+  #define PROFILE_RESET()      ((void)0)
+  #define PROFILE_SCOPE(ZONE)  ((void)0)
+  #define PROFILE_BEGIN(ZONE)  ((void)0)
+  #define PROFILE_END(ZONE)    ((void)0)
+  #define PROFILE_COMMIT(ZONE) ((void)0)
+#endif // PROFILE
+
+#endif // _PROFILER_H_
@@ -79,10 +79,109 @@ static const uint8_t initSSD1351[] = {
 #define CS_IDLE     m_pSpi->flush(); m_csPin = 1
 #define CS_ACTIVE   m_csPin = 0
 
-inline void SSD1351::writeSPI(uint8_t c)
+// Grayscale to RGB565 for drawGrayscaleBitmap().
+#define GRAY565(G)   (uint16_t)((((G) & 0xF8) << 8) | (((G) & 0xFC) << 3) | ((G) >> 3))
+#define GRAY565x4(G) GRAY565(G), GRAY565(G+1), GRAY565(G+2), GRAY565(G+3)
+#define GRAY565x16(G) GRAY565x4(G), GRAY565x4(G+4), GRAY565x4(G+8), GRAY565x4(G+12)
+#define GRAY565x64(G) GRAY565x16(G), GRAY565x16(G+16), GRAY565x16(G+32), GRAY565x16(G+48)
+static const uint16_t g_grayTo565[256] = {
+  GRAY565x64(0), GRAY565x64(64), GRAY565x64(128), GRAY565x64(192)
+};
+
+// Pixel sources for SSD1351::blit().  row() selects a row of the bitmap and
+// pixel() returns the RGB565 color of a column within it.
+class Rgb565Pixels
 {
-    m_pSpi->transmit(c);
-}
+  public:
+    Rgb565Pixels(const uint16_t* pBitmap, int16_t w) : m_pBitmap(pBitmap), m_pRow(pBitmap), m_w(w) {}
+
+    void     row(int16_t j) { m_pRow = m_pBitmap + (int32_t)j * m_w; }
+    uint16_t pixel(int16_t i) const { return pgm_read_word(&m_pRow[i]); }
+
+  protected:
+    const uint16_t* m_pBitmap;
+    const uint16_t* m_pRow;
+    int16_t         m_w;
+};
+
+class GrayPixels
+{
+  public:
+    GrayPixels(const uint8_t* pBitmap, int16_t w) : m_pBitmap(pBitmap), m_pRow(pBitmap), m_w(w) {}
+
+    void     row(int16_t j) { m_pRow = m_pBitmap + (int32_t)j * m_w; }
+    uint16_t pixel(int16_t i) const { return g_grayTo565[pgm_read_byte(&m_pRow[i])]; }
+
+  protected:
+    const uint8_t* m_pBitmap;
+    const uint8_t* m_pRow;
+    int16_t        m_w;
+};
+
+class IndexedPixels
+{
+  public:
+    IndexedPixels(const uint8_t* pBitmap, const uint16_t* pPalette, int16_t w) :
+      m_pBitmap(pBitmap), m_pRow(pBitmap), m_pPalette(pPalette), m_w(w) {}
+
+    void     row(int16_t j) { m_pRow = m_pBitmap + (int32_t)j * m_w; }
+    uint16_t pixel(int16_t i) const { return m_pPalette[pgm_read_byte(&m_pRow[i])]; }
+
+  protected:
+    const uint8_t*  m_pBitmap;
+    const uint8_t*  m_pRow;
+    const uint16_t* m_pPalette;
+    int16_t         m_w;
+};
+
+// 1-bit rows padded to whole bytes, leftmost pixel in the most significant
+// bit (or the least for XBitmaps).  Also the masks of blit().
+class MonoBits
+{
+  public:
+    MonoBits(const uint8_t* pBitmap, int16_t w, bool lsbFirst = false) :
+      m_pBitmap(pBitmap), m_pRow(pBitmap), m_byteWidth((w + 7) / 8), m_lsbFirst(lsbFirst) {}
+
+    void row(int16_t j) { m_pRow = m_pBitmap + (int32_t)j * m_byteWidth; }
+    bool bit(int16_t i) const
+    {
+      uint8_t byte = pgm_read_byte(&m_pRow[i >> 3]);
+      return m_lsbFirst ? (byte >> (i & 7)) & 1 : (byte << (i & 7)) & 0x80;
+    }
+
+  protected:
+    const uint8_t* m_pBitmap;
+    const uint8_t* m_pRow;
+    int16_t        m_byteWidth;
+    bool           m_lsbFirst;
+};
+
+class MonoPixels : public MonoBits
+{
+  public:
+    MonoPixels(const uint8_t* pBitmap, int16_t w, uint16_t color, uint16_t bg) : MonoBits(pBitmap, w)
+    {
+      m_colors[0] = bg;
+      m_colors[1] = color;
+    }
+
+    uint16_t pixel(int16_t i) const { return m_colors[bit(i)]; }
+
+  protected:
+    uint16_t m_colors[2];
+};
+
+class SolidPixels
+{
+  public:
+    SolidPixels(uint16_t color) : m_color(color) {}
+
+    void     row(int16_t j) { (void)j; }
+    uint16_t pixel(int16_t i) const { (void)i; return m_color; }
+
+  protected:
+    uint16_t m_color;
+};
 
 // ----------------------------------------------------------
 SSD1351::SSD1351(uint16_t width, uint16_t height,
@@ -95,6 +194,11 @@ SSD1351::SSD1351(uint16_t width, uint16_t height,
   _width  = width;
   _height = height;
   m_pSpi = pSpi;
+  m_windowX0 = m_windowY0 = m_windowX1 = m_windowY1 = 0;
+  m_pointerX = m_pointerY = 0;
+  m_lastPixelX = m_lastPixelY = -1;
+  m_writeDepth = 0;
+  m_windowValid = false;
 }
 
 // ----------------------------------------------------------
@@ -108,6 +212,7 @@ void SSD1351::init()
 // ----------------------------------------------------------
 void SSD1351::writeCmd(uint8_t c)
 {
+  m_windowValid = false;
   DC_COMMAND;
   CS_ACTIVE;
   SPI_START;
@@ -213,6 +318,7 @@ void SSD1351::setRotation(uint8_t r)
   uint8_t startline = (rotation < 2) ? HEIGHT : 0;
   writeCmd(SSD1351_CMD_STARTLINE);
   writeData(startline);
+  resetClipRect();
 }
 
 void SSD1351::mirrorDisplay(bool mirror)
@@ -241,6 +347,8 @@ void SSD1351::mirrorDisplay(bool mirror)
 // ----------------------------------------------------------
 void SSD1351::setAddrWindow(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
 {
+  PROFILE_SCOPE(PROFILE_SET_ADDR_WINDOW);
+
   if (rotation & 1) { // Vertical address increment mode
     uint16_t t1 = x1; x1 = y1; y1 = t1;
     uint16_t t2 = x2; x2 = y2; y2 = t2;
@@ -269,81 +377,35 @@ void SSD1351::pushColor(uint16_t color)
 }
 
 // ----------------------------------------------------------
-void SSD1351::drawPixel(int16_t x, int16_t y, uint16_t color)
+void SSD1351::pushWireColors(const uint16_t colors[], uint32_t count)
 {
-  if(x<0 ||x>=_width || y<0 || y>=_height) return;
-  setAddrWindow(x,y,x+1,y+1);
-
-  SPI_START;
-  DC_DATA;
-  CS_ACTIVE;
-
-  writeSPI(color >> 8); writeSPI(color);
+  startWrite();
+  writeBytes((const uint8_t*)colors, count*2);
+  endWrite();
+}
 
-  CS_IDLE;
-  SPI_END;
+// ----------------------------------------------------------
+void SSD1351::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  startWrite();
+  writePixel(x, y, color);
+  endWrite();
 }
 
 // ----------------------------------------------------------
 void SSD1351::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
 {
-  if(x>=_width || y>=_height || h<=0) return;
-  if(y+h-1>=_height) h=_height-y;
-  setAddrWindow(x, y, x, y+h-1);
-
-  uint8_t hi = color >> 8, lo = color;
-
-  SPI_START;
-  DC_DATA;
-  CS_ACTIVE;
-
-  uint8_t num8 = h>>3;
-  while(num8--) {
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-  }
-  num8 = (uint8_t)h & 7;
-  while(num8--) { writeSPI(hi); writeSPI(lo); }
-
-  CS_IDLE;
-  SPI_END;
+  startWrite();
+  writeFastVLine(x, y, h, color);
+  endWrite();
 }
 
 // ----------------------------------------------------------
 void SSD1351::drawFastHLine(int16_t x, int16_t y, int16_t w,  uint16_t color)
 {
-  if(x>=_width || y>=_height || w<=0) return;
-  if(x+w-1>=_width)  w=_width-x;
-  setAddrWindow(x, y, x+w-1, y);
-
-  uint8_t hi = color >> 8, lo = color;
-
-  SPI_START;
-  DC_DATA;
-  CS_ACTIVE;
-
-  uint8_t num8 = w>>3;
-  while(num8--) {
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-    writeSPI(hi); writeSPI(lo);
-  }
-  num8 = (uint8_t)w & 7;
-  while(num8--) { writeSPI(hi); writeSPI(lo); }
-
-  CS_IDLE;
-  SPI_END;
+  startWrite();
+  writeFastHLine(x, y, w, color);
+  endWrite();
 }
 
 // ----------------------------------------------------------
@@ -355,19 +417,61 @@ void SSD1351::fillScreen(uint16_t color)
 // ----------------------------------------------------------
 void SSD1351::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
 {
-  if(x>=_width || y>=_height || w<=0 || h<=0) return;
-  if(x+w-1>=_width)  w=_width -x;
-  if(y+h-1>=_height) h=_height-y;
-  setAddrWindow(x, y, x+w-1, y+h-1);
-
-  uint8_t hi = color >> 8, lo = color;
+  startWrite();
+  writeFillRect(x, y, w, h, color);
+  endWrite();
+}
 
-  SPI_START;
+// ----------------------------------------------------------
+// Sends a command in the middle of a startWrite() transaction.  DC may only
+// change once the bytes before it have been shifted out.
+void SSD1351::writeWindowCmd(uint8_t c)
+{
+  m_pSpi->flush();
+  DC_COMMAND;
+  writeSPI(c);
+  m_pSpi->flush();
   DC_DATA;
-  CS_ACTIVE;
+}
 
-  uint32_t num = (uint32_t)w*h;
-  uint16_t num16 = num>>4;
+// ----------------------------------------------------------
+// Points the controller at (x0,y0) of the given window, only sending the
+// column and/or row range which differ from where it is already.
+void SSD1351::writeWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  bool xReset = !m_windowValid || x0 != m_windowX0 || x1 != m_windowX1 || m_pointerX != x0;
+  bool yReset = !m_windowValid || y0 != m_windowY0 || y1 != m_windowY1 || m_pointerY != y0;
+  if(!xReset && !yReset) return;
+
+  PROFILE_SCOPE(PROFILE_SET_ADDR_WINDOW);
+  CS_ACTIVE; // In case a command outside of the write*() calls raised it.
+  // X runs along the controller's rows in vertical address increment mode.
+  bool vertical = rotation & 1;
+  if(xReset) {
+    writeWindowCmd(vertical ? SSD1351_CMD_SETROW : SSD1351_CMD_SETCOLUMN);
+    writeSPI(x0);
+    writeSPI(x1);
+  }
+  if(yReset) {
+    writeWindowCmd(vertical ? SSD1351_CMD_SETCOLUMN : SSD1351_CMD_SETROW);
+    writeSPI(y0);
+    writeSPI(y1);
+  }
+  writeWindowCmd(SSD1351_CMD_WRITERAM);
+
+  m_windowX0 = m_pointerX = x0;
+  m_windowY0 = m_pointerY = y0;
+  m_windowX1 = x1;
+  m_windowY1 = y1;
+  m_windowValid = true;
+}
+
+// ----------------------------------------------------------
+void SSD1351::writeColor(uint16_t color, uint32_t count)
+{
+  uint8_t hi = color >> 8, lo = color;
+
+  uint32_t num16 = count>>4;
   while(num16--) {
     writeSPI(hi); writeSPI(lo);
     writeSPI(hi); writeSPI(lo);
@@ -386,11 +490,197 @@ void SSD1351::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t colo
     writeSPI(hi); writeSPI(lo);
     writeSPI(hi); writeSPI(lo);
   }
-  uint8_t num8 = num & 0xf;
+  uint8_t num8 = count & 0xf;
   while(num8--) { writeSPI(hi); writeSPI(lo); }
+}
 
-  CS_IDLE;
-  SPI_END;
+// ----------------------------------------------------------
+// Copies bytes to the SPI port as they are in memory.
+void SSD1351::writeBytes(const uint8_t* pBytes, uint32_t count)
+{
+  uint32_t num16 = count>>4;
+  while(num16--) {
+    writeSPI(pBytes[0]);  writeSPI(pBytes[1]);
+    writeSPI(pBytes[2]);  writeSPI(pBytes[3]);
+    writeSPI(pBytes[4]);  writeSPI(pBytes[5]);
+    writeSPI(pBytes[6]);  writeSPI(pBytes[7]);
+    writeSPI(pBytes[8]);  writeSPI(pBytes[9]);
+    writeSPI(pBytes[10]); writeSPI(pBytes[11]);
+    writeSPI(pBytes[12]); writeSPI(pBytes[13]);
+    writeSPI(pBytes[14]); writeSPI(pBytes[15]);
+    pBytes += 16;
+  }
+  uint8_t num = count & 0xf;
+  while(num--) writeSPI(*pBytes++);
+}
+
+// ----------------------------------------------------------
+// Streams the visible part of a bitmap into one window.
+template<class Source>
+void SSD1351::blit(int16_t x, int16_t y, int16_t w, int16_t h, Source& source)
+{
+  int16_t i0 = x<_clipX0 ? _clipX0-x : 0, i1 = x+w>_clipX1 ? _clipX1-x : w;
+  int16_t j0 = y<_clipY0 ? _clipY0-y : 0, j1 = y+h>_clipY1 ? _clipY1-y : h;
+  if(i0>=i1 || j0>=j1) return;
+
+  startWrite();
+  writeWindow(x+i0, y+j0, x+i1-1, y+j1-1);
+  for(int16_t j=j0; j<j1; j++) {
+    source.row(j);
+    for(int16_t i=i0; i<i1; i++) {
+      uint16_t color = source.pixel(i);
+      writeSPI(color >> 8); writeSPI(color);
+    }
+  }
+  endWrite();
+}
+
+// ----------------------------------------------------------
+// Streams each run of pixels which are set in mask into its own window.
+template<class Source, class Mask>
+void SSD1351::blit(int16_t x, int16_t y, int16_t w, int16_t h, Source& source, Mask& mask)
+{
+  int16_t i0 = x<_clipX0 ? _clipX0-x : 0, i1 = x+w>_clipX1 ? _clipX1-x : w;
+  int16_t j0 = y<_clipY0 ? _clipY0-y : 0, j1 = y+h>_clipY1 ? _clipY1-y : h;
+  if(i0>=i1 || j0>=j1) return;
+
+  startWrite();
+  for(int16_t j=j0; j<j1; j++) {
+    source.row(j);
+    mask.row(j);
+    for(int16_t i=i0; i<i1; ) {
+      if(!mask.bit(i)) {
+        i++;
+        continue;
+      }
+      int16_t start = i;
+      while(i<i1 && mask.bit(i)) i++;
+      writeWindow(x+start, y+j, x+i-1, y+j);
+      for( ; start<i; start++) {
+        uint16_t color = source.pixel(start);
+        writeSPI(color >> 8); writeSPI(color);
+      }
+    }
+  }
+  endWrite();
+}
+
+// ----------------------------------------------------------
+void SSD1351::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
+{
+  SolidPixels source(color);
+  MonoBits    mask(bitmap, w);
+  blit(x, y, w, h, source, mask);
+}
+
+void SSD1351::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  MonoPixels source(bitmap, w, color, bg);
+  blit(x, y, w, h, source);
+}
+
+void SSD1351::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color)
+{
+  drawBitmap(x, y, (const uint8_t*)bitmap, w, h, color);
+}
+
+void SSD1351::drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg)
+{
+  drawBitmap(x, y, (const uint8_t*)bitmap, w, h, color, bg);
+}
+
+void SSD1351::drawXBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color)
+{
+  SolidPixels source(color);
+  MonoBits    mask(bitmap, w, true);
+  blit(x, y, w, h, source, mask);
+}
+
+// ----------------------------------------------------------
+void SSD1351::drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h)
+{
+  GrayPixels source(bitmap, w);
+  blit(x, y, w, h, source);
+}
+
+void SSD1351::drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h)
+{
+  drawGrayscaleBitmap(x, y, (const uint8_t*)bitmap, w, h);
+}
+
+void SSD1351::drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[], const uint8_t mask[], int16_t w, int16_t h)
+{
+  GrayPixels source(bitmap, w);
+  MonoBits   bits(mask, w);
+  blit(x, y, w, h, source, bits);
+}
+
+void SSD1351::drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap, uint8_t *mask, int16_t w, int16_t h)
+{
+  drawGrayscaleBitmap(x, y, (const uint8_t*)bitmap, (const uint8_t*)mask, w, h);
+}
+
+// ----------------------------------------------------------
+void SSD1351::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h)
+{
+  Rgb565Pixels source(bitmap, w);
+  blit(x, y, w, h, source);
+}
+
+void SSD1351::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h)
+{
+  drawRGBBitmap(x, y, (const uint16_t*)bitmap, w, h);
+}
+
+void SSD1351::drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], const uint8_t mask[], int16_t w, int16_t h)
+{
+  Rgb565Pixels source(bitmap, w);
+  MonoBits     bits(mask, w);
+  blit(x, y, w, h, source, bits);
+}
+
+void SSD1351::drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, uint8_t *mask, int16_t w, int16_t h)
+{
+  drawRGBBitmap(x, y, (const uint16_t*)bitmap, (const uint8_t*)mask, w, h);
+}
+
+// ----------------------------------------------------------
+void SSD1351::drawIndexedBitmap(int16_t x, int16_t y, const uint8_t bitmap[], const uint16_t palette[], int16_t w, int16_t h)
+{
+  IndexedPixels source(bitmap, palette, w);
+  blit(x, y, w, h, source);
+}
+
+void SSD1351::drawCanvas(int16_t x, int16_t y, const GFXcanvas8* pCanvas, const uint16_t palette[])
+{
+  // width() and height() are rotated but the buffer isn't.
+  bool    swap = pCanvas->getRotation() & 1;
+  int16_t w = swap ? pCanvas->height() : pCanvas->width();
+  int16_t h = swap ? pCanvas->width() : pCanvas->height();
+  if (pCanvas->getBuffer()) {
+    drawIndexedBitmap(x, y, pCanvas->getBuffer(), palette, w, h);
+  }
+}
+
+// ----------------------------------------------------------
+// Rows which aren't clipped on either side are contiguous, so go together.
+void SSD1351::drawWireBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h)
+{
+  int16_t i0 = x<_clipX0 ? _clipX0-x : 0, i1 = x+w>_clipX1 ? _clipX1-x : w;
+  int16_t j0 = y<_clipY0 ? _clipY0-y : 0, j1 = y+h>_clipY1 ? _clipY1-y : h;
+  if(i0>=i1 || j0>=j1) return;
+
+  startWrite();
+  writeWindow(x+i0, y+j0, x+i1-1, y+j1-1);
+  const uint8_t* pRow = (const uint8_t*)(bitmap + (int32_t)j0*w + i0);
+  if(i1-i0 == w) {
+    writeBytes(pRow, (uint32_t)w*(j1-j0)*2);
+  } else {
+    for(int16_t j=j0; j<j1; j++, pRow += w*2) {
+      writeBytes(pRow, (i1-i0)*2);
+    }
+  }
+  endWrite();
 }
 
 // ----------------------------------------------------------
@@ -13,6 +13,7 @@
 
 #include <mbed.h>
 #include <Adafruit_GFX.h>
+#include <Profiler.h>
 
 // Macro to convert AVR pgm_read_*() calls to simple dereferences on ARM.
 #define pgm_read_word(ADDR) (*(uint16_t*)(ADDR))
@@ -72,19 +73,46 @@ class FastSpiWriter : public SPI
   public:
     FastSpiWriter(PinName mosi, PinName miso, PinName sclk, PinName ssel) : SPI(mosi, miso, sclk, ssel)
     {
+      m_transmitCount = 0;
+    }
+
+    // Number of bytes transmitted so far.  Only counted when PROFILE is
+    // defined, always 0 otherwise.
+    uint32_t transmitCount() const
+    {
+      return m_transmitCount;
     }
 
     inline void transmit(int value)
     {
+#ifdef PROFILE
+      if (!transmitFifoNotFull()) {
+        uint32_t start = Profiler::now();
+        while (!transmitFifoNotFull()) {
+        }
+        Profiler::accumulate(PROFILE_SPI_STALL, Profiler::now() - start);
+      }
+      m_transmitCount++;
+#else
       while (!transmitFifoNotFull()) {
       }
+#endif // PROFILE
       _spi.spi->DR = value;
     }
 
     inline void flush()
     {
+#ifdef PROFILE
+      if (busy()) {
+        uint32_t start = Profiler::now();
+        while (busy()) {
+        }
+        Profiler::accumulate(PROFILE_SPI_STALL, Profiler::now() - start);
+      }
+#else
       while (busy()) {
       }
+#endif // PROFILE
     }
 
   protected:
@@ -97,6 +125,8 @@ class FastSpiWriter : public SPI
     {
         return _spi.spi->SR & (1 << 4);
     }
+
+    uint32_t m_transmitCount;
 };
 
 
@@ -120,6 +150,53 @@ class SSD1351 : public Adafruit_GFX
   void drawImage(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t *img);
   void drawImageF(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t *img16);
   void drawImageF(int16_t x, int16_t y, const uint16_t *img16) { drawImageF(x,y,pgm_read_word(img16),pgm_read_word(img16+1),img16+3); }
+
+  // Adafruit_GFX batching.  CS is held low from startWrite() to endWrite() so
+  // that the write*() calls stream as one transaction, and only the parts of
+  // the address window which they change are sent.  Calls can nest.  Only
+  // the write*() calls can be used in between.  They are defined inline
+  // below so that StaticGfx<SSD1351> compiles down to the FIFO writes.
+  void startWrite(void);
+  void writePixel(int16_t x, int16_t y, uint16_t color);
+  void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void endWrite(void);
+
+  // Bitmaps stream into a single address window, clipped to the clip
+  // rectangle (Adafruit_GFX::setClipRect()), as are the write*() calls.  The
+  // raw setAddrWindow()/pushColor() and drawImage() paths aren't clipped.
+  // Those with transparent pixels take one window per run of opaque pixels
+  // in each row instead.  Grayscale pixels are expanded to RGB565.
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color, uint16_t bg);
+  void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h, uint16_t color, uint16_t bg);
+  void drawXBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+  void drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h);
+  void drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap, int16_t w, int16_t h);
+  void drawGrayscaleBitmap(int16_t x, int16_t y, const uint8_t bitmap[], const uint8_t mask[], int16_t w, int16_t h);
+  void drawGrayscaleBitmap(int16_t x, int16_t y, uint8_t *bitmap, uint8_t *mask, int16_t w, int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, int16_t w, int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, const uint16_t bitmap[], const uint8_t mask[], int16_t w, int16_t h);
+  void drawRGBBitmap(int16_t x, int16_t y, uint16_t *bitmap, uint8_t *mask, int16_t w, int16_t h);
+  // 8-bit bitmaps, such as a GFXcanvas8's buffer, with each index expanded
+  // to the RGB565 color at that index of the 256 entry palette as it is
+  // sent.  Swapping or changing the palette recolors the next draw without
+  // touching the bitmap.  A canvas is drawn unrotated, as its buffer is.
+  void drawIndexedBitmap(int16_t x, int16_t y, const uint8_t bitmap[], const uint16_t palette[], int16_t w, int16_t h);
+  void drawCanvas(int16_t x, int16_t y, const GFXcanvas8* pCanvas, const uint16_t palette[]);
+  // RGB565 pixels stored in the order they are sent, high byte first, such
+  // as the tables from assetCompiler -b or a GFXcanvas16 after byteSwap().
+  // On the little-endian LPC1768 these are byte swapped, and are copied to
+  // the SPI port straight from memory rather than split into bytes, each
+  // call as one transaction.  pushWireColors() sends them to the window from
+  // setAddrWindow(), as pushColor() would.  wireColor() converts a color to
+  // this order, for drawing into such a canvas.
+  static uint16_t wireColor(uint16_t color) { return (color << 8) | (color >> 8); }
+  void pushWireColors(const uint16_t colors[], uint32_t count);
+  void drawWireBitmap(int16_t x, int16_t y, const uint16_t bitmap[], int16_t w, int16_t h);
   void setRotation(uint8_t r);
   void mirrorDisplay(bool mirror);
   void invertDisplay(bool mode);
@@ -136,12 +213,99 @@ class SSD1351 : public Adafruit_GFX
   void writeCmd(uint8_t c);
   void writeData(uint8_t d);
   void commonInit();
+  void writeWindowCmd(uint8_t c);
+  void writeWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+  void writeColor(uint16_t color, uint32_t count);
+  void writeBytes(const uint8_t* pBytes, uint32_t count);
+  template<class Source>
+  void blit(int16_t x, int16_t y, int16_t w, int16_t h, Source& source);
+  template<class Source, class Mask>
+  void blit(int16_t x, int16_t y, int16_t w, int16_t h, Source& source, Mask& mask);
 
  private:
   FastSpiWriter*        m_pSpi;
   DigitalOut            m_dcPin;
   DigitalOut            m_rstPin;
   DigitalOut            m_csPin;
+  // Address window and pointer that the write*() calls last left the
+  // controller with, in GFX coordinates.  Not valid once anything else has
+  // sent a command.
+  uint16_t              m_windowX0, m_windowY0;
+  uint16_t              m_windowX1, m_windowY1;
+  uint16_t              m_pointerX, m_pointerY;
+  int16_t               m_lastPixelX, m_lastPixelY;
+  uint8_t               m_writeDepth;
+  bool                  m_windowValid;
 };
 
+
+// ----------------------------------------------------------
+inline void SSD1351::writeSPI(uint8_t c)
+{
+    m_pSpi->transmit(c);
+}
+
+// ----------------------------------------------------------
+inline void SSD1351::startWrite(void)
+{
+  if(m_writeDepth++ == 0) {
+    m_dcPin = 1;
+    m_csPin = 0;
+  }
+}
+
+// ----------------------------------------------------------
+inline void SSD1351::endWrite(void)
+{
+  if(m_writeDepth > 0 && --m_writeDepth == 0) {
+    m_pSpi->flush();
+    m_csPin = 1;
+  }
+}
+
+// ----------------------------------------------------------
+inline void SSD1351::writePixel(int16_t x, int16_t y, uint16_t color)
+{
+  if(!clipContains(x, y)) return;
+  if(!m_windowValid || x != m_pointerX || y != m_pointerY) {
+    // Open the window to the edge of the screen in the direction that this
+    // pixel continues from the last one, so that more pixels of the same
+    // line (or glyph column) don't need a new window.
+    if(x == m_lastPixelX && y == m_lastPixelY + 1) writeWindow(x, y, x, _height-1);
+    else                                           writeWindow(x, y, _width-1, y);
+  }
+  m_lastPixelX = x;
+  m_lastPixelY = y;
+
+  writeSPI(color >> 8); writeSPI(color);
+
+  // The controller's pointer runs along each row of the window and wraps.
+  if(++m_pointerX > m_windowX1) {
+    m_pointerX = m_windowX0;
+    if(++m_pointerY > m_windowY1) m_pointerY = m_windowY0;
+  }
+}
+
+// ----------------------------------------------------------
+inline void SSD1351::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  writeFillRect(x, y, 1, h, color);
+}
+
+// ----------------------------------------------------------
+inline void SSD1351::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  writeFillRect(x, y, w, 1, color);
+}
+
+// ----------------------------------------------------------
+inline void SSD1351::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if(!clipRect(x, y, w, h)) return;
+
+  // Filling the whole window leaves the pointer back at its start.
+  writeWindow(x, y, x+w-1, y+h-1);
+  writeColor(color, (uint32_t)w * h);
+}
+
 #endif
@@ -0,0 +1,433 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Adafruit_GFX drawing API bound at compile time to one concrete display
+// class.  Adafruit_GFX makes a virtual call for every pixel or span that its
+// lines, circles, triangles and text draw, which the compiler can't inline.
+// StaticGfx<Device> has the same primitives but makes qualified calls to
+// Device's startWrite(), writePixel(), writeFastHLine(), writeFastVLine(),
+// writeFillRect() and endWrite(), so where Device defines those inline (as
+// SSD1351 does) the pixel loops compile down to the SPI FIFO writes.
+//
+// Device must be the most derived class of the display since the qualified
+// calls skip any overrides below it.  Everything else, such as the bitmaps
+// which already cost one call per bitmap, is still called on the device.
+// Text drawn through the front end has its own cursor, colours, size and
+// font, separate from those of the device.
+#ifndef _STATIC_GFX_H_
+#define _STATIC_GFX_H_
+
+#include <Adafruit_GFX.h>
+#include <GfxRaster.h>
+
+
+template<class Device>
+class StaticGfx
+{
+  public:
+    StaticGfx(Device* pDevice);
+
+    Device* device() const { return m_pDevice; }
+    int16_t width() const { return m_pDevice->width(); }
+    int16_t height() const { return m_pDevice->height(); }
+
+    void    drawPixel(int16_t x, int16_t y, uint16_t color);
+    void    drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void    drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void    fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void    fillScreen(uint16_t color);
+    void    drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    void    drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void    drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void    drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color);
+    void    fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+    void    fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta, uint16_t color);
+    void    drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void    fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+    void    drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+    void    fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color);
+    void    drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size);
+    void    drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                     uint8_t sizeX, uint8_t sizeY);
+
+    void    setCursor(int16_t x, int16_t y) { m_cursorX = x; m_cursorY = y; }
+    int16_t getCursorX() const { return m_cursorX; }
+    int16_t getCursorY() const { return m_cursorY; }
+    void    setTextColor(uint16_t c) { m_textColor = m_textBgColor = c; }
+    void    setTextColor(uint16_t c, uint16_t bg) { m_textColor = c; m_textBgColor = bg; }
+    void    setTextSize(uint8_t s) { setTextSize(s, s); }
+    void    setTextSize(uint8_t sizeX, uint8_t sizeY)
+    {
+      m_textSizeX = sizeX ? sizeX : 1;
+      m_textSizeY = sizeY ? sizeY : 1;
+    }
+    void    setTextWrap(bool wrap) { m_wrap = wrap; }
+    void    cp437(bool x = true) { m_cp437 = x; }
+    void    setFont(const GFXfont* pFont = NULL);
+    size_t  write(uint8_t c);
+    void    print(const char* pText);
+
+    // The spans which the GfxRaster.h rasterizers send back.
+    void    writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+    {
+      m_pDevice->Device::writeFastVLine(x, y, h, color);
+    }
+    void    writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+    {
+      m_pDevice->Device::writeFastHLine(x, y, w, color);
+    }
+    void    writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+    {
+      m_pDevice->Device::writeFillRect(x, y, w, h, color);
+    }
+
+  protected:
+    void    writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    static void swap(int16_t& a, int16_t& b) { int16_t t = a; a = b; b = t; }
+
+    Device*        m_pDevice;
+    const GFXfont* m_pFont;
+    int16_t        m_cursorX;
+    int16_t        m_cursorY;
+    uint16_t       m_textColor;
+    uint16_t       m_textBgColor;
+    uint8_t        m_textSizeX;
+    uint8_t        m_textSizeY;
+    bool           m_wrap;
+    bool           m_cp437;
+};
+
+
+// The primitives below follow those in Adafruit_GFX.cpp call for call, and
+// share its GfxRaster.h rasterizers, so that they draw exactly the same pixels
+// in the same order.
+template<class Device>
+StaticGfx<Device>::StaticGfx(Device* pDevice)
+{
+  m_pDevice = pDevice;
+  m_pFont = NULL;
+  m_cursorX = 0;
+  m_cursorY = 0;
+  m_textColor = 0xFFFF;
+  m_textBgColor = 0xFFFF;
+  m_textSizeX = 1;
+  m_textSizeY = 1;
+  m_wrap = true;
+  m_cp437 = false;
+}
+
+template<class Device>
+void StaticGfx<Device>::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writePixel(x, y, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFastVLine(x, y, h, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFastHLine(x, y, w, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFillRect(x, y, w, h, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::fillScreen(uint16_t color)
+{
+  fillRect(0, 0, width(), height(), color);
+}
+
+template<class Device>
+void StaticGfx<Device>::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  gfxWriteLine(this, x0, y0, x1, y1, color);
+}
+
+template<class Device>
+void StaticGfx<Device>::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  if (x0 == x1) {
+    if (y0 > y1) {
+      swap(y0, y1);
+    }
+    drawFastVLine(x0, y0, y1 - y0 + 1, color);
+  } else if (y0 == y1) {
+    if (x0 > x1) {
+      swap(x0, x1);
+    }
+    drawFastHLine(x0, y0, x1 - x0 + 1, color);
+  } else {
+    m_pDevice->Device::startWrite();
+    writeLine(x0, y0, x1, y1, color);
+    m_pDevice->Device::endWrite();
+  }
+}
+
+template<class Device>
+void StaticGfx<Device>::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFastHLine(x, y, w, color);
+  m_pDevice->Device::writeFastHLine(x, y + h - 1, w, color);
+  m_pDevice->Device::writeFastVLine(x, y, h, color);
+  m_pDevice->Device::writeFastVLine(x + w - 1, y, h, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  gfxWriteCircle(this, x0, y0, r, 0xF, true, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::drawCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t cornername, uint16_t color)
+{
+  gfxWriteCircle(this, x0, y0, r, cornername, false, color);
+}
+
+template<class Device>
+void StaticGfx<Device>::fillCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFastVLine(x0, y0 - r, 2 * r + 1, color);
+  fillCircleHelper(x0, y0, r, 3, 0, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::fillCircleHelper(int16_t x0, int16_t y0, int16_t r, uint8_t corners, int16_t delta,
+                                         uint16_t color)
+{
+  gfxFillCircle(this, x0, y0, r, corners, delta, color);
+}
+
+template<class Device>
+void StaticGfx<Device>::drawTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+                                     uint16_t color)
+{
+  drawLine(x0, y0, x1, y1, color);
+  drawLine(x1, y1, x2, y2, color);
+  drawLine(x2, y2, x0, y0, color);
+}
+
+template<class Device>
+void StaticGfx<Device>::fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2,
+                                     uint16_t color)
+{
+  m_pDevice->Device::startWrite();
+  gfxFillTriangle(this, x0, y0, x1, y1, x2, y2, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::drawRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+  int16_t maxRadius = ((w < h) ? w : h) / 2;
+  if (r > maxRadius) {
+    r = maxRadius;
+  }
+
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFastHLine(x + r, y, w - 2 * r, color);
+  m_pDevice->Device::writeFastHLine(x + r, y + h - 1, w - 2 * r, color);
+  m_pDevice->Device::writeFastVLine(x, y + r, h - 2 * r, color);
+  m_pDevice->Device::writeFastVLine(x + w - 1, y + r, h - 2 * r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::fillRoundRect(int16_t x, int16_t y, int16_t w, int16_t h, int16_t r, uint16_t color)
+{
+  int16_t maxRadius = ((w < h) ? w : h) / 2;
+  if (r > maxRadius) {
+    r = maxRadius;
+  }
+
+  m_pDevice->Device::startWrite();
+  m_pDevice->Device::writeFillRect(x + r, y, w - 2 * r, h, color);
+  fillCircleHelper(x + w - r - 1, y + r, r, 1, h - 2 * r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, h - 2 * r - 1, color);
+  m_pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size)
+{
+  drawChar(x, y, c, color, bg, size, size);
+}
+
+template<class Device>
+void StaticGfx<Device>::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg,
+                                 uint8_t sizeX, uint8_t sizeY)
+{
+  Device* pDevice = m_pDevice;
+
+  if (!m_pFont) {
+    // Classic 5x7 font, with an optional background.
+    if (x >= width() || y >= height() || x + 6 * sizeX - 1 < 0 || y + 8 * sizeY - 1 < 0) {
+      return;
+    }
+    if (!m_cp437 && c >= 176) {
+      c++;
+    }
+
+    const uint8_t* pColumns = &Adafruit_GFX::classicFont()[c * 5];
+    pDevice->Device::startWrite();
+    for (int8_t i = 0 ; i < 5 ; i++) {
+      uint8_t line = pColumns[i];
+      for (int8_t j = 0 ; j < 8 ; j++, line >>= 1) {
+        if (line & 1) {
+          if (sizeX == 1 && sizeY == 1) {
+            pDevice->Device::writePixel(x + i, y + j, color);
+          } else {
+            pDevice->Device::writeFillRect(x + i * sizeX, y + j * sizeY, sizeX, sizeY, color);
+          }
+        } else if (bg != color) {
+          if (sizeX == 1 && sizeY == 1) {
+            pDevice->Device::writePixel(x + i, y + j, bg);
+          } else {
+            pDevice->Device::writeFillRect(x + i * sizeX, y + j * sizeY, sizeX, sizeY, bg);
+          }
+        }
+      }
+    }
+    if (bg != color) {
+      if (sizeX == 1 && sizeY == 1) {
+        pDevice->Device::writeFastVLine(x + 5, y, 8, bg);
+      } else {
+        pDevice->Device::writeFillRect(x + 5 * sizeX, y, sizeX, 8 * sizeY, bg);
+      }
+    }
+    pDevice->Device::endWrite();
+    return;
+  }
+
+  // Custom font, always transparent.  write() has already skipped characters
+  // which aren't in the font.
+  const GFXglyph* pGlyph = &m_pFont->glyph[c - m_pFont->first];
+  const uint8_t*  pBitmap = m_pFont->bitmap;
+  uint16_t        offset = pGlyph->bitmapOffset;
+  uint8_t         w = pGlyph->width;
+  uint8_t         h = pGlyph->height;
+  int8_t          xo = pGlyph->xOffset;
+  int8_t          yo = pGlyph->yOffset;
+  int16_t         xo16 = 0;
+  int16_t         yo16 = 0;
+  uint8_t         bits = 0;
+  uint8_t         bit = 0;
+
+  if (sizeX > 1 || sizeY > 1) {
+    xo16 = xo;
+    yo16 = yo;
+  }
+  pDevice->Device::startWrite();
+  for (uint8_t yy = 0 ; yy < h ; yy++) {
+    for (uint8_t xx = 0 ; xx < w ; xx++) {
+      if (!(bit++ & 7)) {
+        bits = pBitmap[offset++];
+      }
+      if (bits & 0x80) {
+        if (sizeX == 1 && sizeY == 1) {
+          pDevice->Device::writePixel(x + xo + xx, y + yo + yy, color);
+        } else {
+          pDevice->Device::writeFillRect(x + (xo16 + xx) * sizeX, y + (yo16 + yy) * sizeY, sizeX, sizeY, color);
+        }
+      }
+      bits <<= 1;
+    }
+  }
+  pDevice->Device::endWrite();
+}
+
+template<class Device>
+void StaticGfx<Device>::setFont(const GFXfont* pFont)
+{
+  // Custom fonts are drawn from the baseline and the classic one from the
+  // top left corner.
+  if (pFont && !m_pFont) {
+    m_cursorY += 6;
+  } else if (!pFont && m_pFont) {
+    m_cursorY -= 6;
+  }
+  m_pFont = pFont;
+}
+
+template<class Device>
+size_t StaticGfx<Device>::write(uint8_t c)
+{
+  if (!m_pFont) {
+    if (c == '\n') {
+      m_cursorX = 0;
+      m_cursorY += m_textSizeY * 8;
+    } else if (c != '\r') {
+      if (m_wrap && m_cursorX + m_textSizeX * 6 > width()) {
+        m_cursorX = 0;
+        m_cursorY += m_textSizeY * 8;
+      }
+      drawChar(m_cursorX, m_cursorY, c, m_textColor, m_textBgColor, m_textSizeX, m_textSizeY);
+      m_cursorX += m_textSizeX * 6;
+    }
+    return 1;
+  }
+
+  if (c == '\n') {
+    m_cursorX = 0;
+    m_cursorY += (int16_t)m_textSizeY * m_pFont->yAdvance;
+  } else if (c != '\r' && c >= m_pFont->first && c <= m_pFont->last) {
+    const GFXglyph* pGlyph = &m_pFont->glyph[c - m_pFont->first];
+    if (pGlyph->width > 0 && pGlyph->height > 0) {
+      if (m_wrap && m_cursorX + m_textSizeX * (pGlyph->xOffset + pGlyph->width) > width()) {
+        m_cursorX = 0;
+        m_cursorY += (int16_t)m_textSizeY * m_pFont->yAdvance;
+      }
+      drawChar(m_cursorX, m_cursorY, c, m_textColor, m_textBgColor, m_textSizeX, m_textSizeY);
+    }
+    m_cursorX += pGlyph->xAdvance * (int16_t)m_textSizeX;
+  }
+  return 1;
+}
+
+template<class Device>
+void StaticGfx<Device>::print(const char* pText)
+{
+  while (*pText) {
+    write(*pText++);
+  }
+}
+
+#endif // _STATIC_GFX_H_
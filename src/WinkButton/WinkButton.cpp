@@ -0,0 +1,35 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "WinkButton.h"
+
+
+WinkButton::WinkButton(PinName pin, Timer* pTimer, uint32_t debounceTime) :
+  m_input(pin),
+  m_debouncer(debounceTime)
+{
+  m_pTimer = pTimer;
+  m_input.mode(PullUp);
+  m_input.fall(this, &WinkButton::pressed);
+  m_input.rise(this, &WinkButton::released);
+}
+
+void WinkButton::pressed()
+{
+  m_debouncer.edge(m_pTimer->read_us(), true);
+}
+
+void WinkButton::released()
+{
+  m_debouncer.edge(m_pTimer->read_us(), false);
+}
@@ -0,0 +1,42 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Interrupt driven wink button.  The button should connect the pin to ground
+// when pressed; the internal pull-up is enabled.
+#ifndef _WINK_BUTTON_H_
+#define _WINK_BUTTON_H_
+
+#include <mbed.h>
+#include "WinkRequest.h"
+
+
+class WinkButton
+{
+  public:
+    // pTimer timestamps each press, debounceTime is in microseconds.
+    WinkButton(PinName pin, Timer* pTimer, uint32_t debounceTime);
+
+    bool pending() const { return m_debouncer.pending(); }
+    bool fetch(uint32_t* pPressTime) { return m_debouncer.fetch(pPressTime); }
+
+  protected:
+    void pressed();
+    void released();
+
+    InterruptIn   m_input;
+    WinkDebouncer m_debouncer;
+    Timer*        m_pTimer;
+};
+
+#endif // _WINK_BUTTON_H_
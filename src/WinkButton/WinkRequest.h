@@ -0,0 +1,122 @@
+// Copyright 2020 Adam Green (https://github.com/adamgreen/)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Wink request handling which doesn't depend on mbed so that it can also be
+// exercised by host tools with a simulated GPIO:
+//   WinkDebouncer turns the raw button edges seen by an interrupt handler into
+//   blink requests.
+//   EyeScheduler picks which eye frame() renders next.
+#ifndef _WINK_REQUEST_H_
+#define _WINK_REQUEST_H_
+
+#include <stdint.h>
+
+
+// The first press edge after the button has been quiet for debounceTime is
+// accepted immediately, so debouncing adds no latency.  Every edge (press or
+// release) restarts the quiet period, so contact bounce after a press or
+// release can't produce another request.
+class WinkDebouncer
+{
+  public:
+    WinkDebouncer(uint32_t debounceTime)
+    {
+      m_debounceTime = debounceTime;
+      m_lastEdgeTime = 0;
+      m_pressTime = 0;
+      m_pressCount = 0;
+      m_fetchCount = 0;
+      m_quiet = true;
+    }
+
+    // Called from the interrupt handler on each edge.  'now' is in micros.
+    void edge(uint32_t now, bool pressed)
+    {
+      bool bounce = !m_quiet && (now - m_lastEdgeTime) < m_debounceTime;
+
+      m_lastEdgeTime = now;
+      m_quiet = false;
+      if (bounce || !pressed) {
+        return;
+      }
+      m_pressTime = now;
+      // Publish the press time before the count which signals the request.
+      __sync_synchronize();
+      m_pressCount = m_pressCount + 1;
+    }
+
+    // Called from frame().  Only the most recent of several unfetched presses
+    // is reported.
+    bool pending() const
+    {
+      return m_pressCount != m_fetchCount;
+    }
+
+    bool fetch(uint32_t* pPressTime)
+    {
+      uint32_t pressCount = m_pressCount;
+      if (pressCount == m_fetchCount) {
+        return false;
+      }
+      __sync_synchronize();
+      *pPressTime = m_pressTime;
+      m_fetchCount = pressCount;
+      return true;
+    }
+
+  protected:
+    uint32_t          m_debounceTime;
+    uint32_t          m_lastEdgeTime;
+    volatile uint32_t m_pressTime;
+    volatile uint32_t m_pressCount;
+    uint32_t          m_fetchCount;
+    bool              m_quiet;
+};
+
+
+// Eyes are normally rendered round-robin, one per frame.  An eye with a
+// pending wink request is served first instead so that its blink starts on
+// the very next frame.  If several eyes have requests pending they are served
+// in round-robin order.
+class EyeScheduler
+{
+  public:
+    EyeScheduler(uint8_t eyeCount)
+    {
+      m_eyeCount = eyeCount;
+      m_current = 0;
+    }
+
+    // pendingMask has bit N set if eye N has a wink pending.
+    uint8_t next(uint32_t pendingMask)
+    {
+      for (uint8_t i = 1 ; pendingMask && i <= m_eyeCount ; i++) {
+        uint8_t e = (m_current + i) % m_eyeCount;
+        if (pendingMask & (1 << e)) {
+          m_current = e;
+          return m_current;
+        }
+      }
+      if (++m_current >= m_eyeCount) {
+        m_current = 0;
+      }
+      return m_current;
+    }
+
+  protected:
+    uint8_t m_eyeCount;
+    uint8_t m_current;
+};
+
+#endif // _WINK_REQUEST_H_
@@ -23,6 +23,25 @@
 //#include "graphics/naugaEye.h"      // Nauga googly eye (DISABLE TRACKING)
 //#include "graphics/doeEye.h"        // Cartoon deer eye (DISABLE TRACKING)
 
+// Or, instead of one of the #includes above, enable this line to link in a
+// binary eye packed by the host eyePack tool (see EyeBlob/eyeBlobTables.h).
+// This keeps the HUGE tables out of the compile at the cost of a few cycles
+// per pixel to look up the table dimensions at runtime:
+//#define EYE_BLOB_FILE "graphics/dragonEye.eyb"
+#ifdef EYE_BLOB_FILE
+  #include "EyeBlob/eyeBlobTables.h"
+#endif
+
+// Optional: enable this line to time the render and animation paths (dump
+// the zones with 'p' on the control port).  The Makefile picks this line up
+// and defines PROFILE for every module, not just this one:
+//#define PROFILE
+
+// Optional: enable this line to run the Adafruit_GFX primitive benchmark on
+// the first display at startup (SPI byte counts also need PROFILE enabled
+// above):
+//#define GFX_BENCHMARK
+
 // Optional: enable this line for startup logo (screen test/orient):
 #include "graphics/logo.h"        // Otherwise your choice, if it fits
 
@@ -47,16 +66,17 @@
 // This table contains ONE LINE PER EYE.  The table MUST be present with
 // this name and contain ONE OR MORE lines.  Each line contains THREE items:
 // a pin number for the corresponding TFT/OLED display's SELECT line, a pin
-// pin number for that eye's "wink" button (or -1 if not used), and a screen
+// pin number for that eye's "wink" button (or NC if not used), and a screen
 // rotation value (0-3) for that eye.
 typedef struct {
   PinName select;       // pin numbers for each eye's screen select line
+  PinName wink;         // and wink button (or NC if not used)
   uint8_t rotation;     // also display rotation.
 } eyeInfo_t;
 
 eyeInfo_t eyeInfo[] = {
-  {  OLED_LEFT_CS_PIN, 0  }, // LEFT EYE display-select and no rotation
-  {  OLED_RIGHT_CS_PIN, 0 }, // RIGHT EYE display-select and no rotation
+  {  OLED_LEFT_CS_PIN,  NC, 0 }, // LEFT EYE display-select, no wink button and no rotation
+  {  OLED_RIGHT_CS_PIN, NC, 0 }, // RIGHT EYE display-select, no wink button and no rotation
 };
 
 // INPUT SETTINGS (for controlling eye motion) -----------------------------
@@ -67,6 +87,20 @@ eyeInfo_t eyeInfo[] = {
 
 #define TRACKING            // If defined, eyelid tracks pupil
 #define AUTOBLINK           // If defined, eyes also blink autonomously
+#define PREDICT_SCANOUT     // If defined, animate for predicted display time
+
+// Wink buttons (see eyeInfo[] above) connect their pin to ground when pressed.
+// The first edge of a press is acted upon in its interrupt handler, edges
+// within WINK_DEBOUNCE_TIME of the previous one are treated as contact bounce.
+// The next frame rendered is for the winking eye, whatever eye was due, and
+// its lid starts closing in that frame.  Worst case latency from press to the
+// last pixel of that first closing frame is therefore 2 frame times (the
+// press lands just after a frame was started and has to wait for it to
+// finish) and best case is 1 frame time.  Each other eye whose wink was
+// pending at the same time and got served first adds another frame time.
+// The 'l' console command reports this as the per-eye latency and
+// host/tools/winkLatency checks the bound with simulated bouncy buttons.
+#define WINK_DEBOUNCE_TIME  20000 // micros
 #ifdef UNDONE
   #define LIGHT_PIN      A1 // Hallowing light sensor pin
   #define LIGHT_CURVE  0.33 // Light sensor adjustment curve
@@ -75,6 +109,45 @@ eyeInfo_t eyeInfo[] = {
   #define IRIS_SMOOTH       // If enabled, filter input from LIGHT_PIN
 #endif // UNDONE
 
+// REPRODUCIBLE ANIMATION SETTINGS -----------------------------------------
+
+// Seed for the random numbers behind eye motion, blinks and the autonomous
+// iris.  0 seeds from ANALOG_PIN at startup so that every run differs.  Set
+// it to anything else to animate the same way every run.
+#define RANDOM_SEED       0
+
+// TRACE_RECORD writes the inputs to drawEye() for the first TRACE_FRAMES
+// frames to TRACE_FILE.  TRACE_REPLAY instead renders the frames in TRACE_FILE
+// over and over, as fast as possible and without any animation, printing the
+// time taken by each pass.  Comparing builds with the same trace renders
+// exactly the same frames.  See EyeTrace/EyeTrace.h for the file format.
+//#define TRACE_RECORD
+//#define TRACE_REPLAY
+#define TRACE_FILE        "/local/eyes.trc" // mbed's USB drive
+#define TRACE_FRAMES      3000
+
+// MOVIE_FILE plays a movie made from a trace by the host movieEncode tool over
+// and over instead of animating the eyes.  Each frame is shown at the time it
+// was recorded, by sending only the pixels which changed since that display's
+// previous frame, so nothing is rendered at all.  MOVIE_FLASH links the movie
+// into flash instead, which only fits short ones.  See EyeMovie/EyeMovie.h for
+// the file format.
+//#define MOVIE_FILE        "/local/eyes.eym" // mbed's USB drive
+//#define MOVIE_FLASH       "graphics/eyes.eym"
+
+// EXTERNAL CONTROL SETTINGS -----------------------------------------------
+
+// Gaze, blinks and iris size can be controlled externally (by a puppeteer,
+// tracker, etc) by sending commands over this UART using the framed
+// protocol described in EyeControl/ControlProtocol.h.  Single key console
+// commands ('l', 'p' and 'r') are also accepted on this port.
+// NOTE: printf() output shares USBTX/USBRX so it will also use this baud rate.
+#define CONTROL_TX_PIN    USBTX
+#define CONTROL_RX_PIN    USBRX
+#define CONTROL_BAUD_RATE 115200
+#define CONTROL_TIMEOUT   3000000 // Autonomous behavior resumes after this
+                                  // many microseconds without a command
+
 #if !defined(IRIS_MIN)      // Each eye might have its own MIN/MAX
   #define IRIS_MIN      120 // Iris size (0-1023) in brightest light
 #endif
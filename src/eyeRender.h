@@ -0,0 +1,95 @@
+//--------------------------------------------------------------------------
+// Eye rendering kernel shared by main.cpp and the host drawEye benchmark.
+//
+// This must be included after one of the graphics/*Eye.h tables (normally
+// via config.h) since it renders from whichever sclera, iris, polar, upper
+// and lower tables are in scope.  The host benchmark includes it once per
+// eye so that every eye can be rendered from a single executable.
+//--------------------------------------------------------------------------
+#ifndef _EYE_RENDER_H_
+#define _EYE_RENDER_H_
+
+// Define screen limits.
+#define SCREEN_X_START 0
+#define SCREEN_X_END   SCREEN_WIDTH
+#define SCREEN_Y_START 0
+#define SCREEN_Y_END   SCREEN_HEIGHT
+
+// Headers from the host assetCompiler -p hold the sclera and/or iris as 8-bit
+// indices into a palette of RGB565 colours when they have few enough colours.
+#ifdef SCLERA_PALETTE_SIZE
+#define SCLERA_PIXEL(Y, X) scleraPalette[sclera[Y][X]]
+#else
+#define SCLERA_PIXEL(Y, X) sclera[Y][X]
+#endif
+#ifdef IRIS_PALETTE_SIZE
+#define IRIS_PIXEL(Y, X)   irisPalette[iris[Y][X]]
+#else
+#define IRIS_PIXEL(Y, X)   iris[Y][X]
+#endif
+
+// Calls pSink->pushColor() with every pixel of the frame, row by row.  Tables
+// from assetCompiler -b hold the pixels in the order they are sent rather
+// than native order, so each row of those is collected and handed to
+// pSink->pushWireColors() instead.  The caller sets up the address window.
+// Inputs must be pre-clipped & valid.
+template<class PixelSink>
+static inline void renderEye(
+  PixelSink* pSink,   // -> display (or anything with pushColor(uint16_t))
+  uint16_t   iScale,  // Scale factor for iris (0-1023)
+  uint8_t    scleraX, // First pixel X offset into sclera image
+  uint8_t    scleraY, // First pixel Y offset into sclera image
+  uint8_t    uT,      // Upper eyelid threshold value
+  uint8_t    lT)      // Lower eyelid threshold value
+{
+  uint8_t  screenX, screenY, scleraXsave;
+  int16_t  irisX, irisY;
+  uint16_t p, a;
+  uint32_t d;
+#ifdef RGB565_BYTE_SWAPPED
+  uint16_t row[SCREEN_X_END - SCREEN_X_START]; // Wire order pixels of the line
+#endif
+
+  uint8_t  irisThreshold = (128 * (1023 - iScale) + 512) / 1024;
+  // irisThreshold is 0 at an iScale of 1023 (naugaEye's IRIS_MAX), in which
+  // case no pixel is in the iris.  UDIV returns 0 for that on the LPC1768 but
+  // it traps on the host.
+  uint32_t irisScale     = irisThreshold ? IRIS_MAP_HEIGHT * 65536 / irisThreshold : 0;
+
+  // Now just issue raw 16-bit values for every pixel...
+  scleraXsave = scleraX + SCREEN_X_START; // Save initial X value to reset on each line
+  irisY       = scleraY - (SCLERA_HEIGHT - IRIS_HEIGHT) / 2;
+  for(screenY=SCREEN_Y_START; screenY<SCREEN_Y_END; screenY++, scleraY++, irisY++) {
+    scleraX = scleraXsave;
+    irisX   = scleraXsave - (SCLERA_WIDTH - IRIS_WIDTH) / 2;
+    for(screenX=SCREEN_X_START; screenX<SCREEN_X_END; screenX++, scleraX++, irisX++) {
+      if((lower[screenY][screenX] <= lT) ||
+         (upper[screenY][screenX] <= uT)) {             // Covered by eyelid
+        p = 0;
+      } else if((irisY < 0) || (irisY >= IRIS_HEIGHT) ||
+                (irisX < 0) || (irisX >= IRIS_WIDTH)) { // In sclera
+        p = SCLERA_PIXEL(scleraY, scleraX);
+      } else {                                          // Maybe iris...
+        p = polar[irisY][irisX];                        // Polar angle/dist
+        d = p & 0x7F;                                   // Distance from edge (0-127)
+        if(d < irisThreshold) {                         // Within scaled iris area
+          d = d * irisScale / 65536;                    // d scaled to iris image height
+          a = (IRIS_MAP_WIDTH * (p >> 7)) / 512;        // Angle (X)
+          p = IRIS_PIXEL(d, a);                         // Pixel = iris
+        } else {                                        // Not in iris
+          p = SCLERA_PIXEL(scleraY, scleraX);           // Pixel = sclera
+        }
+      }
+#ifdef RGB565_BYTE_SWAPPED
+      row[screenX - SCREEN_X_START] = p;
+#else
+      pSink->pushColor(p);
+#endif
+    } // end column
+#ifdef RGB565_BYTE_SWAPPED
+    pSink->pushWireColors(row, SCREEN_X_END - SCREEN_X_START);
+#endif
+  } // end scanline
+}
+
+#endif // _EYE_RENDER_H_
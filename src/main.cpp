@@ -18,19 +18,23 @@
 //--------------------------------------------------------------------------
 #include <mbed.h>
 #include <SSD1351.h>
+#include <Profiler.h>
+#include <FrameStats.h>
+#include <ControlPort.h>
+#include <WinkButton.h>
+#include <GfxBenchmark.h>
+#include <StaticGfx.h>
+#include <EyeRandom.h>
+#include <EyeTrace.h>
+#include <EyeMovie.h>
 // Configuraion is done in the following header.
 #include "config.h"
+#include "eyeRender.h"
 
 
 // Number of eyes is based on eyeInfo array size in config.h
 #define NUM_EYES (sizeof eyeInfo / sizeof eyeInfo[0]) // config.h pin list
 
-// Define screen limits.
-#define SCREEN_X_START 0
-#define SCREEN_X_END   SCREEN_WIDTH
-#define SCREEN_Y_START 0
-#define SCREEN_Y_END   SCREEN_HEIGHT
-
 // A simple state machine is used to control eye blinks/winks:
 #define NOBLINK 0       // Not currently engaged in a blink
 #define ENBLINK 1       // Eyelid is currently closing
@@ -41,24 +45,79 @@ typedef struct {
   uint32_t startTime;   // Time (micros) of last state change
 } eyeBlink;
 
-struct {            // One-per-eye structure
-  SSD1351* display; // -> OLED/TFT object
-  eyeBlink blink;   // Current blink/wink state
+struct {              // One-per-eye structure
+  SSD1351* display;   // -> OLED/TFT object
+  eyeBlink blink;     // Current blink/wink state
+  uint32_t scanoutLead; // Filtered micros from frame start to mid-scanout
+  WinkButton* wink;   // -> wink button object (NULL if none)
 } g_eye[NUM_EYES];
 
 static uint32_t       g_startTime;  // For FPS indicator
 static FastSpiWriter  g_spi(OLED_MOSI_PIN, NC, OLED_SCK_PIN, NC);
 static Timer          g_timer;
 static AnalogIn       g_analog(ANALOG_PIN);
+static FrameStats     g_frameStats(NUM_EYES);
+static ControlPort    g_controlPort(CONTROL_TX_PIN, CONTROL_RX_PIN, CONTROL_BAUD_RATE, &g_timer);
+static EyeScheduler   g_scheduler(NUM_EYES);
+static EyeRandom      g_gazeRandom;   // Autonomous eye motion
+static EyeRandom      g_blinkRandom;  // Blink and wink durations
+static EyeRandom      g_irisRandom;   // Autonomous iris scaling
+#if defined(TRACE_RECORD) || defined(TRACE_REPLAY) || defined(MOVIE_FILE)
+static LocalFileSystem g_local("local");
+#endif
+#ifdef TRACE_RECORD
+static EyeTraceWriter g_traceWriter;
+#endif
+#ifdef TRACE_REPLAY
+static EyeTraceReader g_traceReader;
+#endif
+#if defined(MOVIE_FILE) || defined(MOVIE_FLASH)
+static EyeMovieReader g_movieReader;
+#endif
+#ifdef MOVIE_FLASH
+__asm__(".section .rodata.eyeMovie, \"a\"\n"
+        ".global g_movieData\n"
+        "g_movieData:\n"
+        ".incbin \"" MOVIE_FLASH "\"\n"
+        ".global g_movieDataEnd\n"
+        "g_movieDataEnd:\n"
+        ".previous\n");
+extern "C" const uint8_t g_movieData[];
+extern "C" const uint8_t g_movieDataEnd[];
+#endif
+
+// State of external control, updated from commands received on g_controlPort.
+static struct {
+  bool     active;          // Autonomous motion/blinks paused while set
+  uint32_t lastCommandTime; // Time of last command, for CONTROL_TIMEOUT
+  bool     newGaze;         // Gaze command not yet acted upon by frame()
+  int16_t  gazeX, gazeY;    // Commanded eye position (0-1023)
+  int32_t  gazeMoveTime;    // Time (micros) to take moving to gazeX/Y
+  uint32_t gazeTimestamp;   // Time (micros) that gaze command was received
+  bool     irisValid;       // Iris scale overridden while set
+  uint16_t iris;            // Commanded iris scale (0-1023)
+} g_control;
 
 
 // INITIALIZATION -- runs once at startup ----------------------------------
+#if defined(GFX_BENCHMARK) && defined(PROFILE)
+static uint32_t spiBytes(void) // SPI byte counter for GfxBenchmark
+{
+  return g_spi.transmitCount();
+}
+#endif
+
 static void setup(void)
 {
   uint8_t e; // Eye index, 0 to NUM_EYES-1
 
   printf("Init\n");
-  srand(g_analog.read());
+  PROFILE_INIT();
+  uint32_t seed = RANDOM_SEED ? RANDOM_SEED : g_analog.read_u16();
+  g_gazeRandom.seed(seed, 0);
+  g_blinkRandom.seed(seed, 1);
+  g_irisRandom.seed(seed, 2);
+  printf("Seed %lu\n", seed);
 
   // Initialize eye objects based on eyeInfo list in config.h:
   for(e=0; e<NUM_EYES; e++) {
@@ -66,6 +125,11 @@ static void setup(void)
     // Only setup the first display to perform the reset for both.
     g_eye[e].display     = new SSD1351(OLED_WIDTH, OLED_HEIGHT, &g_spi, OLED_DC_PIN, e==0 ? OLED_RST_PIN : NC, eyeInfo[e].select);
     g_eye[e].blink.state = NOBLINK;
+    g_eye[e].scanoutLead = 0;
+    g_eye[e].wink        = NULL;
+    if(eyeInfo[e].wink != NC) {
+      g_eye[e].wink = new WinkButton(eyeInfo[e].wink, &g_timer, WINK_DEBOUNCE_TIME);
+    }
   }
 
   printf("Rotate\n");
@@ -75,6 +139,39 @@ static void setup(void)
   }
   printf("done\n");
 
+#ifdef GFX_BENCHMARK
+  #ifdef PROFILE
+    GfxBenchmark benchmark(g_eye[0].display, &g_timer, spiBytes, Profiler::now);
+  #else
+    GfxBenchmark benchmark(g_eye[0].display, &g_timer); // No SPI byte or cycle counts
+  #endif
+  // Virtual calls through Adafruit_GFX, then StaticGfx's inlined ones.
+  StaticGfx<SSD1351> staticGfx(g_eye[0].display);
+  benchmark.run();
+  printf("StaticGfx:\n");
+  benchmark.run(&staticGfx);
+#endif
+
+#ifdef TRACE_RECORD
+  if(!g_traceWriter.open(TRACE_FILE, seed)) printf("Failed to create %s\n", TRACE_FILE);
+#endif
+#ifdef TRACE_REPLAY
+  if(!g_traceReader.open(TRACE_FILE)) printf("Failed to open %s\n", TRACE_FILE);
+  else printf("Replaying %s (seed %lu)\n", TRACE_FILE, g_traceReader.seed());
+#endif
+#if defined(MOVIE_FILE) || defined(MOVIE_FLASH)
+  #ifdef MOVIE_FILE
+    if(!g_movieReader.open(MOVIE_FILE)) printf("Failed to open %s\n", MOVIE_FILE);
+  #else
+    if(!g_movieReader.open(g_movieData, g_movieDataEnd - g_movieData)) printf("Failed to open %s\n", MOVIE_FLASH);
+  #endif
+  else if(g_movieReader.width() != SCREEN_WIDTH || g_movieReader.height() != SCREEN_HEIGHT) {
+    printf("Movie is %ux%u, not %ux%u\n", g_movieReader.width(), g_movieReader.height(), SCREEN_WIDTH, SCREEN_HEIGHT);
+    g_movieReader.close();
+  }
+  else printf("Playing %lu frames\n", g_movieReader.packetCount());
+#endif
+
 #if defined(LOGO_TOP_WIDTH) || defined(COLOR_LOGO_WIDTH)
   // I noticed lots of folks getting right/left eyes flipped, or
   // installing upside-down, etc.  Logo split across screens may help:
@@ -83,12 +180,13 @@ static void setup(void)
   for(e=0; e<NUM_EYES; e++) { // Another pass, after all screen inits
     g_eye[e].display->fillScreen(0);
     #ifdef LOGO_TOP_WIDTH
-      // Monochrome Adafruit logo is 2 mono bitmaps:
+      // Monochrome Adafruit logo is 2 mono bitmaps (drawn with a black
+      // background so that each streams into a single window):
       g_eye[e].display->drawBitmap(x - LOGO_TOP_WIDTH / 2 - 20,
-        y, logo_top, LOGO_TOP_WIDTH, LOGO_TOP_HEIGHT, 0xFFFF);
+        y, logo_top, LOGO_TOP_WIDTH, LOGO_TOP_HEIGHT, 0xFFFF, 0);
       g_eye[e].display->drawBitmap(x - LOGO_BOTTOM_WIDTH/2,
         y + LOGO_TOP_HEIGHT, logo_bottom, LOGO_BOTTOM_WIDTH, LOGO_BOTTOM_HEIGHT,
-        0xFFFF);
+        0xFFFF, 0);
     #else
       // Color sponsor logo is one RGB bitmap:
       g_eye[e].display->fillScreen(color_logo[0]);
@@ -111,12 +209,20 @@ static void setup(void)
     g_eye[e].display->mirrorDisplay(e != 0);
   }
 
+  // Don't charge the SPI stalls of the logo and benchmark to the first frame.
+  PROFILE_RESET();
   g_timer.start();
   g_startTime = g_timer.read_ms(); // For frame-rate calculation
 }
 
 
 // EYE-RENDERING FUNCTION --------------------------------------------------
+#ifdef DRAW_EYE_HOOK
+// Host tools which run the firmware define DRAW_EYE_HOOK and this function to
+// see the inputs of every frame.
+void drawEyeHook(uint8_t e, uint16_t iScale, uint8_t scleraX, uint8_t scleraY, uint8_t uT, uint8_t lT);
+#endif
+
 static void drawEye( // Renders one eye.  Inputs must be pre-clipped & valid.
   uint8_t  e,       // Eye array index; 0 or 1 for left/right
   uint16_t iScale,  // Scale factor for iris (0-1023)
@@ -125,47 +231,97 @@ static void drawEye( // Renders one eye.  Inputs must be pre-clipped & valid.
   uint8_t  uT,      // Upper eyelid threshold value
   uint8_t  lT)      // Lower eyelid threshold value
 {
-  uint8_t  screenX, screenY, scleraXsave;
-  int16_t  irisX, irisY;
-  uint16_t p, a;
-  uint32_t d;
-
-  uint8_t  irisThreshold = (128 * (1023 - iScale) + 512) / 1024;
-  uint32_t irisScale     = IRIS_MAP_HEIGHT * 65536 / irisThreshold;
-
   // Set up raw pixel dump to entire screen.  Although such writes can wrap
   // around automatically from end of rect back to beginning, the region is
   // reset on each frame here in case of an SPI glitch.
   g_eye[e].display->setAddrWindow(0, 0, SCREEN_WIDTH-1, SCREEN_HEIGHT-1);
+  PROFILE_SCOPE(PROFILE_DRAW_EYE);
 
-  // Now just issue raw 16-bit values for every pixel...
-  scleraXsave = scleraX + SCREEN_X_START; // Save initial X value to reset on each line
-  irisY       = scleraY - (SCLERA_HEIGHT - IRIS_HEIGHT) / 2;
-  for(screenY=SCREEN_Y_START; screenY<SCREEN_Y_END; screenY++, scleraY++, irisY++) {
-    scleraX = scleraXsave;
-    irisX   = scleraXsave - (SCLERA_WIDTH - IRIS_WIDTH) / 2;
-    for(screenX=SCREEN_X_START; screenX<SCREEN_X_END; screenX++, scleraX++, irisX++) {
-      if((lower[screenY][screenX] <= lT) ||
-         (upper[screenY][screenX] <= uT)) {             // Covered by eyelid
-        p = 0;
-      } else if((irisY < 0) || (irisY >= IRIS_HEIGHT) ||
-                (irisX < 0) || (irisX >= IRIS_WIDTH)) { // In sclera
-        p = sclera[scleraY][scleraX];
-      } else {                                          // Maybe iris...
-        p = polar[irisY][irisX];                        // Polar angle/dist
-        d = p & 0x7F;                                   // Distance from edge (0-127)
-        if(d < irisThreshold) {                         // Within scaled iris area
-          d = d * irisScale / 65536;                    // d scaled to iris image height
-          a = (IRIS_MAP_WIDTH * (p >> 7)) / 512;        // Angle (X)
-          p = iris[d][a];                               // Pixel = iris
-        } else {                                        // Not in iris
-          p = sclera[scleraY][scleraX];                 // Pixel = sclera
-        }
-      }
-      g_eye[e].display->pushColor(p);
-    } // end column
-  } // end scanline
+#ifdef DRAW_EYE_HOOK
+  drawEyeHook(e, iScale, scleraX, scleraY, uT, lT);
+#endif
+  renderEye(g_eye[e].display, iScale, scleraX, scleraY, uT, lT);
+}
+
+// TRACE RECORD/REPLAY -----------------------------------------------------
+#ifdef TRACE_RECORD
+static void recordFrame( // Appends one frame's drawEye() inputs to the trace
+  uint8_t  e,       // Eye array index
+  uint32_t t,       // Time (micros) animation was evaluated at
+  uint16_t iScale,  // drawEye() parameters...
+  uint8_t  scleraX,
+  uint8_t  scleraY,
+  uint8_t  uT,
+  uint8_t  lT)
+{
+  if(!g_traceWriter.isOpen()) return;
+
+  EyeTraceRecord record = { t, iScale, e, scleraX, scleraY, uT, lT };
+  g_traceWriter.write(record);
+  if(g_traceWriter.count() >= TRACE_FRAMES) {
+    g_traceWriter.close(); // Closing is what makes it visible on /local
+    printf("Recorded %u frames to %s\n", TRACE_FRAMES, TRACE_FILE);
+  }
+}
+#endif // TRACE_RECORD
+
+#ifdef TRACE_REPLAY
+static void replayTrace(void) // Renders every frame in the trace once
+{
+  EyeTraceRecord record;
+  uint32_t       frames  = 0;
+  uint32_t       elapsed = 0; // Time spent in drawEye(), not reading the file
+
+  g_traceReader.rewind();
+  while(g_traceReader.read(&record)) {
+    if(record.eye >= NUM_EYES ||                 // Recorded with another config?
+       record.scleraX > SCLERA_WIDTH  - 128 ||
+       record.scleraY > SCLERA_HEIGHT - 128) continue;
+    uint32_t drawStart = g_timer.read_us();
+    drawEye(record.eye, record.iScale, record.scleraX, record.scleraY, record.uT, record.lT);
+    elapsed += g_timer.read_us() - drawStart;
+    frames++;
+  }
+  if(!frames) {
+    wait_ms(1000); // Nothing to replay
+    return;
+  }
+  if(!elapsed) elapsed = 1; // Faster than the timer can resolve
+  printf("Replayed %lu frames in %lu us (%lu.%02lu frames/s)\n", frames, elapsed,
+         (uint32_t)(frames * 1000000ULL / elapsed), (uint32_t)(frames * 100000000ULL / elapsed % 100));
+}
+#endif // TRACE_REPLAY
+
+// MOVIE PLAYBACK ----------------------------------------------------------
+#if defined(MOVIE_FILE) || defined(MOVIE_FLASH)
+static void playMovie(void) // Shows every frame in the movie once, on time
+{
+  EyeMoviePacket packet;
+  uint32_t       frames = 0;
+  uint32_t       start  = g_timer.read_us();
+
+  g_movieReader.rewind();
+  while(g_movieReader.readPacket(&packet)) {
+    if(packet.eye >= NUM_EYES) continue;     // Made for more displays?
+    int32_t early = (int32_t)(packet.t - (g_timer.read_us() - start));
+    if(early > 0) wait_us(early);           // Otherwise it is behind
+    if(!g_movieReader.drawPacket(g_eye[packet.eye].display)) {
+      printf("Movie is corrupt after %lu frames\n", frames);
+      g_movieReader.close();
+      break;
+    }
+    frames++;
+  }
+  if(!frames) {
+    wait_ms(1000); // Nothing to play
+    return;
+  }
+  uint32_t elapsed = g_timer.read_us() - start;
+  if(!elapsed) elapsed = 1; // Faster than the timer can resolve
+  printf("Played %lu frames in %lu us (%lu.%02lu frames/s)\n", frames, elapsed,
+         (uint32_t)(frames * 1000000ULL / elapsed), (uint32_t)(frames * 100000000ULL / elapsed % 100));
 }
+#endif // MOVIE_FILE || MOVIE_FLASH
 
 // EYE ANIMATION -----------------------------------------------------------
 const uint8_t ease[] = { // Ease in/out curve for eye movements 3*t^2-2*t^3
@@ -195,20 +351,176 @@ static int map(int val, int fromLow, int fromHigh, int toLow, int toHigh)
   return (val - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
 }
 
+// SCANOUT PREDICTION ------------------------------------------------------
+
+// The pixels for a frame are streamed to the display over the course of the
+// whole frame so animation state sampled at the start of frame() is already
+// stale by the time it is seen.  Instead the animation is evaluated for the
+// time at which this eye's scanout is expected to be half way done, based on
+// a running average of how long previous frames for this eye have taken.
+static uint32_t predictScanoutTime(uint8_t e, uint32_t frameStart)
+{
+#ifdef PREDICT_SCANOUT
+  static uint32_t lastTime = 0;
+  uint32_t        t = frameStart + g_eye[e].scanoutLead;
+
+  // The motion and blink state machines are shared by all eyes and expect
+  // time to never go backwards, even if the eyes' predictions differ a bit.
+  if((int32_t)(t - lastTime) < 0) t = lastTime;
+  lastTime = t;
+  return t;
+#else
+  return frameStart;
+#endif // PREDICT_SCANOUT
+}
+
+static void updateScanoutLead( // Filter in timing of a completed frame
+  uint8_t  e,          // Eye which was just rendered
+  uint32_t frameStart, // micros() at start of frame()
+  uint32_t drawStart,  // micros() when drawEye() started sending pixels
+  uint32_t drawEnd)    // micros() when the last pixel was sent
+{
+  uint32_t lead = (drawStart - frameStart) + (drawEnd - drawStart) / 2;
+
+  if(g_eye[e].scanoutLead == 0) {
+    g_eye[e].scanoutLead = lead;  // First frame, no history to filter with
+  } else {
+    g_eye[e].scanoutLead += ((int32_t)(lead - g_eye[e].scanoutLead)) / 8;
+  }
+}
+
+// Console commands for querying runtime statistics:
+//  'l' dumps the frame time and latency histograms.
+//  'p' dumps the profiling zones (if PROFILE is enabled in config.h).
+//  'r' clears all statistics.
+// These are received on the control port, outside of any command frames.
+static void checkConsole(void)
+{
+  switch(g_controlPort.fetchKey()) {
+    case 'l': g_frameStats.dump();  break;
+    case 'p': PROFILE_DUMP();       break;
+    case 'r': g_frameStats.reset();
+              PROFILE_RESET();      break;
+  }
+}
+
+// EXTERNAL CONTROL --------------------------------------------------------
+
+static bool startBlink( // Returns false if eye was already blinking
+  uint8_t  e,          // Eye array index
+  uint32_t t,          // Time (micros) at which blink starts
+  uint32_t duration)   // Duration of ENBLINK state (micros)
+{
+  if(g_eye[e].blink.state != NOBLINK) return false;
+  g_eye[e].blink.state     = ENBLINK;
+  g_eye[e].blink.startTime = t;
+  g_eye[e].blink.duration  = duration;
+  return true;
+}
+
+// Fetches a 0-1023 value (gaze position, iris scale) from a command.
+static uint16_t controlValue(const ControlCommand* pCommand, uint8_t offset)
+{
+  uint16_t v = controlPayloadU16(pCommand, offset);
+  return (v > 1023) ? 1023 : v;
+}
+
+// Applies the commands received since the last frame.  Gaze commands are
+// left for the motion code in frame() to pick up.
+static void processControl(uint32_t t) // Time (micros) of this frame
+{
+  ControlCommand command;
+
+  while(g_controlPort.fetch(&command)) {
+    switch(command.id) {
+      case CONTROL_CMD_GAZE: {
+        uint16_t moveTime = controlPayloadU16(&command, 4);
+        if(moveTime > 5000) moveTime = 5000; // Keep ease[] index in range
+        g_control.newGaze       = true;
+        g_control.gazeX         = controlValue(&command, 0);
+        g_control.gazeY         = controlValue(&command, 2);
+        g_control.gazeMoveTime  = moveTime * 1000;
+        g_control.gazeTimestamp = command.timestamp;
+        break;
+      }
+      case CONTROL_CMD_BLINK: {
+        uint8_t  eyeMask  = controlPayloadU8(&command, 0);
+        uint32_t duration = controlPayloadU16(&command, 1) * 1000;
+        if(!eyeMask)  eyeMask  = 0xFF;
+        if(!duration) duration = 50000; // ~1/20 sec
+        for(uint8_t e=0; e<NUM_EYES; e++) {
+          if((eyeMask & (1 << e)) && startBlink(e, t, duration)) {
+            g_frameStats.postEvent(e, command.timestamp);
+          }
+        }
+        break;
+      }
+      case CONTROL_CMD_IRIS:
+        g_control.irisValid = true;
+        g_control.iris      = controlValue(&command, 0);
+        g_frameStats.postEventAllEyes(command.timestamp);
+        break;
+      case CONTROL_CMD_RELEASE:
+        g_control.active    = false;
+        g_control.irisValid = false;
+        continue;
+      case CONTROL_CMD_STATS:
+        g_frameStats.dump();
+        PROFILE_DUMP();
+        continue;
+      case CONTROL_CMD_RESET:
+        g_frameStats.reset();
+        PROFILE_RESET();
+        continue;
+      default:
+        continue; // Ignore unknown commands
+    }
+    g_control.active          = true;
+    g_control.lastCommandTime = t;
+  }
+
+  // Resume autonomous behavior once commands stop arriving.
+  if(g_control.active && (t - g_control.lastCommandTime) >= CONTROL_TIMEOUT) {
+    g_control.active    = false;
+    g_control.irisValid = false;
+  }
+}
+
+// WINK BUTTONS ------------------------------------------------------------
+
+static uint32_t pendingWinks(void) // Bit N set if eye N has a wink pending
+{
+  uint32_t mask = 0;
+
+  for(uint8_t e=0; e<NUM_EYES; e++) {
+    if(g_eye[e].wink && g_eye[e].wink->pending()) mask |= 1 << e;
+  }
+  return mask;
+}
+
 static void frame( // Process motion for a single frame of left or right eye
   uint16_t        iScale)     // Iris scale (0-1023) passed in
 {
   static uint32_t frames   = 0; // Used in frame rate calculation
-  static uint8_t  eyeIndex = 0; // g_eye[] array counter
   int16_t         eyeX, eyeY;
-  uint32_t        t = g_timer.read_us(); // Time at start of function
+  uint32_t        frameStart = g_timer.read_us(); // Time at start of function
 
   if(!(++frames & 255)) { // Every 256 frames...
     uint32_t elapsed = g_timer.read_ms() - g_startTime;
     if(elapsed) printf("%lu\n", frames * 1000 / elapsed); // Print FPS
   }
+  checkConsole();
+
+  // Cycle through eyes, 1 per call, but serve an eye with a wink pending first
+  uint8_t         eyeIndex = g_scheduler.next(pendingWinks());
 
-  if(++eyeIndex >= NUM_EYES) eyeIndex = 0; // Cycle through eyes, 1 per call
+  // Time at which animation is evaluated for this eye's frame
+  uint32_t        t = predictScanoutTime(eyeIndex, frameStart);
+
+  PROFILE_BEGIN(PROFILE_ANIMATION);
+
+  processControl(t);
+  if(g_control.irisValid) iScale = g_control.iris;
 
   // Autonomous X/Y eye motion
   // Periodically initiates motion to a new random point, random speed,
@@ -217,12 +529,14 @@ static void frame( // Process motion for a single frame of left or right eye
   static int16_t  eyeOldX=512, eyeOldY=512, eyeNewX=512, eyeNewY=512;
   static uint32_t eyeMoveStartTime = 0L;
   static int32_t  eyeMoveDuration  = 0L;
+  bool            newGazeTarget    = false;
+  uint32_t        gazeEventTime    = frameStart;
 
   int32_t dt = t - eyeMoveStartTime;      // uS elapsed since last eye event
   if(eyeInMotion) {                       // Currently moving?
     if(dt >= eyeMoveDuration) {           // Time up?  Destination reached.
       eyeInMotion      = false;           // Stop moving
-      eyeMoveDuration  = rand()%3000000;  // 0-3 sec stop
+      eyeMoveDuration  = g_gazeRandom.below(3000000);  // 0-3 sec stop
       eyeMoveStartTime = t;               // Save initial time of stop
       eyeX = eyeOldX = eyeNewX;           // Save position
       eyeY = eyeOldY = eyeNewY;
@@ -234,37 +548,67 @@ static void frame( // Process motion for a single frame of left or right eye
   } else {                                // Eye stopped
     eyeX = eyeOldX;
     eyeY = eyeOldY;
-    if(dt > eyeMoveDuration) {            // Time up?  Begin new move.
+    if(dt > eyeMoveDuration && !g_control.active) { // Time up?  Begin new move.
       int16_t  dx, dy;
       uint32_t d;
       do {                                // Pick new dest in circle
-        eyeNewX = rand() % 1024;
-        eyeNewY = rand() % 1024;
+        eyeNewX = g_gazeRandom.below(1024);
+        eyeNewY = g_gazeRandom.below(1024);
         dx      = (eyeNewX * 2) - 1023;
         dy      = (eyeNewY * 2) - 1023;
       } while((d = (dx * dx + dy * dy)) > (1023 * 1023)); // Keep trying
-      eyeMoveDuration  = rand()%(144000-72000)+72000; // ~1/14 - ~1/7 sec
+      eyeMoveDuration  = g_gazeRandom.below(144000-72000)+72000; // ~1/14 - ~1/7 sec
       eyeMoveStartTime = t;               // Save initial time of move
       eyeInMotion      = true;            // Start move on next frame
+      newGazeTarget    = true;
+    }
+  }
+
+  if(g_control.newGaze) {                 // Externally commanded move?
+    g_control.newGaze = false;
+    eyeOldX          = eyeX;              // Start from current position
+    eyeOldY          = eyeY;
+    eyeNewX          = g_control.gazeX;
+    eyeNewY          = g_control.gazeY;
+    eyeMoveStartTime = t;
+    if(g_control.gazeMoveTime > 0) {      // Ease into new position
+      eyeMoveDuration  = g_control.gazeMoveTime;
+      eyeInMotion      = true;            // Start move on next frame
+      newGazeTarget    = true;
+      gazeEventTime    = g_control.gazeTimestamp;
+    } else {                              // Jump straight there
+      eyeMoveDuration  = 0;
+      eyeInMotion      = false;
+      eyeX = eyeOldX = eyeNewX;
+      eyeY = eyeOldY = eyeNewY;
+      g_frameStats.postEventAllEyes(g_control.gazeTimestamp);
     }
   }
 
   // Blinking
+  // A wink starts at frameStart rather than t so that the lid has already
+  // started closing by the time this frame is scanned out.
+  uint32_t pressTime;
+  if(g_eye[eyeIndex].wink && g_eye[eyeIndex].wink->fetch(&pressTime)) {
+    if(startBlink(eyeIndex, frameStart, g_blinkRandom.below(72000-36000)+36000)) {
+      g_frameStats.postEvent(eyeIndex, pressTime);
+    }
+  }
+
 #ifdef AUTOBLINK
   // Similar to the autonomous eye movement above -- blink start times
   // and durations are random (within ranges).
-  if((t - timeOfLastBlink) >= timeToNextBlink) { // Start new blink?
+  if(!g_control.active &&
+     (t - timeOfLastBlink) >= timeToNextBlink) { // Start new blink?
     timeOfLastBlink = t;
-    uint32_t blinkDuration = rand()%(72000-36000)+36000; // ~1/28 - ~1/14 sec
+    uint32_t blinkDuration = g_blinkRandom.below(72000-36000)+36000; // ~1/28 - ~1/14 sec
     // Set up durations for both eyes (if not already winking)
     for(uint8_t e=0; e<NUM_EYES; e++) {
-      if(g_eye[e].blink.state == NOBLINK) {
-        g_eye[e].blink.state     = ENBLINK;
-        g_eye[e].blink.startTime = t;
-        g_eye[e].blink.duration  = blinkDuration;
+      if(startBlink(e, t, blinkDuration)) {
+        g_frameStats.postEvent(e, frameStart);
       }
     }
-    timeToNextBlink = blinkDuration * 3 + rand()%4000000;
+    timeToNextBlink = blinkDuration * 3 + g_blinkRandom.below(4000000);
   }
 #endif
 
@@ -305,12 +649,14 @@ static void frame( // Process motion for a single frame of left or right eye
   // I suppose one could get all clever with a range sensor, but for now...
   // UNDONE: if(NUM_EYES > 1) eyeX += 4;
   if(eyeX > (SCLERA_WIDTH - 128)) eyeX = (SCLERA_WIDTH - 128);
+  PROFILE_END(PROFILE_ANIMATION);
 
   // Eyelids are rendered using a brightness threshold image.  This same
   // map can be used to simplify another problem: making the upper eyelid
   // track the pupil (eyes tend to open only as much as needed -- e.g. look
   // down and the upper eyelid drops).  Just sample a point in the upper
   // lid map slightly above the pupil to determine the rendering threshold.
+  PROFILE_BEGIN(PROFILE_EYELID);
   static uint8_t uThreshold = 128;
   uint8_t        lThreshold, n;
 #ifdef TRACKING
@@ -340,9 +686,23 @@ static void frame( // Process motion for a single frame of left or right eye
   } else {
     n          = uThreshold;
   }
+  PROFILE_END(PROFILE_EYELID);
 
   // Pass all the derived values to the eye-rendering function:
+#ifdef TRACE_RECORD
+  recordFrame(eyeIndex, t, iScale, eyeX, eyeY, n, lThreshold);
+#endif
+  uint32_t drawStart = g_timer.read_us();
   drawEye(eyeIndex, iScale, eyeX, eyeY, n, lThreshold);
+  PROFILE_COMMIT(PROFILE_SPI_STALL);
+
+  // drawEye() waits for the last pixel to leave the SPI port so the frame
+  // is now complete.  A new gaze target only starts moving the eyes on the
+  // next frame so it is posted after this frame has been accounted for.
+  uint32_t drawEnd = g_timer.read_us();
+  updateScanoutLead(eyeIndex, frameStart, drawStart, drawEnd);
+  g_frameStats.frameDone(eyeIndex, frameStart, drawEnd);
+  if(newGazeTarget) g_frameStats.postEventAllEyes(gazeEventTime);
 }
 
 // AUTONOMOUS IRIS SCALING (if no photocell or dial) -----------------------
@@ -364,7 +724,7 @@ void split( // Subdivides motion path into two sub-paths w/randimization
   if(range >= 8) {     // Limit subdvision count, because recursion
     range    /= 2;     // Split range & time in half for subdivision,
     duration /= 2;     // then pick random center point within range:
-    int16_t  midValue = (startValue + endValue - range) / 2 + rand() % range;
+    int16_t  midValue = (startValue + endValue - range) / 2 + g_irisRandom.below(range);
     uint32_t midTime  = startTime + duration;
     split(startValue, midValue, startTime, duration, range); // First half
     split(midValue  , endValue, midTime  , duration, range); // Second half
@@ -384,7 +744,15 @@ void split( // Subdivides motion path into two sub-paths w/randimization
 
 void loop() {
 
-#if defined(LIGHT_PIN) && (LIGHT_PIN >= 0) // Interactive iris
+#if defined(TRACE_REPLAY) // Frames come from the trace, no animation
+
+  replayTrace();
+
+#elif defined(MOVIE_FILE) || defined(MOVIE_FLASH) // Frames come from the movie
+
+  playMovie();
+
+#elif defined(LIGHT_PIN) && (LIGHT_PIN >= 0) // Interactive iris
 
   int16_t v = analogRead(LIGHT_PIN);       // Raw dial/photocell reading
 #ifdef LIGHT_PIN_FLIP
@@ -399,6 +767,11 @@ void loop() {
 #endif
   // And scale to iris range (IRIS_MAX is size at LIGHT_MIN)
   v = map(v, 0, (LIGHT_MAX - LIGHT_MIN), IRIS_MAX, IRIS_MIN);
+  static int16_t lastLightValue = -1;
+  if(v != lastLightValue) {                // Light level changed?
+    g_frameStats.postEventAllEyes(g_timer.read_us());
+    lastLightValue = v;
+  }
 #ifdef IRIS_SMOOTH // Filter input (gradual motion)
   static int16_t irisValue = (IRIS_MIN + IRIS_MAX) / 2;
   irisValue = ((irisValue * 15) + v) / 16;
@@ -409,7 +782,7 @@ void loop() {
 
 #else  // Autonomous iris scaling -- invoke recursive function
 
-  newIris = rand()%(IRIS_MAX-IRIS_MIN)+IRIS_MIN;
+  newIris = g_irisRandom.below(IRIS_MAX-IRIS_MIN)+IRIS_MIN;
   split(oldIris, newIris, g_timer.read_us(), 10000000L, IRIS_MAX - IRIS_MIN);
   oldIris = newIris;
 
@@ -419,6 +792,12 @@ void loop() {
 
 int main()
 {
+#ifdef EYE_BLOB_FILE
+  if(!g_eyeBlob.isValid()) {
+    printf("%s isn't a version %d eye blob\n", EYE_BLOB_FILE, EYE_BLOB_VERSION);
+    return 1;
+  }
+#endif
   setup();
   while(true) {
     loop();